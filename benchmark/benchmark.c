@@ -0,0 +1,758 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <seagrass.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+static uint64_t now(void) {
+    struct timespec ts;
+    seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &ts));
+    return (uint64_t) ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+static uint64_t random_next(uint64_t *const state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static struct sea_turtle_string *strings_of(const size_t count,
+                                            const size_t offset) {
+    struct sea_turtle_string *const strings = calloc(count, sizeof(*strings));
+    seagrass_required(strings);
+    char chars[64];
+    size_t out;
+    for (size_t i = 0; i < count; i++) {
+        const int size = snprintf(chars, sizeof(chars), "identifier.%zu",
+                                  (offset + i) * 2654435761u);
+        seagrass_required_true(sea_turtle_string_init(&strings[i], chars,
+                                                      size, &out));
+    }
+    return strings;
+}
+
+static void strings_destroy(struct sea_turtle_string *const strings,
+                            const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        seagrass_required_true(sea_turtle_string_invalidate(&strings[i]));
+    }
+    free(strings);
+}
+
+/**
+ * @brief Compare the miss (insert) and hit cost of a string pool backend.
+ * @param [in] name of backend.
+ * @param [in] flags to initialize string pool with.
+ * @param [in] strings to be pooled.
+ * @param [in] count number of strings.
+ */
+static void benchmark_backend(const char *const name,
+                              const uintmax_t flags,
+                              const struct sea_turtle_string *const strings,
+                              const size_t count) {
+    struct pufferfish_string_pool pool;
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(&pool,
+                                                                  flags));
+    struct triggerfish_strong **const refs = malloc(count * sizeof(*refs));
+    size_t *const order = malloc(count * sizeof(*order));
+    seagrass_required(refs);
+    seagrass_required(order);
+    uint64_t state = UINT64_C(0x9e3779b97f4a7c15);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    for (size_t i = count - 1; i > 0; i--) {
+        const size_t j = random_next(&state) % (i + 1);
+        const size_t k = order[i];
+        order[i] = order[j];
+        order[j] = k;
+    }
+    uint64_t start = now();
+    for (size_t i = 0; i < count; i++) {
+        seagrass_required_true(pufferfish_string_pool_get(
+                &pool, &strings[i], &refs[i]));
+    }
+    const double miss = (double) (now() - start) / (double) count;
+    start = now();
+    for (size_t i = 0; i < count; i++) {
+        struct triggerfish_strong *out;
+        seagrass_required_true(pufferfish_string_pool_get(
+                &pool, &strings[order[i]], &out));
+        seagrass_required_true(triggerfish_strong_release(out));
+    }
+    const double hit = (double) (now() - start) / (double) count;
+    printf("%-16s %10zu %12.1f %12.1f\n", name, count, miss, hit);
+    for (size_t i = 0; i < count; i++) {
+        seagrass_required_true(triggerfish_strong_release(refs[i]));
+    }
+    seagrass_required_true(pufferfish_string_pool_invalidate(&pool));
+    free(order);
+    free(refs);
+}
+
+static void benchmark_backends(const size_t limit) {
+    const size_t counts[] = {10000, 1000000, 10000000};
+    printf("%-16s %10s %12s %12s\n",
+           "backend", "count", "miss ns/op", "hit ns/op");
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        if (counts[i] > limit) {
+            break;
+        }
+        struct sea_turtle_string *const strings = strings_of(counts[i], 0);
+        benchmark_backend("red-black-tree",
+                          PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE,
+                          strings, counts[i]);
+        benchmark_backend("hash-table",
+                          PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE,
+                          strings, counts[i]);
+        strings_destroy(strings, counts[i]);
+    }
+}
+
+#define BENCHMARK_SCALING_KEYS                                      100000
+#define BENCHMARK_SCALING_OPERATIONS                                1000000
+/* one in this many operations interns a string not yet in the pool */
+#define BENCHMARK_SCALING_MISS_RATIO                                16
+
+struct scaling_target {
+    const char *name;
+    void *pool;
+    bool (*get)(void *, const struct sea_turtle_string *,
+                struct triggerfish_strong **);
+    bool (*shrink)(void *);
+    bool (*stats)(void *, struct pufferfish_string_pool_stats *);
+};
+
+struct scaling_worker {
+    pthread_t thread;
+    const struct scaling_target *target;
+    const struct sea_turtle_string *keys;
+    struct sea_turtle_string *misses;
+    size_t count;
+    size_t miss_ratio;
+    uint64_t seed;
+};
+
+static bool scaling_get_pool(void *pool,
+                             const struct sea_turtle_string *string,
+                             struct triggerfish_strong **out) {
+    return pufferfish_string_pool_get(pool, string, out);
+}
+
+static bool scaling_get_sharded_pool(void *pool,
+                                     const struct sea_turtle_string *string,
+                                     struct triggerfish_strong **out) {
+    return pufferfish_sharded_string_pool_get(pool, string, out);
+}
+
+static bool scaling_shrink_pool(void *pool) {
+    return pufferfish_string_pool_shrink(pool);
+}
+
+static bool scaling_shrink_sharded_pool(void *pool) {
+    return pufferfish_sharded_string_pool_shrink(pool);
+}
+
+static bool scaling_stats_pool(void *pool,
+                               struct pufferfish_string_pool_stats *out) {
+    return pufferfish_string_pool_stats(pool, out);
+}
+
+static bool scaling_stats_sharded_pool(
+        void *pool, struct pufferfish_string_pool_stats *out) {
+    return pufferfish_sharded_string_pool_stats(pool, out);
+}
+
+static void *scaling_work(void *a) {
+    struct scaling_worker *const worker = a;
+    uint64_t state = worker->seed;
+    size_t misses = 0;
+    for (size_t i = 0; i < BENCHMARK_SCALING_OPERATIONS; i++) {
+        const uint64_t r = random_next(&state);
+        const struct sea_turtle_string *const string
+                = !worker->miss_ratio || r % worker->miss_ratio
+                  ? &worker->keys[(r >> 8) % BENCHMARK_SCALING_KEYS]
+                  : &worker->misses[misses++ % worker->count];
+        struct triggerfish_strong *out;
+        seagrass_required_true(worker->target->get(worker->target->pool,
+                                                   string, &out));
+        seagrass_required_true(triggerfish_strong_release(out));
+    }
+    return NULL;
+}
+
+/**
+ * @brief Measure interning throughput as the number of threads grows.
+ * @param [in] target string pool to intern into.
+ * @param [in] keys already interned strings.
+ * @param [in] max_threads largest number of threads to measure.
+ * @param [in] miss_ratio one in this many operations is a miss or zero for
+ * only hits.
+ */
+static void benchmark_scaling_target(const struct scaling_target *const target,
+                                     const struct sea_turtle_string *const keys,
+                                     const size_t max_threads,
+                                     const size_t miss_ratio) {
+    const size_t count = BENCHMARK_SCALING_OPERATIONS
+                         / BENCHMARK_SCALING_MISS_RATIO;
+    struct scaling_worker *const workers = calloc(max_threads,
+                                                  sizeof(*workers));
+    seagrass_required(workers);
+    for (size_t i = 0; i < max_threads; i++) {
+        workers[i] = (struct scaling_worker) {
+                .target = target,
+                .keys = keys,
+                .misses = strings_of(count, BENCHMARK_SCALING_KEYS
+                                            + (i + 1) * count),
+                .count = count,
+                .miss_ratio = miss_ratio,
+                .seed = UINT64_C(0x9e3779b97f4a7c15) * (i + 1)
+        };
+    }
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        const uint64_t start = now();
+        for (size_t i = 0; i < threads; i++) {
+            seagrass_required_true(!pthread_create(
+                    &workers[i].thread, NULL, scaling_work, &workers[i]));
+        }
+        for (size_t i = 0; i < threads; i++) {
+            seagrass_required_true(!pthread_join(workers[i].thread, NULL));
+        }
+        const double seconds = (double) (now() - start) / 1e9;
+        printf("%-16s %10zu %12.2f %12.1f\n", target->name, threads,
+               (double) (threads * BENCHMARK_SCALING_OPERATIONS)
+               / seconds / 1e6,
+               seconds * 1e9 / BENCHMARK_SCALING_OPERATIONS);
+    }
+    for (size_t i = 0; i < max_threads; i++) {
+        strings_destroy(workers[i].misses, count);
+    }
+    free(workers);
+}
+
+static void benchmark_scaling(const size_t max_threads,
+                              const size_t miss_ratio) {
+    struct sea_turtle_string *const keys
+            = strings_of(BENCHMARK_SCALING_KEYS, 0);
+    struct triggerfish_strong **const refs
+            = malloc(BENCHMARK_SCALING_KEYS * sizeof(*refs));
+    seagrass_required(refs);
+    struct pufferfish_string_pool pool;
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &pool, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct pufferfish_string_pool lock_free;
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &lock_free, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                        | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ));
+    struct pufferfish_sharded_string_pool sharded;
+    seagrass_required_true(pufferfish_sharded_string_pool_init(
+            &sharded, 64, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const struct scaling_target targets[] = {
+            {"single", &pool, scaling_get_pool,
+             scaling_shrink_pool, scaling_stats_pool},
+            {"lock-free-read", &lock_free, scaling_get_pool,
+             scaling_shrink_pool, scaling_stats_pool},
+            {"sharded-64", &sharded, scaling_get_sharded_pool,
+             scaling_shrink_sharded_pool, scaling_stats_sharded_pool}
+    };
+    printf("%-16s %10s %12s %12s\n", "pool", "threads", "Mops/s",
+           "ns/op");
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        /* keep the shared keys alive so that they are hits */
+        for (size_t k = 0; k < BENCHMARK_SCALING_KEYS; k++) {
+            seagrass_required_true(targets[i].get(targets[i].pool, &keys[k],
+                                                  &refs[k]));
+        }
+        benchmark_scaling_target(&targets[i], keys, max_threads, miss_ratio);
+        for (size_t k = 0; k < BENCHMARK_SCALING_KEYS; k++) {
+            seagrass_required_true(triggerfish_strong_release(refs[k]));
+        }
+    }
+    seagrass_required_true(pufferfish_sharded_string_pool_invalidate(
+            &sharded));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&lock_free));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&pool));
+    free(refs);
+    strings_destroy(keys, BENCHMARK_SCALING_KEYS);
+}
+
+#define BENCHMARK_SUITE_KEYS                                        100000
+#define BENCHMARK_SUITE_OPERATIONS                                  1000000
+/* strings each thread cycles through to produce misses */
+#define BENCHMARK_SUITE_MISSES                                      16384
+/* one in this many operations is timed on its own */
+#define BENCHMARK_SUITE_SAMPLE_RATIO                                64
+/* operations between shrinks in the mixed workload */
+#define BENCHMARK_SUITE_SHRINK_INTERVAL                             10000
+#define BENCHMARK_SUITE_ZIPF_EXPONENT                               1.0
+
+enum suite_workload {
+    SUITE_HIT,
+    SUITE_MISS,
+    SUITE_ZIPF,
+    SUITE_MIXED
+};
+
+static const char *const suite_workload_names[] = {
+        "hit", "miss", "zipf", "mixed"
+};
+
+struct suite_worker {
+    pthread_t thread;
+    const struct scaling_target *target;
+    enum suite_workload workload;
+    const struct sea_turtle_string *keys;
+    /* cumulative distribution of the Zipf-distributed key ranks */
+    const double *zipf;
+    struct sea_turtle_string *misses;
+    uint64_t seed;
+    uint64_t *samples;
+    size_t sampled;
+    /* the first worker also shrinks in the mixed workload */
+    bool shrinks;
+};
+
+/**
+ * @brief Length of a generated string.
+ * <p>Mostly short identifiers, some qualified names and a tail of long
+ * strings such as paths and URLs.</p>
+ * @param [in,out] state of random number generator.
+ * @return length in bytes.
+ */
+static size_t suite_length(uint64_t *const state) {
+    const uint64_t r = random_next(state);
+    switch (r % 10) {
+        default: {
+            return 4 + (r >> 8) % 13;
+        }
+        case 6:
+        case 7:
+        case 8: {
+            return 16 + (r >> 8) % 33;
+        }
+        case 9: {
+            return 48 + (r >> 8) % 153;
+        }
+    }
+}
+
+/**
+ * @brief Create strings with a realistic length distribution.
+ * <p>Strings start with their index so that they are unique across calls
+ * using disjoint index ranges.</p>
+ * @param [in] count number of strings.
+ * @param [in] offset index of first string.
+ * @return strings to be destroyed with strings_destroy().
+ */
+static struct sea_turtle_string *suite_strings_of(const size_t count,
+                                                  const size_t offset) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_./";
+    struct sea_turtle_string *const strings = calloc(count, sizeof(*strings));
+    seagrass_required(strings);
+    uint64_t state = UINT64_C(0x2545f4914f6cdd1d) ^ (offset + 1);
+    char chars[256];
+    size_t out;
+    for (size_t i = 0; i < count; i++) {
+        size_t size = 0;
+        for (size_t index = offset + i; index || !size; index /= 36) {
+            chars[size++] = alphabet[index % 36];
+        }
+        chars[size++] = '.';
+        for (const size_t length = suite_length(&state); size < length;) {
+            chars[size++] = alphabet[random_next(&state)
+                                     % (sizeof(alphabet) - 1)];
+        }
+        seagrass_required_true(sea_turtle_string_init(&strings[i], chars,
+                                                      size, &out));
+    }
+    return strings;
+}
+
+/**
+ * @brief Cumulative distribution of Zipf-distributed ranks.
+ * @param [in] count number of ranks.
+ * @return distribution to be freed.
+ */
+static double *suite_zipf_of(const size_t count) {
+    double *const cdf = malloc(count * sizeof(*cdf));
+    seagrass_required(cdf);
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += 1.0 / pow((double) (i + 1), BENCHMARK_SUITE_ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+    for (size_t i = 0; i < count; i++) {
+        cdf[i] /= sum;
+    }
+    return cdf;
+}
+
+static size_t suite_zipf_next(const double *const cdf, const size_t count,
+                              uint64_t *const state) {
+    const double u = (double) (random_next(state) >> 11) * 0x1.0p-53;
+    size_t low = 0, high = count - 1;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (cdf[middle] < u) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void *suite_work(void *a) {
+    struct suite_worker *const worker = a;
+    uint64_t state = worker->seed;
+    size_t misses = 0;
+    worker->sampled = 0;
+    for (size_t i = 0; i < BENCHMARK_SUITE_OPERATIONS; i++) {
+        const uint64_t r = random_next(&state);
+        const struct sea_turtle_string *string;
+        switch (worker->workload) {
+            case SUITE_HIT: {
+                string = &worker->keys[(r >> 8) % BENCHMARK_SUITE_KEYS];
+                break;
+            }
+            case SUITE_MISS: {
+                string = &worker->misses[misses++ % BENCHMARK_SUITE_MISSES];
+                break;
+            }
+            case SUITE_ZIPF: {
+                string = &worker->keys[suite_zipf_next(
+                        worker->zipf, BENCHMARK_SUITE_KEYS, &state)];
+                break;
+            }
+            default: {
+                string = r % BENCHMARK_SCALING_MISS_RATIO
+                         ? &worker->keys[(r >> 8) % BENCHMARK_SUITE_KEYS]
+                         : &worker->misses[misses++ % BENCHMARK_SUITE_MISSES];
+                break;
+            }
+        }
+        const bool timed = !(i % BENCHMARK_SUITE_SAMPLE_RATIO);
+        const uint64_t start = timed ? now() : 0;
+        struct triggerfish_strong *out;
+        seagrass_required_true(worker->target->get(worker->target->pool,
+                                                   string, &out));
+        seagrass_required_true(triggerfish_strong_release(out));
+        if (worker->shrinks && !((i + 1) % BENCHMARK_SUITE_SHRINK_INTERVAL)) {
+            seagrass_required_true(worker->target->shrink(
+                    worker->target->pool));
+        }
+        if (timed) {
+            worker->samples[worker->sampled++] = now() - start;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Current resident set size of the process.
+ * @return resident set size in kilobytes, 0 if it cannot be read.
+ */
+static long suite_rss_kb(void) {
+    FILE *const file = fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+    long size, resident;
+    const int read = fscanf(file, "%ld %ld", &size, &resident);
+    fclose(file);
+    return 2 == read ? resident * (sysconf(_SC_PAGESIZE) / 1024) : 0;
+}
+
+static int suite_compare(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *) a;
+    const uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Run a workload against a string pool for 1..max_threads threads.
+ * <p>Every run is reported as a line of JSON. <i>rss_before_kb</i> and
+ * <i>rss_after_kb</i> are the resident set size of the process right before
+ * and after the run, <i>max_rss_kb</i> is the peak resident set size of the
+ * whole process so far and so carries over from earlier, larger runs.</p>
+ * @param [in] target string pool to intern into.
+ * @param [in] workload to run.
+ * @param [in] keys already interned strings.
+ * @param [in] zipf cumulative distribution of key ranks.
+ * @param [in] workers one per thread with its misses.
+ * @param [in] max_threads largest number of threads to measure.
+ */
+static void benchmark_suite_workload(const struct scaling_target *const target,
+                                     const enum suite_workload workload,
+                                     const struct sea_turtle_string *const keys,
+                                     const double *const zipf,
+                                     struct suite_worker *const workers,
+                                     const size_t max_threads) {
+    const size_t samples = BENCHMARK_SUITE_OPERATIONS
+                           / BENCHMARK_SUITE_SAMPLE_RATIO + 1;
+    uint64_t *const merged = malloc(max_threads * samples * sizeof(*merged));
+    seagrass_required(merged);
+    for (size_t threads = 1; threads <= max_threads;
+         /* always finish with max_threads */
+         threads = threads < max_threads && threads * 2 > max_threads
+                   ? max_threads : threads * 2) {
+        for (size_t i = 0; i < threads; i++) {
+            workers[i].target = target;
+            workers[i].workload = workload;
+            workers[i].keys = keys;
+            workers[i].zipf = zipf;
+            workers[i].shrinks = SUITE_MIXED == workload && !i;
+        }
+        const long rss_before = suite_rss_kb();
+        const uint64_t start = now();
+        for (size_t i = 0; i < threads; i++) {
+            seagrass_required_true(!pthread_create(
+                    &workers[i].thread, NULL, suite_work, &workers[i]));
+        }
+        for (size_t i = 0; i < threads; i++) {
+            seagrass_required_true(!pthread_join(workers[i].thread, NULL));
+        }
+        const uint64_t elapsed = now() - start;
+        const long rss_after = suite_rss_kb();
+        size_t count = 0;
+        for (size_t i = 0; i < threads; i++) {
+            memcpy(&merged[count], workers[i].samples,
+                   workers[i].sampled * sizeof(*merged));
+            count += workers[i].sampled;
+        }
+        qsort(merged, count, sizeof(*merged), suite_compare);
+        struct pufferfish_string_pool_stats stats;
+        seagrass_required_true(target->stats(target->pool, &stats));
+        struct rusage usage;
+        seagrass_required_true(!getrusage(RUSAGE_SELF, &usage));
+        const uint64_t operations = threads * BENCHMARK_SUITE_OPERATIONS;
+        printf("{\"workload\":\"%s\",\"pool\":\"%s\",\"threads\":%zu,"
+               "\"operations\":%" PRIu64 ",\"ns_per_op\":%.1f,"
+               "\"mops\":%.2f,\"p50_ns\":%" PRIu64 ",\"p99_ns\":%" PRIu64
+               ",\"rss_before_kb\":%ld,\"rss_after_kb\":%ld,"
+               "\"max_rss_kb\":%ld,\"pool_bytes\":%ju,"
+               "\"pool_entries\":%ju}\n",
+               suite_workload_names[workload], target->name, threads,
+               operations,
+               (double) elapsed * threads / (double) operations,
+               (double) operations / ((double) elapsed / 1e9) / 1e6,
+               merged[count / 2], merged[count * 99 / 100],
+               rss_before, rss_after, usage.ru_maxrss, stats.bytes,
+               stats.entries);
+        fflush(stdout);
+        /* start every run from the same pooled strings */
+        seagrass_required_true(target->shrink(target->pool));
+    }
+    free(merged);
+}
+
+/**
+ * @brief Run every workload against every string pool configuration.
+ * @param [in] max_threads largest number of threads to measure.
+ */
+static void benchmark_suite(const size_t max_threads) {
+    struct sea_turtle_string *const keys
+            = suite_strings_of(BENCHMARK_SUITE_KEYS, 0);
+    double *const zipf = suite_zipf_of(BENCHMARK_SUITE_KEYS);
+    struct triggerfish_strong **const refs
+            = malloc(BENCHMARK_SUITE_KEYS * sizeof(*refs));
+    struct suite_worker *const workers = calloc(max_threads,
+                                                sizeof(*workers));
+    seagrass_required(refs);
+    seagrass_required(workers);
+    const size_t samples = BENCHMARK_SUITE_OPERATIONS
+                           / BENCHMARK_SUITE_SAMPLE_RATIO + 1;
+    for (size_t i = 0; i < max_threads; i++) {
+        workers[i] = (struct suite_worker) {
+                .misses = suite_strings_of(BENCHMARK_SUITE_MISSES,
+                                           BENCHMARK_SUITE_KEYS
+                                           + i * BENCHMARK_SUITE_MISSES),
+                .seed = UINT64_C(0x9e3779b97f4a7c15) * (i + 1),
+                .samples = malloc(samples * sizeof(uint64_t))
+        };
+        seagrass_required(workers[i].samples);
+    }
+    struct pufferfish_string_pool tree, table, lock_free, cached;
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &tree, PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &table, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &lock_free, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                        | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &cached, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                     | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE));
+    struct pufferfish_sharded_string_pool sharded;
+    seagrass_required_true(pufferfish_sharded_string_pool_init(
+            &sharded, 64, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const struct scaling_target targets[] = {
+            {"red-black-tree", &tree, scaling_get_pool,
+             scaling_shrink_pool, scaling_stats_pool},
+            {"hash-table", &table, scaling_get_pool,
+             scaling_shrink_pool, scaling_stats_pool},
+            {"lock-free-read", &lock_free, scaling_get_pool,
+             scaling_shrink_pool, scaling_stats_pool},
+            {"thread-cache", &cached, scaling_get_pool,
+             scaling_shrink_pool, scaling_stats_pool},
+            {"sharded-64", &sharded, scaling_get_sharded_pool,
+             scaling_shrink_sharded_pool, scaling_stats_sharded_pool}
+    };
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        /* keep the keys alive so that they are hits */
+        for (size_t k = 0; k < BENCHMARK_SUITE_KEYS; k++) {
+            seagrass_required_true(targets[i].get(targets[i].pool, &keys[k],
+                                                  &refs[k]));
+        }
+        for (enum suite_workload w = SUITE_HIT; w <= SUITE_MIXED; w++) {
+            benchmark_suite_workload(&targets[i], w, keys, zipf, workers,
+                                     max_threads);
+        }
+        for (size_t k = 0; k < BENCHMARK_SUITE_KEYS; k++) {
+            seagrass_required_true(triggerfish_strong_release(refs[k]));
+        }
+        seagrass_required_true(targets[i].shrink(targets[i].pool));
+    }
+    seagrass_required_true(pufferfish_sharded_string_pool_invalidate(
+            &sharded));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&cached));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&lock_free));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&table));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&tree));
+    for (size_t i = 0; i < max_threads; i++) {
+        strings_destroy(workers[i].misses, BENCHMARK_SUITE_MISSES);
+        free(workers[i].samples);
+    }
+    free(workers);
+    free(refs);
+    free(zipf);
+    strings_destroy(keys, BENCHMARK_SUITE_KEYS);
+}
+
+/* duplicates among the strings of a bulk load, one in this many */
+#define BENCHMARK_LOAD_DUPLICATE_RATIO                              4
+
+/**
+ * @brief Compare loading strings one at a time, as a batch and in bulk.
+ * @param [in] name of backend.
+ * @param [in] flags to initialize string pools with.
+ * @param [in] strings to be loaded.
+ * @param [in] count number of strings.
+ * @param [in] threads to bulk load with.
+ */
+static void benchmark_load_backend(const char *const name,
+                                   const uintmax_t flags,
+                                   const struct sea_turtle_string *const *const strings,
+                                   const size_t count,
+                                   const size_t threads) {
+    struct triggerfish_strong **const refs = malloc(count * sizeof(*refs));
+    seagrass_required(refs);
+    double elapsed[3];
+    for (size_t mode = 0; mode < 3; mode++) {
+        struct pufferfish_string_pool pool;
+        seagrass_required_true(pufferfish_string_pool_init_with_flags(
+                &pool, flags));
+        const uint64_t start = now();
+        switch (mode) {
+            case 0: {
+                for (size_t i = 0; i < count; i++) {
+                    seagrass_required_true(pufferfish_string_pool_get(
+                            &pool, strings[i], &refs[i]));
+                }
+                break;
+            }
+            case 1: {
+                seagrass_required_true(pufferfish_string_pool_get_many(
+                        &pool, strings, count, refs));
+                break;
+            }
+            default: {
+                seagrass_required_true(pufferfish_string_pool_load(
+                        &pool, strings, count, threads, refs));
+            }
+        }
+        elapsed[mode] = (double) (now() - start) / (double) count;
+        for (size_t i = 0; i < count; i++) {
+            seagrass_required_true(triggerfish_strong_release(refs[i]));
+        }
+        seagrass_required_true(pufferfish_string_pool_invalidate(&pool));
+    }
+    printf("%-16s %10zu %12.1f %12.1f %12.1f\n", name, count, elapsed[0],
+           elapsed[1], elapsed[2]);
+    free(refs);
+}
+
+static void benchmark_load(const size_t limit, const size_t threads) {
+    const size_t counts[] = {10000, 1000000, 10000000};
+    printf("%-16s %10s %12s %12s %12s\n",
+           "backend", "count", "get ns/op", "many ns/op", "load ns/op");
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        if (counts[i] > limit) {
+            break;
+        }
+        const size_t distinct = counts[i] - counts[i]
+                                            / BENCHMARK_LOAD_DUPLICATE_RATIO;
+        struct sea_turtle_string *const keys = strings_of(distinct, 0);
+        const struct sea_turtle_string **const strings = malloc(
+                counts[i] * sizeof(*strings));
+        seagrass_required(strings);
+        uint64_t state = UINT64_C(0x9e3779b97f4a7c15);
+        for (size_t j = 0; j < counts[i]; j++) {
+            strings[j] = &keys[j < distinct
+                               ? j
+                               : random_next(&state) % distinct];
+        }
+        benchmark_load_backend("red-black-tree",
+                               PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE,
+                               strings, counts[i], threads);
+        benchmark_load_backend("hash-table",
+                               PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE,
+                               strings, counts[i], threads);
+        free(strings);
+        strings_destroy(keys, distinct);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *const workload = argc > 1 ? argv[1] : "backend";
+    if (!strcmp("backend", workload)) {
+        benchmark_backends(argc > 2
+                           ? strtoull(argv[2], NULL, 10)
+                           : 10000000);
+    } else if (!strcmp("scaling", workload)) {
+        benchmark_scaling(argc > 2 ? strtoull(argv[2], NULL, 10) : 64,
+                          BENCHMARK_SCALING_MISS_RATIO);
+    } else if (!strcmp("readers", workload)) {
+        benchmark_scaling(argc > 2 ? strtoull(argv[2], NULL, 10) : 64, 0);
+    } else if (!strcmp("suite", workload)) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        benchmark_suite(argc > 2
+                        ? strtoull(argv[2], NULL, 10)
+                        : processors > 0 ? (size_t) processors : 1);
+    } else if (!strcmp("load", workload)) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        benchmark_load(argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000,
+                       argc > 3
+                       ? strtoull(argv[3], NULL, 10)
+                       : processors > 0 ? (size_t) processors : 1);
+    } else {
+        fprintf(stderr, "usage: %s [backend [max-count] | "
+                        "scaling [max-threads] | readers [max-threads] | "
+                        "suite [max-threads] | "
+                        "load [max-count [threads]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
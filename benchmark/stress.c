@@ -0,0 +1,486 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <seagrass.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+/* pinned keys stay pooled for the whole run, the others come and go */
+#define STRESS_KEYS                                                 1024
+#define STRESS_PINNED_KEYS                                          256
+/* operations between shrinks of the shrinking thread */
+#define STRESS_SHRINK_INTERVAL                                      64
+/* durations and lock waits are counted in power of two buckets of ns */
+#define STRESS_BUCKETS                                              40
+
+enum stress_operation {
+    STRESS_GET,
+    STRESS_RELEASE,
+    STRESS_SHRINK,
+    STRESS_OPERATIONS
+};
+
+static const char *const stress_operation_names[] = {
+        "get", "release", "shrink"
+};
+
+struct stress_target {
+    const char *name;
+    void *pool;
+    bool (*get)(void *, const struct sea_turtle_string *,
+                struct triggerfish_strong **);
+    bool (*shrink)(void *);
+    bool (*stats)(void *, struct pufferfish_string_pool_stats *);
+};
+
+/*
+ * While a key is held by at least one thread every retrieval of it must
+ * return the strong reference held.
+ */
+struct stress_key {
+    struct sea_turtle_string string;
+    pthread_mutex_t mutex;
+    struct triggerfish_strong *held;
+    uintmax_t holders;
+};
+
+struct stress_worker {
+    pthread_t thread;
+    const struct stress_target *target;
+    struct stress_key *keys;
+    struct triggerfish_strong **pinned;
+    size_t operations;
+    uint64_t seed;
+    /* the first worker also shrinks */
+    bool shrinks;
+    uint64_t histograms[STRESS_OPERATIONS][STRESS_BUCKETS];
+    /* lock waits of the operation, by nanoseconds it spent waiting */
+    uint64_t waits[STRESS_OPERATIONS][STRESS_BUCKETS];
+    uint64_t wait_ns[STRESS_OPERATIONS];
+    uint64_t violations;
+};
+
+/* when an operation began and the lock waits of its thread until then */
+struct stress_mark {
+    uint64_t start;
+    uintmax_t waits;
+    uintmax_t wait_ns;
+};
+
+static uint64_t now(void) {
+    struct timespec ts;
+    seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &ts));
+    return (uint64_t) ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+static uint64_t random_next(uint64_t *const state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static size_t stress_bucket(const uint64_t ns) {
+    size_t bucket = 0;
+    while (bucket < STRESS_BUCKETS - 1 && ns >> (bucket + 1)) {
+        bucket += 1;
+    }
+    return bucket;
+}
+
+static struct stress_mark stress_begin(void) {
+    struct stress_mark mark;
+    seagrass_required_true(pufferfish_string_pool_thread_lock_waits(
+            &mark.waits, &mark.wait_ns));
+    mark.start = now();
+    return mark;
+}
+
+/**
+ * @brief Record the duration and the lock waits of an operation.
+ * <p>The lock waits are those of the calling thread since the operation
+ * began, so they belong to this operation alone.</p>
+ * @param [in] worker recording the operation.
+ * @param [in] operation that was performed.
+ * @param [in] mark taken when the operation began.
+ */
+static void stress_record(struct stress_worker *const worker,
+                          const enum stress_operation operation,
+                          const struct stress_mark *const mark) {
+    const uint64_t elapsed = now() - mark->start;
+    uintmax_t waits, wait_ns;
+    seagrass_required_true(pufferfish_string_pool_thread_lock_waits(
+            &waits, &wait_ns));
+    worker->histograms[operation][stress_bucket(elapsed)] += 1;
+    if (waits != mark->waits) {
+        worker->waits[operation][stress_bucket(wait_ns - mark->wait_ns)]
+                += waits - mark->waits;
+        worker->wait_ns[operation] += wait_ns - mark->wait_ns;
+    }
+}
+
+static struct triggerfish_strong *stress_get(
+        struct stress_worker *const worker,
+        const struct sea_turtle_string *const string) {
+    const struct stress_mark mark = stress_begin();
+    struct triggerfish_strong *out;
+    seagrass_required_true(worker->target->get(worker->target->pool, string,
+                                               &out));
+    stress_record(worker, STRESS_GET, &mark);
+    const struct sea_turtle_string *instance;
+    seagrass_required_true(triggerfish_strong_instance(
+            out, (void **) &instance));
+    if (instance->size != string->size
+        || memcmp(instance->data, string->data, string->size)) {
+        worker->violations += 1;
+    }
+    return out;
+}
+
+static void stress_release(struct stress_worker *const worker,
+                           struct triggerfish_strong *const strong) {
+    const struct stress_mark mark = stress_begin();
+    seagrass_required_true(triggerfish_strong_release(strong));
+    stress_record(worker, STRESS_RELEASE, &mark);
+}
+
+static void *stress_work(void *a) {
+    struct stress_worker *const worker = a;
+    uint64_t state = worker->seed;
+    for (size_t i = 0; i < worker->operations; i++) {
+        const size_t index = (random_next(&state) >> 8) % STRESS_KEYS;
+        struct stress_key *const key = &worker->keys[index];
+        struct triggerfish_strong *const out = stress_get(worker,
+                                                          &key->string);
+        if (index < STRESS_PINNED_KEYS) {
+            if (out != worker->pinned[index]) {
+                worker->violations += 1;
+            }
+            stress_release(worker, out);
+        } else {
+            /* the strong reference is only compared once it is held */
+            seagrass_required_true(!pthread_mutex_lock(&key->mutex));
+            if (!key->holders++) {
+                key->held = out;
+            } else if (key->held != out) {
+                worker->violations += 1;
+            }
+            seagrass_required_true(!pthread_mutex_unlock(&key->mutex));
+            struct triggerfish_strong *const again = stress_get(
+                    worker, &key->string);
+            if (again != out) {
+                worker->violations += 1;
+            }
+            stress_release(worker, again);
+            seagrass_required_true(!pthread_mutex_lock(&key->mutex));
+            if (!--key->holders) {
+                key->held = NULL;
+            }
+            seagrass_required_true(!pthread_mutex_unlock(&key->mutex));
+            stress_release(worker, out);
+        }
+        if (worker->shrinks && !((i + 1) % STRESS_SHRINK_INTERVAL)) {
+            const struct stress_mark mark = stress_begin();
+            seagrass_required_true(worker->target->shrink(
+                    worker->target->pool));
+            stress_record(worker, STRESS_SHRINK, &mark);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Print a merged histogram of nanoseconds.
+ * <p>Bucket <i>i</i> counts durations of at least 2^<i>i</i> nanoseconds,
+ * trailing empty buckets are left out.</p>
+ * @param [in] histogram to print.
+ * @param [in] length number of buckets of histogram.
+ */
+static void stress_print_histogram(const uint64_t *const histogram,
+                                   const size_t length) {
+    size_t last = 0;
+    uint64_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (histogram[i]) {
+            last = i;
+        }
+        count += histogram[i];
+    }
+    uint64_t p50 = 0, p99 = 0, seen = 0;
+    for (size_t i = 0; count && i <= last; i++) {
+        seen += histogram[i];
+        if (!p50 && seen * 2 >= count) {
+            p50 = UINT64_C(1) << (i + 1);
+        }
+        if (!p99 && seen * 100 >= count * 99) {
+            p99 = UINT64_C(1) << (i + 1);
+        }
+    }
+    printf("{\"count\":%" PRIu64 ",\"p50_ns_below\":%" PRIu64
+           ",\"p99_ns_below\":%" PRIu64 ",\"buckets\":[",
+           count, p50, p99);
+    for (size_t i = 0; count && i <= last; i++) {
+        printf("%s%" PRIu64, i ? "," : "", histogram[i]);
+    }
+    printf("]}");
+}
+
+/**
+ * @brief Race get, release and shrink on a string pool from many threads.
+ * <p>Every run is reported as a line of JSON per operation, with the
+ * durations and lock waits of that operation, followed by a line of the
+ * string pool's own counters over the whole run.</p>
+ * @param [in] target string pool to stress.
+ * @param [in] threads number of threads.
+ * @param [in] operations per thread.
+ * @return number of interning identity violations seen.
+ */
+static uint64_t stress_target(const struct stress_target *const target,
+                              const size_t threads,
+                              const size_t operations) {
+    struct stress_key *const keys = calloc(STRESS_KEYS, sizeof(*keys));
+    struct triggerfish_strong **const pinned
+            = malloc(STRESS_PINNED_KEYS * sizeof(*pinned));
+    struct stress_worker *const workers = calloc(threads, sizeof(*workers));
+    seagrass_required(keys);
+    seagrass_required(pinned);
+    seagrass_required(workers);
+    char chars[32];
+    size_t out;
+    for (size_t i = 0; i < STRESS_KEYS; i++) {
+        const int size = snprintf(chars, sizeof(chars), "stress.%zu",
+                                  i * 2654435761u);
+        seagrass_required_true(sea_turtle_string_init(&keys[i].string, chars,
+                                                      size, &out));
+        seagrass_required_true(!pthread_mutex_init(&keys[i].mutex, NULL));
+    }
+    for (size_t i = 0; i < STRESS_PINNED_KEYS; i++) {
+        seagrass_required_true(target->get(target->pool, &keys[i].string,
+                                           &pinned[i]));
+    }
+    struct pufferfish_string_pool_stats before;
+    seagrass_required_true(target->stats(target->pool, &before));
+    for (size_t i = 0; i < threads; i++) {
+        workers[i] = (struct stress_worker) {
+                .target = target,
+                .keys = keys,
+                .pinned = pinned,
+                .operations = operations,
+                .seed = UINT64_C(0x9e3779b97f4a7c15) * (i + 1),
+                .shrinks = !i
+        };
+    }
+    const uint64_t start = now();
+    for (size_t i = 0; i < threads; i++) {
+        seagrass_required_true(!pthread_create(&workers[i].thread, NULL,
+                                               stress_work, &workers[i]));
+    }
+    for (size_t i = 0; i < threads; i++) {
+        seagrass_required_true(!pthread_join(workers[i].thread, NULL));
+    }
+    const uint64_t elapsed = now() - start;
+    struct pufferfish_string_pool_stats after;
+    seagrass_required_true(target->stats(target->pool, &after));
+    uint64_t violations = 0;
+    for (size_t i = 0; i < threads; i++) {
+        violations += workers[i].violations;
+    }
+    for (enum stress_operation o = STRESS_GET; o < STRESS_OPERATIONS; o++) {
+        uint64_t histogram[STRESS_BUCKETS] = {0};
+        uint64_t waits[STRESS_BUCKETS] = {0};
+        uint64_t wait_ns = 0;
+        for (size_t i = 0; i < threads; i++) {
+            for (size_t b = 0; b < STRESS_BUCKETS; b++) {
+                histogram[b] += workers[i].histograms[o][b];
+                waits[b] += workers[i].waits[o][b];
+            }
+            wait_ns += workers[i].wait_ns[o];
+        }
+        printf("{\"pool\":\"%s\",\"threads\":%zu,\"operation\":\"%s\","
+               "\"lock_wait_ns\":%" PRIu64 ",\"duration\":",
+               target->name, threads, stress_operation_names[o], wait_ns);
+        stress_print_histogram(histogram, STRESS_BUCKETS);
+        printf(",\"lock_waits\":");
+        stress_print_histogram(waits, STRESS_BUCKETS);
+        printf("}\n");
+    }
+    uint64_t waits[PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS];
+    for (size_t b = 0; b < PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS; b++) {
+        waits[b] = after.lock_wait_histogram[b]
+                   - before.lock_wait_histogram[b];
+    }
+    printf("{\"pool\":\"%s\",\"threads\":%zu,"
+           "\"elapsed_ns\":%" PRIu64 ",\"violations\":%" PRIu64 ","
+           "\"upgrades\":%ju,\"evictions\":%ju,\"lock_wait_ns\":%ju,"
+           "\"lock_waits\":",
+           target->name, threads, elapsed, violations,
+           after.upgrades - before.upgrades,
+           after.evictions - before.evictions,
+           after.lock_wait_ns - before.lock_wait_ns);
+    stress_print_histogram(waits, PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS);
+    printf("}\n");
+    fflush(stdout);
+    for (size_t i = 0; i < STRESS_PINNED_KEYS; i++) {
+        seagrass_required_true(triggerfish_strong_release(pinned[i]));
+    }
+    seagrass_required_true(target->shrink(target->pool));
+    for (size_t i = 0; i < STRESS_KEYS; i++) {
+        seagrass_required_true(!keys[i].holders);
+        seagrass_required_true(!pthread_mutex_destroy(&keys[i].mutex));
+        seagrass_required_true(sea_turtle_string_invalidate(&keys[i].string));
+    }
+    free(workers);
+    free(pinned);
+    free(keys);
+    return violations;
+}
+
+static bool stress_get_pool(void *pool,
+                            const struct sea_turtle_string *string,
+                            struct triggerfish_strong **out) {
+    return pufferfish_string_pool_get(pool, string, out);
+}
+
+static bool stress_get_chars_pool(void *pool,
+                                  const struct sea_turtle_string *string,
+                                  struct triggerfish_strong **out) {
+    return pufferfish_string_pool_get_chars(pool, string->data, string->size,
+                                            NULL, out);
+}
+
+static bool stress_get_sharded_pool(void *pool,
+                                    const struct sea_turtle_string *string,
+                                    struct triggerfish_strong **out) {
+    return pufferfish_sharded_string_pool_get(pool, string, out);
+}
+
+static bool stress_shrink_pool(void *pool) {
+    return pufferfish_string_pool_shrink(pool);
+}
+
+static bool stress_shrink_step_pool(void *pool) {
+    bool out;
+    return pufferfish_string_pool_shrink_step(pool, STRESS_KEYS / 8, &out);
+}
+
+static bool stress_drain_pool(void *pool) {
+    bool out;
+    return pufferfish_string_pool_drain(pool, STRESS_KEYS / 8, &out);
+}
+
+static bool stress_shrink_sharded_pool(void *pool) {
+    return pufferfish_sharded_string_pool_shrink(pool);
+}
+
+static bool stress_stats_pool(void *pool,
+                              struct pufferfish_string_pool_stats *out) {
+    return pufferfish_string_pool_stats(pool, out);
+}
+
+static bool stress_stats_sharded_pool(
+        void *pool, struct pufferfish_string_pool_stats *out) {
+    return pufferfish_sharded_string_pool_stats(pool, out);
+}
+
+/**
+ * @brief Stress every string pool configuration.
+ * @param [in] threads number of threads.
+ * @param [in] operations per thread.
+ * @return number of interning identity violations seen.
+ */
+static uint64_t stress(const size_t threads, const size_t operations) {
+    struct pufferfish_string_pool tree, table, lock_free, cached, stepped,
+            deferred, budgeted;
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &tree, PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &table, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &lock_free, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                        | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &cached, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                     | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &stepped, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                      | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                      | PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &deferred, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                       | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                       | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    seagrass_required_true(pufferfish_string_pool_init_with_flags(
+            &budgeted, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                       | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ));
+    /* evictions race lock free retrievals of the strings evicted */
+    seagrass_required_true(pufferfish_string_pool_set_budget(
+            &budgeted, STRESS_PINNED_KEYS + STRESS_KEYS / 4));
+    /* the reclaimer races the explicit drains */
+    seagrass_required_true(pufferfish_string_pool_reclaimer_start(
+            &deferred, 100000));
+    struct pufferfish_sharded_string_pool sharded;
+    seagrass_required_true(pufferfish_sharded_string_pool_init(
+            &sharded, 16, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const struct stress_target targets[] = {
+            {"red-black-tree", &tree, stress_get_pool,
+             stress_shrink_pool, stress_stats_pool},
+            {"hash-table", &table, stress_get_chars_pool,
+             stress_shrink_pool, stress_stats_pool},
+            {"lock-free-read", &lock_free, stress_get_pool,
+             stress_shrink_pool, stress_stats_pool},
+            {"thread-cache", &cached, stress_get_pool,
+             stress_shrink_pool, stress_stats_pool},
+            {"auto-shrink", &stepped, stress_get_chars_pool,
+             stress_shrink_step_pool, stress_stats_pool},
+            {"deferred-reclaim", &deferred, stress_get_pool,
+             stress_drain_pool, stress_stats_pool},
+            {"budget", &budgeted, stress_get_pool,
+             stress_shrink_pool, stress_stats_pool},
+            {"sharded-16", &sharded, stress_get_sharded_pool,
+             stress_shrink_sharded_pool, stress_stats_sharded_pool}
+    };
+    uint64_t violations = 0;
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        violations += stress_target(&targets[i], threads, operations);
+    }
+    seagrass_required_true(pufferfish_sharded_string_pool_invalidate(
+            &sharded));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&budgeted));
+    seagrass_required_true(pufferfish_string_pool_reclaimer_stop(&deferred));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&deferred));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&stepped));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&cached));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&lock_free));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&table));
+    seagrass_required_true(pufferfish_string_pool_invalidate(&tree));
+    return violations;
+}
+
+int main(int argc, char *argv[]) {
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t threads = argc > 1
+                           ? strtoull(argv[1], NULL, 10)
+                           : processors > 1 ? (size_t) processors : 2;
+    const size_t operations = argc > 2
+                              ? strtoull(argv[2], NULL, 10)
+                              : 100000;
+    if (!threads || !operations) {
+        fprintf(stderr, "usage: %s [threads] [operations-per-thread]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    const uint64_t violations = stress(threads, operations);
+    if (violations) {
+        fprintf(stderr, "%" PRIu64 " interning identity violations\n",
+                violations);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -6,6 +6,10 @@
 #include <stdint.h>
 
 #include <pufferfish/error.h>
+#include <pufferfish/hash.h>
 #include <pufferfish/string_pool.h>
+#include <pufferfish/sharded_string_pool.h>
+#include <pufferfish/static_string_pool.h>
+#include <pufferfish/scoped_string_pool.h>
 
 #endif /* _PUFFERFISH_PUFFERFISH_H_ */
@@ -0,0 +1,23 @@
+#ifndef _PUFFERFISH_HASH_H_
+#define _PUFFERFISH_HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* identifies pufferfish_hash(), changes whenever the hash values change */
+#define PUFFERFISH_HASH_ID                                          2
+
+/**
+ * @brief Calculate hash of data.
+ * <p>This is the hash the string pools use, callers that already have it can
+ * pass it along to skip hashing the string again.</p>
+ * <p>CRC instructions are used where the processor has them, on x86-64 they
+ * are detected at run time. The values are the same on every platform and
+ * with or without them.</p>
+ * @param [in] data to be hashed.
+ * @param [in] size of data in bytes.
+ * @param [out] out receive the hash.
+ */
+void pufferfish_hash(const void *data, size_t size, uintmax_t *out);
+
+#endif /* _PUFFERFISH_HASH_H_ */
@@ -0,0 +1,153 @@
+#ifndef _PUFFERFISH_SCOPED_STRING_POOL_H_
+#define _PUFFERFISH_SCOPED_STRING_POOL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pufferfish/string_pool.h>
+
+struct sea_turtle_string;
+struct triggerfish_strong;
+
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL              1
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED    2
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL              3
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL                 4
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED   5
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_PARENT_IS_NULL              6
+#define PUFFERFISH_SCOPED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED         7
+
+struct pufferfish_scoped_string_pool_chunk;
+struct pufferfish_scoped_string_pool_slot;
+struct pufferfish_scoped_string_pool_entry;
+
+/*
+ * A scoped string pool is used by one thread at a time, only its parent is
+ * shared.
+ */
+struct pufferfish_scoped_string_pool {
+    struct pufferfish_string_pool *parent;
+    /* bump allocated, newest first */
+    struct pufferfish_scoped_string_pool_chunk *chunks;
+    struct pufferfish_scoped_string_pool_slot *slots;
+    uintmax_t length;
+    uintmax_t count;
+    /* entries holding a strong reference of a string of the parent */
+    struct pufferfish_scoped_string_pool_entry *borrowed;
+};
+
+/**
+ * @brief Initialize scoped string pool.
+ * <p>Strings are looked up in the scoped string pool first and then in the
+ * parent, strings found in neither are copied into chunks owned by the scope
+ * instead of being added to the parent. Retrieved strings are borrowed: they
+ * need no releasing and stay valid until the scoped string pool is
+ * invalidated, which frees its chunks at once.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] parent string pool, it must outlive the scoped string pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_PARENT_IS_NULL if parent is
+ * <i>NULL</i>.
+ */
+bool pufferfish_scoped_string_pool_init(
+        struct pufferfish_scoped_string_pool *object,
+        struct pufferfish_string_pool *parent);
+
+/**
+ * @brief Invalidate scoped string pool.
+ * <p>The actual <u>scoped string pool instance is not deallocated</u> since
+ * it may have been embedded in a larger structure. Strings retrieved from it
+ * are no longer valid, promote those that must outlive it.</p>
+ * @param [in] object instance to be invalidated.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ */
+bool pufferfish_scoped_string_pool_invalidate(
+        struct pufferfish_scoped_string_pool *object);
+
+/**
+ * @brief Retrieve the matching string in the scoped string pool.
+ * @param [in] object scoped string pool instance.
+ * @param [in] string to find in scoped string pool.
+ * @param [out] out receive string that is equal to the one found, the same
+ * for equal strings until the scoped string pool is invalidated.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL if string is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the parent has been
+ * reached.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve string.
+ */
+bool pufferfish_scoped_string_pool_get(
+        struct pufferfish_scoped_string_pool *object,
+        const struct sea_turtle_string *string,
+        const struct sea_turtle_string **out);
+
+/**
+ * @brief Retrieve the matching string for a sequence of bytes.
+ * <p>Bytes are only validated if they are found in neither the scoped
+ * string pool nor a hash table parent.</p>
+ * @param [in] object scoped string pool instance.
+ * @param [in] chars UTF-8 encoded contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars as calculated by pufferfish_hash() or <i>NULL</i>
+ * to have it calculated.
+ * @param [out] out receive string that is equal to chars, the same for equal
+ * chars until the scoped string pool is invalidated.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL if chars is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the parent has been
+ * reached.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve string.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if chars
+ * are not yet pooled and do not form a valid string.
+ */
+bool pufferfish_scoped_string_pool_get_chars(
+        struct pufferfish_scoped_string_pool *object,
+        const char *chars,
+        size_t size,
+        const uintmax_t *hash,
+        const struct sea_turtle_string **out);
+
+/**
+ * @brief Add string to the parent so that it outlives the scope.
+ * @param [in] object scoped string pool instance.
+ * @param [in] string to promote, usually one retrieved from the scoped
+ * string pool.
+ * @param [out] out strong reference of string in the parent.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL if string is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the parent has been
+ * reached.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to add string to the parent.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_scoped_string_pool_promote(
+        struct pufferfish_scoped_string_pool *object,
+        const struct sea_turtle_string *string,
+        struct triggerfish_strong **out);
+
+#endif /* _PUFFERFISH_SCOPED_STRING_POOL_H_ */
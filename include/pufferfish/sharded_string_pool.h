@@ -0,0 +1,186 @@
+#ifndef _PUFFERFISH_SHARDED_STRING_POOL_H_
+#define _PUFFERFISH_SHARDED_STRING_POOL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <pufferfish/string_pool.h>
+
+struct sea_turtle_string;
+struct triggerfish_strong;
+
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL             1
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED   2
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL             3
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL                4
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED  5
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_FLAGS_ARE_INVALID          6
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_COUNT_IS_ZERO              7
+#define PUFFERFISH_SHARDED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED        8
+
+#define PUFFERFISH_SHARDED_STRING_POOL_CACHE_LINE                       64
+
+struct pufferfish_sharded_string_pool_shard {
+    /* keep each shard's lock on its own cache line */
+    alignas(PUFFERFISH_SHARDED_STRING_POOL_CACHE_LINE)
+    struct pufferfish_string_pool pool;
+};
+
+struct pufferfish_sharded_string_pool {
+    uintmax_t count;
+    struct pufferfish_sharded_string_pool_shard *shards;
+};
+
+/**
+ * @brief Initialize sharded string pool.
+ * <p>Strings are distributed over <b>count</b> independent string pools by
+ * their hash, each with its own lock, so that threads interning different
+ * strings rarely contend with each other.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] count number of shards.
+ * @param [in] flags to configure each shard's string pool with.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_COUNT_IS_ZERO if count is
+ * zero.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_FLAGS_ARE_INVALID if flags
+ * contains an unknown flag.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to initialize sharded string pool.
+ */
+bool pufferfish_sharded_string_pool_init(
+        struct pufferfish_sharded_string_pool *object,
+        uintmax_t count,
+        uintmax_t flags);
+
+/**
+ * @brief Invalidate sharded string pool.
+ * <p>The actual <u>sharded string pool instance is not deallocated</u> since
+ * it may have been embedded in a larger structure.</p>
+ * @param [in] object instance to be invalidated.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ */
+bool pufferfish_sharded_string_pool_invalidate(
+        struct pufferfish_sharded_string_pool *object);
+
+/**
+ * @brief Retrieve the matching strong reference in the sharded string pool.
+ * @param [in] object sharded string pool instance.
+ * @param [in] string to find in sharded string pool.
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL if string is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the string's shard has
+ * been reached.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve pooled string instance.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_sharded_string_pool_get(
+        struct pufferfish_sharded_string_pool *object,
+        const struct sea_turtle_string *string,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the matching strong reference for a sequence of bytes.
+ * <p>With hash table shards a hit is found without allocating, the bytes are
+ * only turned into a string if they are not yet pooled.</p>
+ * @param [in] object sharded string pool instance.
+ * @param [in] chars UTF-8 encoded contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars as calculated by pufferfish_hash() or <i>NULL</i>
+ * to have it calculated.
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL if chars is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the string's shard has
+ * been reached.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve pooled string instance.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if chars
+ * are not yet pooled and do not form a valid string.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_sharded_string_pool_get_chars(
+        struct pufferfish_sharded_string_pool *object,
+        const char *chars,
+        size_t size,
+        const uintmax_t *hash,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the matching strong references of a batch of strings.
+ * <p>Strings are grouped by shard so that each shard's lock is taken once
+ * for the whole batch.</p>
+ * @param [in] object sharded string pool instance.
+ * @param [in] strings to find in sharded string pool.
+ * @param [in] count of strings.
+ * @param [out] out receive strong references of strings in pool, must hold
+ * <b>count</b> elements.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL if strings or
+ * any of its elements is <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on a shard has been reached.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve pooled string instances.
+ * @note On failure no strong references are retrieved, otherwise each element
+ * of <b>out</b> must be released once done with it.
+ */
+bool pufferfish_sharded_string_pool_get_many(
+        struct pufferfish_sharded_string_pool *object,
+        const struct sea_turtle_string *const *strings,
+        uintmax_t count,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Remove all unused entries.
+ * <p>Shards are shrunk one at a time so only threads using the shard being
+ * shrunk are blocked.</p>
+ * @param [in] object sharded string pool instance.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ */
+bool pufferfish_sharded_string_pool_shrink(
+        struct pufferfish_sharded_string_pool *object);
+
+/**
+ * @brief Retrieve statistics summed over all shards.
+ * <p>Each shard is counted under its own read lock so the sum is not a
+ * consistent snapshot while strings are being added.</p>
+ * @param [in] object sharded string pool instance.
+ * @param [out] out receive statistics.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_SHARDED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on a shard has been reached.
+ */
+bool pufferfish_sharded_string_pool_stats(
+        struct pufferfish_sharded_string_pool *object,
+        struct pufferfish_string_pool_stats *out);
+
+#endif /* _PUFFERFISH_SHARDED_STRING_POOL_H_ */
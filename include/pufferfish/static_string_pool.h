@@ -0,0 +1,217 @@
+#ifndef _PUFFERFISH_STATIC_STRING_POOL_H_
+#define _PUFFERFISH_STATIC_STRING_POOL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pufferfish/string_pool.h>
+
+struct sea_turtle_string;
+struct triggerfish_strong;
+
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL              1
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED    2
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL              3
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL                 4
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED   5
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_COUNT_IS_ZERO               6
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_CHARS_ARE_MALFORMED         7
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_STRINGS_ARE_NOT_DISTINCT    8
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND            9
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_NULL               10
+#define PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_MALFORMED          11
+
+/* string of a static string pool table */
+struct pufferfish_static_string_pool_string {
+    /* UTF-8 encoded contents followed by a NUL */
+    const char *data;
+    /* size of data in bytes, excluding the NUL */
+    size_t size;
+    /* number of code points */
+    size_t count;
+    /* as calculated by pufferfish_hash() */
+    uintmax_t hash;
+};
+
+/*
+ * Minimal perfect hash over a fixed set of strings. A string's hash selects
+ * a bucket whose seed displaces it onto its own slot, so a lookup is a
+ * single probe of strings.
+ */
+struct pufferfish_static_string_pool_table {
+    /* PUFFERFISH_HASH_ID of the hash the table was built with */
+    uintmax_t hash_id;
+    /* number of strings and slots */
+    uintmax_t count;
+    /* number of seeds */
+    uintmax_t buckets;
+    const uint32_t *seeds;
+    /* in slot order */
+    const struct pufferfish_static_string_pool_string *strings;
+};
+
+struct pufferfish_static_string_pool_entries;
+
+struct pufferfish_static_string_pool {
+    struct pufferfish_static_string_pool_table table;
+    struct pufferfish_string_pool *fallback;
+    struct pufferfish_static_string_pool_entries *entries;
+};
+
+/**
+ * @brief Initialize static string pool from a set of strings.
+ * <p>A minimal perfect hash over the strings is built once so that lookups
+ * take no lock and probe a single slot. The static string pool never
+ * changes after this, strings that it does not hold are retrieved from the
+ * fallback string pool instead.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] strings to hold, copied into the static string pool.
+ * @param [in] count of strings.
+ * @param [in] fallback string pool for strings not held or <i>NULL</i> if
+ * there is none. It must outlive the static string pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL if strings or
+ * any of its elements is <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_COUNT_IS_ZERO if count is
+ * zero.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRINGS_ARE_NOT_DISTINCT if
+ * strings contains the same string twice.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to initialize static string pool.
+ */
+bool pufferfish_static_string_pool_init(
+        struct pufferfish_static_string_pool *object,
+        const struct sea_turtle_string *const *strings,
+        uintmax_t count,
+        struct pufferfish_string_pool *fallback);
+
+/**
+ * @brief Initialize static string pool from a prebuilt table.
+ * <p>Tables are emitted as C source by the static string pool generator so
+ * that vocabularies known at compile time need no building at run time.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] table to use, it must outlive the static string pool and any
+ * string retrieved from it.
+ * @param [in] fallback string pool for strings not held or <i>NULL</i> if
+ * there is none. It must outlive the static string pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_NULL if table is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_MALFORMED if table
+ * was built with a different hash or its strings are not on their slots.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to initialize static string pool.
+ */
+bool pufferfish_static_string_pool_init_with_table(
+        struct pufferfish_static_string_pool *object,
+        const struct pufferfish_static_string_pool_table *table,
+        struct pufferfish_string_pool *fallback);
+
+/**
+ * @brief Invalidate static string pool.
+ * <p>The actual <u>static string pool instance is not deallocated</u> since
+ * it may have been embedded in a larger structure. Strings retrieved from it
+ * remain valid until they are released.</p>
+ * @param [in] object instance to be invalidated.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ */
+bool pufferfish_static_string_pool_invalidate(
+        struct pufferfish_static_string_pool *object);
+
+/**
+ * @brief Retrieve the matching strong reference in the static string pool.
+ * <p>Strings that the static string pool does not hold are retrieved from
+ * the fallback string pool.</p>
+ * @param [in] object static string pool instance.
+ * @param [in] string to find in static string pool.
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL if string is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND if string is
+ * not held and there is no fallback string pool.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the fallback string pool
+ * has been reached.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve pooled string instance.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_static_string_pool_get(
+        struct pufferfish_static_string_pool *object,
+        const struct sea_turtle_string *string,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the matching strong reference for a sequence of bytes.
+ * <p>Held strings are found without allocating, other bytes are handed to
+ * the fallback string pool together with their hash.</p>
+ * @param [in] object static string pool instance.
+ * @param [in] chars UTF-8 encoded contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars as calculated by pufferfish_hash() or <i>NULL</i>
+ * to have it calculated.
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL if chars is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND if chars are
+ * not held and there is no fallback string pool.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if
+ * the maximum number of concurrent operations on the fallback string pool
+ * has been reached.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to retrieve pooled string instance.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if chars
+ * are handed to the fallback string pool and do not form a valid string.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_static_string_pool_get_chars(
+        struct pufferfish_static_string_pool *object,
+        const char *chars,
+        size_t size,
+        const uintmax_t *hash,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the slot of a held string.
+ * <p>Slots are dense and fixed by the table, so they can serve as compact
+ * identifiers of the vocabulary. The fallback string pool is not used.</p>
+ * @param [in] object static string pool instance.
+ * @param [in] chars UTF-8 encoded contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars as calculated by pufferfish_hash() or <i>NULL</i>
+ * to have it calculated.
+ * @param [out] out receive slot of string, less than the table's count.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL if chars is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND if chars are
+ * not held.
+ */
+bool pufferfish_static_string_pool_find(
+        const struct pufferfish_static_string_pool *object,
+        const char *chars,
+        size_t size,
+        const uintmax_t *hash,
+        uintmax_t *out);
+
+#endif /* _PUFFERFISH_STATIC_STRING_POOL_H_ */
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdatomic.h>
 #include <seahorse.h>
 #include <pthread.h>
 
@@ -15,10 +16,134 @@ struct triggerfish_strong;
 #define PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL                 3
 #define PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL                    4
 #define PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED      5
+#define PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID              6
+#define PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED            7
+#define PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID              8
+#define PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED           9
+#define PUFFERFISH_STRING_POOL_ERROR_STRING_IS_FOREIGN              10
+#define PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO                  11
+#define PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL                   12
+#define PUFFERFISH_STRING_POOL_ERROR_IO_FAILED                      13
+#define PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_MALFORMED          14
+#define PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_NULL               15
+#define PUFFERFISH_STRING_POOL_ERROR_STRING_POOL_IS_NULL            16
+#define PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE                17
+#define PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED            18
+#define PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_RUNNING           19
+#define PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_STOPPED           20
+#define PUFFERFISH_STRING_POOL_ERROR_PERIOD_IS_ZERO                 21
+#define PUFFERFISH_STRING_POOL_ERROR_HASH_TABLE_IS_DISABLED         22
+#define PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO               23
+
+/* entries are kept in a red-black tree ordered by string (default) */
+#define PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE                  0
+/* entries are kept in an open-addressing hash table with cached hashes */
+#define PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE                      (1 << 0)
+/* hits are found without taking the lock, requires hash table */
+#define PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ                  (1 << 1)
+/* entries are numbered with dense 32-bit symbols, requires hash table */
+#define PUFFERFISH_STRING_POOL_FLAG_SYMBOLS                         (1 << 2)
+/* unused entries are removed while adding strings, requires hash table */
+#define PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK                     (1 << 3)
+/* hits are served from a per-thread cache, requires lock free read */
+#define PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE                    (1 << 4)
+/* dead entries are queued as they die and removed by draining the queue */
+#define PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM                (1 << 5)
+
+/* lock waits are counted in this many power of two buckets of nanoseconds */
+#define PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS                    32
+
+struct pufferfish_string_pool_entry;
+struct pufferfish_string_pool_table;
+struct pufferfish_string_pool_symbols;
+struct pufferfish_arena;
+struct pufferfish_stats;
+struct pufferfish_string_pool_snapshot;
+struct pufferfish_string_pool_index;
+struct pufferfish_string_pool_reclaimer;
 
 struct pufferfish_string_pool {
     pthread_rwlock_t lock;
     struct seahorse_red_black_tree_map_s_wr map;
+    struct pufferfish_string_pool_table *_Atomic table;
+    struct pufferfish_string_pool_entry *retired_entries;
+    struct pufferfish_string_pool_table *retired_tables;
+    struct pufferfish_string_pool_symbols *_Atomic symbols;
+    struct pufferfish_string_pool_symbols *retired_symbols;
+    /* one past the first released symbol, 0 if there is none */
+    uintmax_t symbols_free;
+    /* where pufferfish_string_pool_shrink_step() resumes */
+    uintmax_t shrink_cursor;
+    struct triggerfish_strong *shrink_cursor_string;
+    struct pufferfish_arena *arena;
+    /* distinguishes string pools in the per-thread caches */
+    uintmax_t serial;
+    /* advanced whenever an entry is removed, stales per-thread caches */
+    atomic_uintmax_t generation;
+    /* NULL if counters are compiled out */
+    struct pufferfish_stats *stats;
+    /* frozen strings beneath the string pool, NULL if there are none */
+    struct pufferfish_string_pool_snapshot *snapshot;
+    /* hash table entries in string order, NULL until a cursor needs it */
+    struct pufferfish_string_pool_index *index;
+    /* dead entries taken off the queue but not yet removed */
+    struct pufferfish_string_pool_entry *dead;
+    /* red-black tree entries with deferred reclaim, reachable even once
+     * their weak references have expired */
+    struct pufferfish_string_pool_entry **owned;
+    uintmax_t owned_count;
+    uintmax_t owned_capacity;
+    /* NULL unless the background reclaimer is running */
+    struct pufferfish_string_pool_reclaimer *reclaimer;
+    /* entries beyond which unused strings are evicted, 0 if none are kept */
+    uintmax_t budget;
+    /* next slot examined by the eviction clock */
+    uintmax_t clock_hand;
+    uintmax_t retired;
+    uintmax_t count;
+    uintmax_t flags;
+};
+
+/* carried by every pooled string, read without hashing or comparing it */
+struct pufferfish_string_pool_header {
+    /* contents of the pooled string */
+    const struct sea_turtle_string *string;
+    /* pufferfish_hash() of the contents */
+    uintmax_t hash;
+    /* size of the contents in bytes */
+    size_t size;
+};
+
+/*
+ * Counters are maintained unless the library is compiled with
+ * PUFFERFISH_NO_STATS defined, in which case they are always zero.
+ */
+struct pufferfish_string_pool_stats {
+    /* entries in the string pool */
+    uintmax_t entries;
+    /* entries whose string is strongly referenced */
+    uintmax_t live;
+    /* entries whose string has been released, removed on shrink or drain */
+    uintmax_t dead;
+    /* bytes held for entries and tables, excluding red-black tree nodes */
+    uintmax_t bytes;
+    /* lookups that found their string pooled */
+    uintmax_t hits;
+    /* lookups that added their string */
+    uintmax_t misses;
+    /* unused strings evicted to stay within the budget */
+    uintmax_t evictions;
+    /* times the read lock was given up to take the write lock */
+    uintmax_t upgrades;
+    /* read and write lock acquisitions that had to wait */
+    uintmax_t lock_waits;
+    /* nanoseconds spent waiting for the read or write lock */
+    uintmax_t lock_wait_ns;
+    /*
+     * lock waits by duration, bucket i counts waits of at least 2^i and less
+     * than 2^(i + 1) nanoseconds, the last bucket also counts longer waits
+     */
+    uintmax_t lock_wait_histogram[PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS];
 };
 
 /**
@@ -31,6 +156,68 @@ struct pufferfish_string_pool {
  */
 bool pufferfish_string_pool_init(struct pufferfish_string_pool *object);
 
+/**
+ * @brief Initialize string pool with flags.
+ * <p>Passing <i>PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE</i> will have the
+ * string pool use a hash table instead of a red-black tree to find pooled
+ * strings, a hit then costs a single hash and usually a single
+ * comparison.</p>
+ * <p>Adding <i>PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ</i> to a hash table
+ * string pool has hits found without taking the lock, only adding strings
+ * and removing unused entries are serialized. Removed entries are reclaimed
+ * once no thread can still be reading them.</p>
+ * <p>Adding <i>PUFFERFISH_STRING_POOL_FLAG_SYMBOLS</i> to a hash table string
+ * pool numbers its strings with 32-bit symbols, see
+ * pufferfish_string_pool_symbol() and pufferfish_string_pool_resolve().</p>
+ * <p>Adding <i>PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK</i> to a hash table
+ * string pool keeps count of entries whose last strong reference has been
+ * released, once enough have accumulated adding a string also performs a
+ * bounded pufferfish_string_pool_shrink_step().</p>
+ * <p>Adding <i>PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE</i> to a lock free
+ * read string pool puts a small direct-mapped cache, private to each thread,
+ * in front of the hash table. A hit in it neither probes the shared hash
+ * table nor takes the lock. Removing entries, such as through
+ * pufferfish_string_pool_shrink(), and invalidating the string pool make
+ * every cached entry of it stale, see
+ * pufferfish_string_pool_thread_cache_counters() to size it.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] flags to configure string pool with.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID if flags contains an
+ * unknown flag or a flag that requires a flag which is missing.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to initialize string pool.
+ */
+bool pufferfish_string_pool_init_with_flags(
+        struct pufferfish_string_pool *object,
+        uintmax_t flags);
+
+/**
+ * @brief Initialize string pool on top of a snapshot.
+ * <p>Strings of the snapshot are found as if they had been added to the
+ * string pool, retrieving one for the first time only allocates a small
+ * entry referring to its contents inside the snapshot. The snapshot is kept
+ * mapped for as long as the string pool or any string retrieved from it
+ * refers to it.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] flags to configure string pool with, see
+ * pufferfish_string_pool_init_with_flags().
+ * @param [in] snapshot opened with pufferfish_string_pool_snapshot_open().
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_NULL if snapshot is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID if flags contains an
+ * unknown flag or a flag that requires a flag which is missing.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to initialize string pool.
+ */
+bool pufferfish_string_pool_init_with_snapshot(
+        struct pufferfish_string_pool *object,
+        uintmax_t flags,
+        struct pufferfish_string_pool_snapshot *snapshot);
+
 /**
  * @brief Invalidate string pool.
  * <p>The actual <u>string pool instance is not deallocated</u> since it may
@@ -61,12 +248,489 @@ bool pufferfish_string_pool_get(struct pufferfish_string_pool *object,
                                 const struct sea_turtle_string *string,
                                 struct triggerfish_strong **out);
 
+/**
+ * @brief Retrieve the matching strong reference for a sequence of bytes.
+ * <p>With a hash table string pool a hit is found without allocating, the
+ * bytes are only turned into a string if they are not yet pooled.</p>
+ * @param [in] object string pool instance.
+ * @param [in] chars UTF-8 encoded contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars as calculated by pufferfish_hash() or <i>NULL</i>
+ * to have it calculated.
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if chars is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve pooled string instance.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if chars are not
+ * yet pooled and do not form a valid string.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_string_pool_get_chars(struct pufferfish_string_pool *object,
+                                      const char *chars,
+                                      size_t size,
+                                      const uintmax_t *hash,
+                                      struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the matching strong references of a batch of strings.
+ * <p>The lock is taken once for the whole batch and all strings that are not
+ * yet pooled are added under a single write lock acquisition.</p>
+ * @param [in] object string pool instance.
+ * @param [in] strings to find in string pool.
+ * @param [in] count of strings.
+ * @param [out] out receive strong references of strings in pool, must hold
+ * <b>count</b> elements.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if strings or any of
+ * its elements is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve pooled string instances.
+ * @note On failure no strong references are retrieved, otherwise each element
+ * of <b>out</b> must be released once done with it.
+ */
+bool pufferfish_string_pool_get_many(
+        struct pufferfish_string_pool *object,
+        const struct sea_turtle_string *const *strings,
+        uintmax_t count,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Add a large batch of strings to the string pool.
+ * <p>Strings are hashed and deduplicated in parallel by up to <b>threads</b>
+ * threads, including the calling one. The distinct strings are then added
+ * under a single write lock acquisition, after a hash table has been grown
+ * once to hold all of them.</p>
+ * @param [in] object string pool instance.
+ * @param [in] strings to be added.
+ * @param [in] count of strings.
+ * @param [in] threads to hash and deduplicate with at most, small batches use
+ * fewer.
+ * @param [out] out receive strong references of strings in pool, must hold
+ * <b>count</b> elements. Equal strings receive the same strong reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if strings or any of
+ * its elements is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO if threads is zero.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to add strings.
+ * @note On failure no strong references are retrieved, otherwise each element
+ * of <b>out</b> must be released once done with it.
+ */
+bool pufferfish_string_pool_load(
+        struct pufferfish_string_pool *object,
+        const struct sea_turtle_string *const *strings,
+        uintmax_t count,
+        uintmax_t threads,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Add the lines of a file to the string pool.
+ * <p>Each line is a string without its newline, a final newline does not
+ * start another line. Lines are validated, hashed and deduplicated in parallel
+ * as by pufferfish_string_pool_load().</p>
+ * @param [in] object string pool instance.
+ * @param [in] path of file holding UTF-8 encoded lines.
+ * @param [in] threads to validate, hash and deduplicate with at most, small
+ * files use fewer.
+ * @param [out] out receive array of strong references of the distinct lines
+ * in the order they first appear.
+ * @param [out] count receive number of elements of <b>out</b>.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL if path is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out or count is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO if threads is zero.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to add the lines.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_IO_FAILED if the file could not be
+ * read.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if a line does not
+ * form a valid string.
+ * @note On success each element of <b>out</b> must be released and then
+ * <b>out</b> itself freed once done with it.
+ */
+bool pufferfish_string_pool_load_file(
+        struct pufferfish_string_pool *object,
+        const char *path,
+        uintmax_t threads,
+        struct triggerfish_strong ***out,
+        uintmax_t *count);
+
+/**
+ * @brief Retrieve the symbol of a pooled string.
+ * <p>Symbols are dense 32-bit integers, two strong references of the same
+ * string pool share a symbol if and only if they refer to the same string.
+ * A symbol stays valid as long as a strong reference to its string is held,
+ * once the string has been removed by pufferfish_string_pool_shrink() its
+ * symbol may be handed out again.</p>
+ * @param [in] object string pool instance.
+ * @param [in] string strong reference retrieved from this string pool.
+ * @param [out] out receive symbol.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if string is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED if string pool was
+ * not initialized with <i>PUFFERFISH_STRING_POOL_FLAG_SYMBOLS</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_FOREIGN if string was
+ * retrieved from another string pool or a static string pool.
+ */
+bool pufferfish_string_pool_symbol(struct pufferfish_string_pool *object,
+                                   struct triggerfish_strong *string,
+                                   uint32_t *out);
+
+/**
+ * @brief Retrieve the strong reference of the string a symbol stands for.
+ * @param [in] object string pool instance.
+ * @param [in] symbol of string.
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED if string pool was
+ * not initialized with <i>PUFFERFISH_STRING_POOL_FLAG_SYMBOLS</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register the calling thread as a reader.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID if symbol does not
+ * stand for a string in the string pool.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_string_pool_resolve(struct pufferfish_string_pool *object,
+                                    uint32_t symbol,
+                                    struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the header of a pooled string.
+ * <p>The hash is stored with the string when it is added to the string pool,
+ * so consumers keying their own hash tables by pooled strings can use it
+ * instead of hashing the contents again.</p>
+ * @param [in] string strong reference retrieved from a string pool or a
+ * static string pool.
+ * @param [out] out receive header, valid for as long as string is held.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if string is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+bool pufferfish_string_pool_header(const struct triggerfish_strong *string,
+                                   struct pufferfish_string_pool_header *out);
+
+/**
+ * @brief Compare two pooled strings by identity.
+ * <p>A string pool hands out a single strong reference per string, so two
+ * strong references retrieved from the same string pool are the same if and
+ * only if their contents are equal. Strings of different string pools are
+ * never the same.</p>
+ * @param [in] a strong reference retrieved from a string pool.
+ * @param [in] b strong reference retrieved from a string pool.
+ * @param [out] out receive true if a and b are the same string, otherwise
+ * false.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if a or b is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+bool pufferfish_string_pool_same(const struct triggerfish_strong *a,
+                                 const struct triggerfish_strong *b,
+                                 bool *out);
+
 /**
  * @brief Remove all unused entries.
+ * <p>With <i>PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM</i> the queue of
+ * dead entries is drained as well.</p>
  * @param [in] object string pool instance.
  * @return On success true, otherwise false if an error has occurred.
  * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
  */
 bool pufferfish_string_pool_shrink(struct pufferfish_string_pool *object);
 
+/**
+ * @brief Remove unused entries among the next entries.
+ * <p>Each step holds the lock for at most <b>limit</b> entries and resumes
+ * where the previous step stopped, a full pass over the string pool has
+ * completed once <b>out</b> is true.</p>
+ * @param [in] object string pool instance.
+ * @param [in] limit maximum number of entries to examine.
+ * @param [out] out receive true if a full pass has completed, otherwise false.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO if limit is zero.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+bool pufferfish_string_pool_shrink_step(struct pufferfish_string_pool *object,
+                                        uintmax_t limit,
+                                        bool *out);
+
+/**
+ * @brief Remove the next dead entries queued for removal.
+ * <p>With <i>PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM</i> an entry is
+ * queued the moment the last strong reference of its string is released, so
+ * removing it takes no search. Each call holds the lock for at most
+ * <b>limit</b> entries.</p>
+ * @param [in] object string pool instance.
+ * @param [in] limit maximum number of entries to remove.
+ * @param [out] out receive true if the queue has been emptied, otherwise
+ * false.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO if limit is zero.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED if string pool was
+ * not initialized with <i>PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM</i>.
+ */
+bool pufferfish_string_pool_drain(struct pufferfish_string_pool *object,
+                                  uintmax_t limit,
+                                  bool *out);
+
+/**
+ * @brief Start a background thread that drains the queue of dead entries.
+ * <p>The thread wakes up once per period and drains the queue in small
+ * batches, giving up the lock between them. It is stopped by
+ * pufferfish_string_pool_reclaimer_stop() or when the string pool is
+ * invalidated.</p>
+ * @param [in] object string pool instance.
+ * @param [in] period between drains in nanoseconds.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_PERIOD_IS_ZERO if period is zero.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED if string pool was
+ * not initialized with <i>PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_RUNNING if the background
+ * reclaimer has already been started.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there are
+ * insufficient resources to start the thread.
+ */
+bool pufferfish_string_pool_reclaimer_start(
+        struct pufferfish_string_pool *object,
+        uintmax_t period);
+
+/**
+ * @brief Stop the background reclaimer and wait for its thread to exit.
+ * @param [in] object string pool instance.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_STOPPED if the background
+ * reclaimer is not running.
+ */
+bool pufferfish_string_pool_reclaimer_stop(
+        struct pufferfish_string_pool *object);
+
+/**
+ * @brief Set the number of entries up to which unused strings are kept.
+ * <p>Strings whose last strong reference is released stay pooled while the
+ * string pool holds no more than <b>budget</b> entries, so that interning
+ * them again is a hit. Once a miss takes the string pool over budget, unused
+ * strings that have not been retrieved recently are evicted in CLOCK order.
+ * Strings that are still referenced are never evicted, so the string pool
+ * only grows past its budget by the strings in use. Shrinking leaves kept
+ * strings alone.</p>
+ * @param [in] object string pool instance.
+ * @param [in] budget number of entries or 0 to keep no unused strings, which
+ * releases all kept ones.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_HASH_TABLE_IS_DISABLED if string pool
+ * was not initialized with <i>PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE</i>.
+ */
+bool pufferfish_string_pool_set_budget(struct pufferfish_string_pool *object,
+                                       uintmax_t budget);
+
+/**
+ * @brief Retrieve the counters of the calling thread's cache.
+ * <p>Only lookups in string pools initialized with
+ * <i>PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE</i> are counted, across all
+ * such string pools the calling thread has used.</p>
+ * @param [out] hits receive number of lookups answered by the cache.
+ * @param [out] misses receive number of lookups that had to probe the hash
+ * table.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if hits or misses is
+ * <i>NULL</i>.
+ */
+bool pufferfish_string_pool_thread_cache_counters(uintmax_t *hits,
+                                                  uintmax_t *misses);
+
+/**
+ * @brief Retrieve the lock waits of the calling thread.
+ * <p>Waits are counted across all string pools the calling thread has used,
+ * reading them before and after an operation attributes its lock waits to
+ * it. Both are always zero if the library is compiled with
+ * <i>PUFFERFISH_NO_STATS</i> defined.</p>
+ * @param [out] waits receive number of read and write lock acquisitions that
+ * had to wait.
+ * @param [out] wait_ns receive nanoseconds spent waiting for them.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if waits or wait_ns is
+ * <i>NULL</i>.
+ */
+bool pufferfish_string_pool_thread_lock_waits(uintmax_t *waits,
+                                              uintmax_t *wait_ns);
+
+/**
+ * @brief Retrieve statistics of the string pool.
+ * <p>Entries are counted under the read lock, the counters are summed over
+ * per-thread stripes without it so they may be slightly behind concurrent
+ * operations.</p>
+ * @param [in] object string pool instance.
+ * @param [out] out receive statistics.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ */
+bool pufferfish_string_pool_stats(struct pufferfish_string_pool *object,
+                                  struct pufferfish_string_pool_stats *out);
+
+/**
+ * @brief Write the strings of the string pool to a snapshot file.
+ * <p>The snapshot holds every string that is strongly referenced, including
+ * those of the snapshot beneath the string pool, together with their hashes
+ * and a prebuilt index. Adding strings is only blocked while they are
+ * collected, not while the file is written. The file is written next to
+ * path and renamed over it, so snapshots that are still mapped, including
+ * the one beneath the string pool, are left intact. It gets the permissions
+ * open(2) would give a new file under the current file mode creation mask,
+ * and is synced to disk before it is renamed.</p>
+ * @param [in] object string pool instance.
+ * @param [in] path of file to write.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL if path is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to build the index.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_IO_FAILED if the file could not be
+ * written.
+ */
+bool pufferfish_string_pool_save(struct pufferfish_string_pool *object,
+                                 const char *path);
+
+/**
+ * @brief Map a snapshot file written by pufferfish_string_pool_save().
+ * <p>The file is mapped read-only and shared, so processes mapping the same
+ * snapshot share its pages. Opening only checks the header, its strings are
+ * read on demand.</p>
+ * @param [in] path of snapshot file.
+ * @param [out] out receive snapshot.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL if path is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to open snapshot.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_IO_FAILED if the file could not be
+ * opened or mapped.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_MALFORMED if the file is
+ * not a snapshot, is truncated or was written with a different hash.
+ * @note <b>out</b> must be closed once done with it.
+ */
+bool pufferfish_string_pool_snapshot_open(
+        const char *path,
+        struct pufferfish_string_pool_snapshot **out);
+
+/**
+ * @brief Close snapshot.
+ * <p>The file stays mapped until string pools initialized on top of it have
+ * been invalidated and all strings retrieved from its contents have been
+ * released.</p>
+ * @param [in] object snapshot instance.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+bool pufferfish_string_pool_snapshot_close(
+        struct pufferfish_string_pool_snapshot *object);
+
+/*
+ * A cursor visits the pooled strings that start with a prefix in the order
+ * of sea_turtle_string_compare(). It is used by one thread at a time.
+ */
+struct pufferfish_string_pool_cursor {
+    struct pufferfish_string_pool *string_pool;
+    struct sea_turtle_string *prefix;
+    /* last string visited, NULL if none has been visited yet */
+    struct triggerfish_strong *last;
+};
+
+/**
+ * @brief Initialize cursor over the strings that start with prefix.
+ * <p>The prefix is also the lower bound the cursor starts from, an empty
+ * prefix visits every string. Strings added or released while the cursor is
+ * in use are visited if they are still pooled and come after the last string
+ * visited. Strings of a snapshot beneath the string pool are only visited
+ * once they have been retrieved.</p>
+ * @param [in] object instance to be initialized.
+ * @param [in] string_pool to visit the strings of, it must outlive the
+ * cursor.
+ * @param [in] prefix UTF-8 encoded prefix of strings to visit.
+ * @param [in] size of prefix in bytes.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_POOL_IS_NULL if string_pool is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL if prefix is
+ * <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to initialize cursor.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if prefix is not a
+ * valid string.
+ */
+bool pufferfish_string_pool_cursor_init(
+        struct pufferfish_string_pool_cursor *object,
+        struct pufferfish_string_pool *string_pool,
+        const char *prefix,
+        size_t size);
+
+/**
+ * @brief Invalidate cursor.
+ * @param [in] object instance to be invalidated.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+bool pufferfish_string_pool_cursor_invalidate(
+        struct pufferfish_string_pool_cursor *object);
+
+/**
+ * @brief Retrieve the next string that starts with the prefix.
+ * <p>Entries whose string has been released are skipped. The red-black tree
+ * is walked directly, a hash table string pool keeps its entries sorted in
+ * an index that is built on first use and then kept up to date as entries
+ * are added or removed.</p>
+ * @param [in] object cursor instance.
+ * @param [out] out strong reference of next string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE if there are no more
+ * strings with the prefix.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on the string pool has been
+ * reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to build the index.
+ * @note <b>out</b> must be released once done with it.
+ */
+bool pufferfish_string_pool_cursor_next(
+        struct pufferfish_string_pool_cursor *object,
+        struct triggerfish_strong **out);
+
 #endif  /* _PUFFERFISH_STRING_POOL_H_ */
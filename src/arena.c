@@ -0,0 +1,212 @@
+#include <stdlib.h>
+#include <stdalign.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "arena.h"
+
+struct pufferfish_arena_chunk {
+    struct pufferfish_arena_chunk *next;
+    alignas(PUFFERFISH_ARENA_GRANULARITY) char data[];
+};
+
+/* layout of a deferred block */
+struct pufferfish_arena_deferred {
+    struct pufferfish_arena_deferred *next;
+    size_t size;
+};
+
+struct pufferfish_arena_large {
+    struct pufferfish_arena_large *next;
+    struct pufferfish_arena_large *prev;
+    alignas(PUFFERFISH_ARENA_GRANULARITY) char data[];
+};
+
+bool pufferfish_arena_of(struct pufferfish_arena **const out) {
+    assert(out);
+    struct pufferfish_arena *const object = calloc(1, sizeof(*object));
+    if (!object) {
+        pufferfish_error = PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    atomic_init(&object->references, 1);
+    *out = object;
+    return true;
+}
+
+void pufferfish_arena_retain(struct pufferfish_arena *const object) {
+    assert(object);
+    atomic_fetch_add_explicit(&object->references, 1, memory_order_relaxed);
+}
+
+void pufferfish_arena_release(struct pufferfish_arena *const object) {
+    assert(object);
+    if (1 != atomic_fetch_sub_explicit(&object->references, 1,
+                                       memory_order_acq_rel)) {
+        return;
+    }
+    while (object->chunks) {
+        struct pufferfish_arena_chunk *const chunk = object->chunks;
+        object->chunks = chunk->next;
+        free(chunk);
+    }
+    while (object->large) {
+        struct pufferfish_arena_large *const large = object->large;
+        object->large = large->next;
+        free(large);
+    }
+    free(object);
+}
+
+void pufferfish_arena_block_size(const size_t size, size_t *const out) {
+    assert(out);
+    *out = (size + PUFFERFISH_ARENA_GRANULARITY - 1)
+           & ~(size_t) (PUFFERFISH_ARENA_GRANULARITY - 1);
+}
+
+static bool large_allocate(struct pufferfish_arena *const object,
+                           const size_t block,
+                           void **const out) {
+    struct pufferfish_arena_large *const large = malloc(
+            sizeof(*large) + block);
+    if (!large) {
+        pufferfish_error = PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    large->prev = NULL;
+    large->next = object->large;
+    if (large->next) {
+        large->next->prev = large;
+    }
+    object->large = large;
+    object->reserved += sizeof(*large) + block;
+    *out = large->data;
+    return true;
+}
+
+static void large_free(struct pufferfish_arena *const object,
+                       void *const block,
+                       const size_t size) {
+    struct pufferfish_arena_large *const large = (void *)
+            ((char *) block - offsetof(struct pufferfish_arena_large, data));
+    if (large->prev) {
+        large->prev->next = large->next;
+    } else {
+        object->large = large->next;
+    }
+    if (large->next) {
+        large->next->prev = large->prev;
+    }
+    object->reserved -= sizeof(*large) + size;
+    free(large);
+}
+
+static bool chunk_allocate(struct pufferfish_arena *const object,
+                           const size_t block,
+                           void **const out) {
+    if (object->end - object->cursor < (ptrdiff_t) block) {
+        struct pufferfish_arena_chunk *const chunk = malloc(
+                PUFFERFISH_ARENA_CHUNK_SIZE);
+        if (!chunk) {
+            pufferfish_error = PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+        /* remainder of the previous chunk is left unused */
+        chunk->next = object->chunks;
+        object->chunks = chunk;
+        object->cursor = chunk->data;
+        object->end = (char *) chunk + PUFFERFISH_ARENA_CHUNK_SIZE;
+        object->reserved += PUFFERFISH_ARENA_CHUNK_SIZE;
+    }
+    *out = object->cursor;
+    object->cursor += block;
+    return true;
+}
+
+/**
+ * @brief Put deferred blocks back on their free lists.
+ * @param [in] object arena instance.
+ */
+static void deferred_drain(struct pufferfish_arena *const object) {
+    struct pufferfish_arena_deferred *deferred = atomic_exchange_explicit(
+            &object->deferred, NULL, memory_order_acquire);
+    while (deferred) {
+        struct pufferfish_arena_deferred *const next = deferred->next;
+        pufferfish_arena_free(object, deferred, deferred->size);
+        deferred = next;
+    }
+}
+
+bool pufferfish_arena_allocate(struct pufferfish_arena *const object,
+                               const size_t size,
+                               void **const out) {
+    assert(object);
+    assert(size);
+    assert(out);
+    if (atomic_load_explicit(&object->deferred, memory_order_relaxed)) {
+        deferred_drain(object);
+    }
+    if (size > SIZE_MAX - PUFFERFISH_ARENA_CHUNK_SIZE) {
+        pufferfish_error = PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    size_t block;
+    pufferfish_arena_block_size(size, &block);
+    if (block > PUFFERFISH_ARENA_BLOCK_LIMIT) {
+        if (!large_allocate(object, block, out)) {
+            return false;
+        }
+    } else {
+        const size_t index = block / PUFFERFISH_ARENA_GRANULARITY - 1;
+        void **const free_block = object->free[index];
+        if (free_block) {
+            object->free[index] = *free_block;
+            *out = free_block;
+        } else if (!chunk_allocate(object, block, out)) {
+            return false;
+        }
+    }
+    object->allocated += block;
+    object->blocks += 1;
+    return true;
+}
+
+void pufferfish_arena_free(struct pufferfish_arena *const object,
+                           void *const block,
+                           const size_t size) {
+    assert(object);
+    assert(block);
+    size_t length;
+    pufferfish_arena_block_size(size, &length);
+    seagrass_required_true(object->allocated >= length);
+    object->allocated -= length;
+    object->blocks -= 1;
+    if (length > PUFFERFISH_ARENA_BLOCK_LIMIT) {
+        large_free(object, block, length);
+        return;
+    }
+    const size_t index = length / PUFFERFISH_ARENA_GRANULARITY - 1;
+    *(void **) block = object->free[index];
+    object->free[index] = block;
+}
+
+void pufferfish_arena_defer(struct pufferfish_arena *const object,
+                            void *const block,
+                            const size_t size) {
+    assert(object);
+    assert(block);
+    static_assert(sizeof(struct pufferfish_arena_deferred)
+                  <= PUFFERFISH_ARENA_GRANULARITY, "block too small");
+    struct pufferfish_arena_deferred *const deferred = block;
+    deferred->size = size;
+    deferred->next = atomic_load_explicit(&object->deferred,
+                                          memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+            &object->deferred, (void **) &deferred->next, deferred,
+            memory_order_release, memory_order_relaxed));
+}
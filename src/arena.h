@@ -0,0 +1,118 @@
+#ifndef _PUFFERFISH_ARENA_H_
+#define _PUFFERFISH_ARENA_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pufferfish/string_pool.h>
+
+#define PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED \
+    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+
+/* blocks are handed out in multiples of this size */
+#define PUFFERFISH_ARENA_GRANULARITY                                16
+/* blocks larger than this are allocated on their own */
+#define PUFFERFISH_ARENA_BLOCK_LIMIT                                512
+#define PUFFERFISH_ARENA_CLASSES \
+    (PUFFERFISH_ARENA_BLOCK_LIMIT / PUFFERFISH_ARENA_GRANULARITY)
+#define PUFFERFISH_ARENA_CHUNK_SIZE                                 (64 * 1024)
+
+struct pufferfish_arena_chunk;
+struct pufferfish_arena_large;
+
+/**
+ * <p>Slab allocator for pooled entries. Blocks are carved from large chunks
+ * and freed blocks are kept on a free list per size class. The arena is not
+ * thread-safe, the string pool's write lock serializes access to it, with
+ * the exception of pufferfish_arena_defer() and the reference count.</p>
+ */
+struct pufferfish_arena {
+    void *free[PUFFERFISH_ARENA_CLASSES];
+    struct pufferfish_arena_chunk *chunks;
+    struct pufferfish_arena_large *large;
+    char *cursor;
+    char *end;
+    /* bytes obtained from the system */
+    uintmax_t reserved;
+    /* bytes handed out in blocks */
+    uintmax_t allocated;
+    /* blocks handed out */
+    uintmax_t blocks;
+    /* blocks freed without holding the write lock */
+    void *_Atomic deferred;
+    /* string pool plus blocks outliving the string pool */
+    atomic_uintmax_t references;
+    /* entries counted dead but not yet removed from the string pool */
+    atomic_uintmax_t deaths;
+    /* entries of the string pool queued for removal as they die */
+    void *_Atomic dead;
+    /* queued entries still counted by the string pool */
+    atomic_uintmax_t queued;
+};
+
+/**
+ * @brief Create arena.
+ * @param [out] out receive arena.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create arena.
+ */
+bool pufferfish_arena_of(struct pufferfish_arena **out);
+
+/**
+ * @brief Add a reference to arena.
+ * @param [in] object arena instance.
+ */
+void pufferfish_arena_retain(struct pufferfish_arena *object);
+
+/**
+ * @brief Remove a reference from arena.
+ * <p>Once the last reference is removed all chunks and the arena itself
+ * are deallocated.</p>
+ * @param [in] object arena instance.
+ */
+void pufferfish_arena_release(struct pufferfish_arena *object);
+
+/**
+ * @brief Allocate block from arena.
+ * @param [in] object arena instance.
+ * @param [in] size of block in bytes.
+ * @param [out] out receive block.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_ARENA_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to allocate block.
+ */
+bool pufferfish_arena_allocate(struct pufferfish_arena *object,
+                               size_t size,
+                               void **out);
+
+/**
+ * @brief Return block to arena.
+ * @param [in] object arena instance.
+ * @param [in] block to be returned.
+ * @param [in] size of block in bytes as passed to pufferfish_arena_allocate().
+ */
+void pufferfish_arena_free(struct pufferfish_arena *object,
+                           void *block,
+                           size_t size);
+
+/**
+ * @brief Return block to arena without holding the write lock.
+ * <p>The block is put back on its free list by the next allocation.</p>
+ * @param [in] object arena instance.
+ * @param [in] block to be returned.
+ * @param [in] size of block in bytes as passed to pufferfish_arena_allocate().
+ */
+void pufferfish_arena_defer(struct pufferfish_arena *object,
+                            void *block,
+                            size_t size);
+
+/**
+ * @brief Size of the block handed out for an allocation request.
+ * @param [in] size of allocation request in bytes.
+ * @param [out] out receive block size in bytes.
+ */
+void pufferfish_arena_block_size(size_t size, size_t *out);
+
+#endif /* _PUFFERFISH_ARENA_H_ */
@@ -0,0 +1,53 @@
+#ifndef _PUFFERFISH_CHARS_H_
+#define _PUFFERFISH_CHARS_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* strings up to this size are compared with word loads */
+#define PUFFERFISH_CHARS_SHORT_SIZE                                 16
+
+/**
+ * @brief Compare the contents of two strings of the same size.
+ * <p>Short strings are compared with two possibly overlapping loads from
+ * either end, so that no byte beyond <b>size</b> is read and no loop or call
+ * is needed. Longer strings are left to memcmp().</p>
+ * @param [in] a contents of first string.
+ * @param [in] b contents of second string.
+ * @param [in] size of both in bytes.
+ * @return true if the contents are equal, otherwise false.
+ */
+static inline bool pufferfish_chars_equal(const char *const a,
+                                          const char *const b,
+                                          const size_t size) {
+    if (size > PUFFERFISH_CHARS_SHORT_SIZE) {
+        return !memcmp(a, b, size);
+    }
+    if (size >= sizeof(uint64_t)) {
+        uint64_t a0, a1, b0, b1;
+        memcpy(&a0, a, sizeof(a0));
+        memcpy(&b0, b, sizeof(b0));
+        memcpy(&a1, a + size - sizeof(a1), sizeof(a1));
+        memcpy(&b1, b + size - sizeof(b1), sizeof(b1));
+        return !((a0 ^ b0) | (a1 ^ b1));
+    }
+    if (size >= sizeof(uint32_t)) {
+        uint32_t a0, a1, b0, b1;
+        memcpy(&a0, a, sizeof(a0));
+        memcpy(&b0, b, sizeof(b0));
+        memcpy(&a1, a + size - sizeof(a1), sizeof(a1));
+        memcpy(&b1, b + size - sizeof(b1), sizeof(b1));
+        return !((a0 ^ b0) | (a1 ^ b1));
+    }
+    if (size) {
+        /* first, middle and last byte cover sizes up to three */
+        return !((a[0] ^ b[0])
+                 | (a[size / 2] ^ b[size / 2])
+                 | (a[size - 1] ^ b[size - 1]));
+    }
+    return true;
+}
+
+#endif /* _PUFFERFISH_CHARS_H_ */
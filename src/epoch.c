@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <seagrass.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "epoch.h"
+
+#define PUFFERFISH_EPOCH_CACHE_LINE                                 64
+
+/* records are reused by new threads but never deallocated */
+struct pufferfish_epoch_record {
+    /* epoch observed on entry or zero when outside critical section */
+    alignas(PUFFERFISH_EPOCH_CACHE_LINE) atomic_uintmax_t epoch;
+    atomic_bool in_use;
+    uintmax_t depth;
+    struct pufferfish_epoch_record *next;
+};
+
+static atomic_uintmax_t epoch = 1;
+static struct pufferfish_epoch_record *_Atomic records;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_key_t key;
+static _Thread_local struct pufferfish_epoch_record *record;
+
+static void on_thread_exit(void *a) {
+    struct pufferfish_epoch_record *const object = a;
+    atomic_store_explicit(&object->epoch, 0, memory_order_release);
+    object->depth = 0;
+    atomic_store_explicit(&object->in_use, false, memory_order_release);
+}
+
+static void on_once(void) {
+    seagrass_required_true(!pthread_key_create(&key, on_thread_exit));
+}
+
+/**
+ * @brief Register calling thread by reusing or creating a record.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_EPOCH_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create a record.
+ */
+static bool record_acquire(void) {
+    seagrass_required_true(!pthread_once(&once, on_once));
+    struct pufferfish_epoch_record *object = atomic_load_explicit(
+            &records, memory_order_acquire);
+    for (; object; object = object->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong_explicit(
+                &object->in_use, &expected, true,
+                memory_order_acq_rel, memory_order_relaxed)) {
+            break;
+        }
+    }
+    if (!object) {
+        void *memory;
+        if (posix_memalign(&memory, PUFFERFISH_EPOCH_CACHE_LINE,
+                           sizeof(*object))) {
+            pufferfish_error = PUFFERFISH_EPOCH_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+        object = memory;
+        atomic_init(&object->epoch, 0);
+        atomic_init(&object->in_use, true);
+        object->depth = 0;
+        object->next = atomic_load_explicit(&records, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(
+                &records, &object->next, object,
+                memory_order_release, memory_order_relaxed));
+    }
+    if (pthread_setspecific(key, object)) {
+        on_thread_exit(object);
+        pufferfish_error = PUFFERFISH_EPOCH_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    record = object;
+    return true;
+}
+
+bool pufferfish_epoch_enter(void) {
+    if (!record && !record_acquire()) {
+        return false;
+    }
+    if (!record->depth++) {
+        atomic_store_explicit(&record->epoch,
+                              atomic_load_explicit(&epoch,
+                                                   memory_order_relaxed),
+                              memory_order_relaxed);
+        /* publish our epoch before reading any shared state */
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+    return true;
+}
+
+void pufferfish_epoch_exit(void) {
+    assert(record);
+    assert(record->depth);
+    if (!--record->depth) {
+        atomic_store_explicit(&record->epoch, 0, memory_order_release);
+    }
+}
+
+void pufferfish_epoch_synchronize(void) {
+    assert(!record || !record->depth);
+    atomic_thread_fence(memory_order_seq_cst);
+    const uintmax_t target = 1 + atomic_fetch_add_explicit(
+            &epoch, 1, memory_order_seq_cst);
+    for (struct pufferfish_epoch_record *object = atomic_load_explicit(
+            &records, memory_order_acquire);
+         object;
+         object = object->next) {
+        uintmax_t observed;
+        while ((observed = atomic_load_explicit(&object->epoch,
+                                                memory_order_acquire))
+               && observed < target) {
+            sched_yield();
+        }
+    }
+    atomic_thread_fence(memory_order_seq_cst);
+}
@@ -0,0 +1,35 @@
+#ifndef _PUFFERFISH_EPOCH_H_
+#define _PUFFERFISH_EPOCH_H_
+
+#include <stdbool.h>
+#include <pufferfish/string_pool.h>
+
+#define PUFFERFISH_EPOCH_ERROR_MEMORY_ALLOCATION_FAILED \
+    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+
+/**
+ * @brief Enter an epoch protected read-side critical section.
+ * <p>Memory retired while the calling thread is inside the critical
+ * section is not reclaimed until it has left it. Critical sections may be
+ * nested and only ever write to memory owned by the calling thread.</p>
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_EPOCH_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register the calling thread.
+ */
+bool pufferfish_epoch_enter(void);
+
+/**
+ * @brief Leave the epoch protected read-side critical section.
+ */
+void pufferfish_epoch_exit(void);
+
+/**
+ * @brief Wait until every thread that was inside a read-side critical
+ * section has left it.
+ * <p>Memory that was unlinked before calling this may be reclaimed once it
+ * returns.</p>
+ * @note Must not be called from inside a read-side critical section.
+ */
+void pufferfish_epoch_synchronize(void);
+
+#endif /* _PUFFERFISH_EPOCH_H_ */
@@ -0,0 +1,16 @@
+#ifndef _PUFFERFISH_HASH_PRIVATE_H_
+#define _PUFFERFISH_HASH_PRIVATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Calculate hash of data without CRC instructions.
+ * <p>This is the fallback of pufferfish_hash() and gives the same values.</p>
+ * @param [in] data to be hashed.
+ * @param [in] size of data in bytes.
+ * @param [out] out receive the hash.
+ */
+void pufferfish_hash_portable(const void *data, size_t size, uintmax_t *out);
+
+#endif /* _PUFFERFISH_HASH_PRIVATE_H_ */
@@ -0,0 +1,490 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "chars.h"
+#include "string_pool_private.h"
+
+#define PUFFERFISH_SCOPED_STRING_POOL_TABLE_MINIMUM_LENGTH          16
+#define PUFFERFISH_SCOPED_STRING_POOL_CHUNK_MINIMUM_SIZE            4096
+#define PUFFERFISH_SCOPED_STRING_POOL_CHUNK_MAXIMUM_SIZE            (1 << 20)
+
+struct pufferfish_scoped_string_pool_chunk {
+    struct pufferfish_scoped_string_pool_chunk *next;
+    size_t size;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+/* hash is kept in the slot so that most mismatches skip the entry */
+struct pufferfish_scoped_string_pool_slot {
+    uintmax_t hash;
+    struct pufferfish_scoped_string_pool_entry *entry;
+};
+
+struct pufferfish_scoped_string_pool_entry {
+    struct sea_turtle_string string;
+    /* of the parent's string or NULL if the contents are in chars */
+    struct triggerfish_strong *strong;
+    struct pufferfish_scoped_string_pool_entry *next;
+    char chars[];
+};
+
+/**
+ * @brief Map string pool error of the parent to a scoped string pool error.
+ */
+static void error_map(void) {
+    switch (pufferfish_error) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED: {
+            pufferfish_error =
+                    PUFFERFISH_SCOPED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED;
+            break;
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED: {
+            pufferfish_error =
+                    PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Bump allocate from the newest chunk, adding a chunk if it is full.
+ * <p>Chunks double in size up to a maximum so that a scope needs few of
+ * them, larger requests get a chunk of their own.</p>
+ * @param [in] object scoped string pool instance.
+ * @param [in] size of allocation in bytes.
+ * @param [out] out receive allocation.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory for a new chunk.
+ */
+static bool chunk_allocate(struct pufferfish_scoped_string_pool *const object,
+                           size_t size,
+                           void **const out) {
+    assert(object);
+    assert(out);
+    const size_t align = alignof(struct pufferfish_scoped_string_pool_entry);
+    if (size > SIZE_MAX - align
+               - sizeof(struct pufferfish_scoped_string_pool_chunk)) {
+        pufferfish_error =
+                PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    size = (size + align - 1) & ~(align - 1);
+    struct pufferfish_scoped_string_pool_chunk *chunk = object->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t length = PUFFERFISH_SCOPED_STRING_POOL_CHUNK_MINIMUM_SIZE;
+        if (chunk && chunk->size < PUFFERFISH_SCOPED_STRING_POOL_CHUNK_MAXIMUM_SIZE) {
+            length = 2 * chunk->size;
+        } else if (chunk) {
+            length = chunk->size;
+        }
+        if (length < size) {
+            length = size;
+        }
+        chunk = malloc(sizeof(*chunk) + length);
+        if (!chunk) {
+            pufferfish_error =
+                    PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+        *chunk = (struct pufferfish_scoped_string_pool_chunk) {
+                .next = object->chunks,
+                .size = length
+        };
+        object->chunks = chunk;
+    }
+    *out = chunk->data + chunk->used;
+    chunk->used += size;
+    return true;
+}
+
+/**
+ * @brief Find entry of chars.
+ * @param [in] object scoped string pool instance.
+ * @param [in] chars contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars.
+ * @return entry or <i>NULL</i> if chars were not found.
+ */
+static struct pufferfish_scoped_string_pool_entry *table_find(
+        const struct pufferfish_scoped_string_pool *const object,
+        const char *const chars,
+        const size_t size,
+        const uintmax_t hash) {
+    assert(object);
+    assert(chars);
+    if (!object->slots) {
+        return NULL;
+    }
+    const uintmax_t mask = object->length - 1;
+    for (uintmax_t i = hash & mask;; i = (i + 1) & mask) {
+        const struct pufferfish_scoped_string_pool_slot *const slot
+                = &object->slots[i];
+        if (!slot->entry) {
+            return NULL;
+        }
+        if (hash == slot->hash
+            && size == slot->entry->string.size
+            && pufferfish_chars_equal(chars, slot->entry->string.data, size)) {
+            return slot->entry;
+        }
+    }
+}
+
+/**
+ * @brief Place entry in the first free slot for its hash.
+ * @param [in] slots of hash table.
+ * @param [in] length of slots.
+ * @param [in] hash of entry.
+ * @param [in] entry to be placed.
+ */
+static void table_place(struct pufferfish_scoped_string_pool_slot *const slots,
+                        const uintmax_t length,
+                        const uintmax_t hash,
+                        struct pufferfish_scoped_string_pool_entry *const entry) {
+    assert(slots);
+    assert(entry);
+    const uintmax_t mask = length - 1;
+    uintmax_t i = hash & mask;
+    while (slots[i].entry) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = (struct pufferfish_scoped_string_pool_slot) {
+            .hash = hash,
+            .entry = entry
+    };
+}
+
+/**
+ * @brief Make room for one more entry, keeping the table at most half full.
+ * @param [in] object scoped string pool instance.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to grow the hash table.
+ */
+static bool table_reserve(struct pufferfish_scoped_string_pool *const object) {
+    assert(object);
+    if (object->slots && 2 * (object->count + 1) <= object->length) {
+        return true;
+    }
+    const uintmax_t length = object->slots
+            ? 2 * object->length
+            : PUFFERFISH_SCOPED_STRING_POOL_TABLE_MINIMUM_LENGTH;
+    struct pufferfish_scoped_string_pool_slot *const slots
+            = calloc(length, sizeof(*slots));
+    if (!slots) {
+        pufferfish_error =
+                PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    for (uintmax_t i = 0; i < object->length; i++) {
+        if (object->slots[i].entry) {
+            table_place(slots, length, object->slots[i].hash,
+                        object->slots[i].entry);
+        }
+    }
+    free(object->slots);
+    object->slots = slots;
+    object->length = length;
+    return true;
+}
+
+/**
+ * @brief Add entry of a string borrowed from the parent.
+ * @param [in] object scoped string pool instance.
+ * @param [in] hash of string.
+ * @param [in] strong reference of string in parent, owned by the entry on
+ * success.
+ * @param [out] out receive entry.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to add entry.
+ */
+static bool entry_borrow(struct pufferfish_scoped_string_pool *const object,
+                         const uintmax_t hash,
+                         struct triggerfish_strong *const strong,
+                         struct pufferfish_scoped_string_pool_entry **const out) {
+    assert(object);
+    assert(strong);
+    assert(out);
+    struct pufferfish_scoped_string_pool_entry *entry;
+    if (!chunk_allocate(object, sizeof(*entry), (void **) &entry)) {
+        return false;
+    }
+    const struct sea_turtle_string *string;
+    seagrass_required_true(triggerfish_strong_instance(strong,
+                                                       (void **) &string));
+    *entry = (struct pufferfish_scoped_string_pool_entry) {
+            .string = *string,
+            .strong = strong,
+            .next = object->borrowed
+    };
+    object->borrowed = entry;
+    table_place(object->slots, object->length, hash, entry);
+    object->count++;
+    *out = entry;
+    return true;
+}
+
+/**
+ * @brief Add entry holding a copy of string.
+ * @param [in] object scoped string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string to be copied.
+ * @param [out] out receive entry.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to add entry.
+ */
+static bool entry_copy(struct pufferfish_scoped_string_pool *const object,
+                       const uintmax_t hash,
+                       const struct sea_turtle_string *const string,
+                       struct pufferfish_scoped_string_pool_entry **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    struct pufferfish_scoped_string_pool_entry *entry;
+    if (string->size >= SIZE_MAX - sizeof(*entry)
+        || !chunk_allocate(object, sizeof(*entry) + string->size + 1,
+                           (void **) &entry)) {
+        pufferfish_error =
+                PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    *entry = (struct pufferfish_scoped_string_pool_entry) {
+            .string = *string
+    };
+    entry->string.data = entry->chars;
+    memcpy(entry->chars, string->data, string->size);
+    entry->chars[string->size] = '\0';
+    table_place(object->slots, object->length, hash, entry);
+    object->count++;
+    *out = entry;
+    return true;
+}
+
+/**
+ * @brief Validate chars as a string.
+ * @param [in] chars contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [out] out receive string, it must be invalidated once done with it.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to validate chars.
+ * @throws PUFFERFISH_SCOPED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if chars
+ * do not form a valid string.
+ */
+static bool chars_validate(const char *const chars,
+                           const size_t size,
+                           struct sea_turtle_string *const out) {
+    assert(chars);
+    assert(out);
+    size_t count;
+    if (sea_turtle_string_init(out, chars, size, &count)) {
+        return true;
+    }
+    pufferfish_error =
+            SEA_TURTLE_STRING_ERROR_MEMORY_ALLOCATION_FAILED
+            == sea_turtle_error
+            ? PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+            : PUFFERFISH_SCOPED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED;
+    return false;
+}
+
+/**
+ * @brief Retrieve string from the scope, then the parent, else copy it.
+ * @param [in] object scoped string pool instance.
+ * @param [in] chars contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars.
+ * @param [in] string valid string of chars or <i>NULL</i> to validate chars
+ * when needed.
+ * @param [out] out receive string.
+ * @return On success true, otherwise false if an error has occurred.
+ */
+static bool get(struct pufferfish_scoped_string_pool *const object,
+                const char *const chars,
+                const size_t size,
+                const uintmax_t hash,
+                const struct sea_turtle_string *string,
+                const struct sea_turtle_string **const out) {
+    assert(object);
+    assert(chars);
+    assert(out);
+    struct pufferfish_scoped_string_pool_entry *entry
+            = table_find(object, chars, size, hash);
+    if (entry) {
+        *out = &entry->string;
+        return true;
+    }
+    if (!table_reserve(object)) {
+        return false;
+    }
+    struct sea_turtle_string validated;
+    bool result;
+    struct triggerfish_strong *strong;
+    /* a hash table parent finds strings by their contents alone */
+    const struct sea_turtle_string view = {
+            .data = (char *) chars,
+            .size = size
+    };
+    if (!string && !(object->parent->flags
+                     & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE)) {
+        if (!chars_validate(chars, size, &validated)) {
+            return false;
+        }
+        string = &validated;
+    }
+    if (pufferfish_string_pool_find_with_hash(object->parent,
+                                              string ? string : &view, hash,
+                                              &strong)) {
+        result = entry_borrow(object, hash, strong, &entry);
+        if (!result) {
+            seagrass_required_true(triggerfish_strong_release(strong));
+        }
+    } else if (PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND
+               != pufferfish_error) {
+        error_map();
+        result = false;
+    } else if (string) {
+        result = entry_copy(object, hash, string, &entry);
+    } else if ((result = chars_validate(chars, size, &validated))) {
+        string = &validated;
+        result = entry_copy(object, hash, string, &entry);
+    }
+    if (string == &validated) {
+        seagrass_required_true(sea_turtle_string_invalidate(&validated));
+    }
+    if (result) {
+        *out = &entry->string;
+    }
+    return result;
+}
+
+bool pufferfish_scoped_string_pool_init(
+        struct pufferfish_scoped_string_pool *const object,
+        struct pufferfish_string_pool *const parent) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!parent) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_PARENT_IS_NULL;
+        return false;
+    }
+    /* nothing is allocated until the first string is copied */
+    *object = (struct pufferfish_scoped_string_pool) {
+            .parent = parent
+    };
+    return true;
+}
+
+bool pufferfish_scoped_string_pool_invalidate(
+        struct pufferfish_scoped_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    for (struct pufferfish_scoped_string_pool_entry *entry = object->borrowed;
+         entry; entry = entry->next) {
+        seagrass_required_true(triggerfish_strong_release(entry->strong));
+    }
+    /* copied strings go with their chunks */
+    struct pufferfish_scoped_string_pool_chunk *chunk = object->chunks;
+    while (chunk) {
+        struct pufferfish_scoped_string_pool_chunk *const next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(object->slots);
+    *object = (struct pufferfish_scoped_string_pool) {0};
+    return true;
+}
+
+bool pufferfish_scoped_string_pool_get(
+        struct pufferfish_scoped_string_pool *const object,
+        const struct sea_turtle_string *const string,
+        const struct sea_turtle_string **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!string) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t hash;
+    pufferfish_hash(string->data, string->size, &hash);
+    return get(object, string->data, string->size, hash, string, out);
+}
+
+bool pufferfish_scoped_string_pool_get_chars(
+        struct pufferfish_scoped_string_pool *const object,
+        const char *const chars,
+        const size_t size,
+        const uintmax_t *const hash,
+        const struct sea_turtle_string **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!chars) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t value;
+    if (hash) {
+        value = *hash;
+    } else {
+        pufferfish_hash(chars, size, &value);
+    }
+    return get(object, chars, size, value, NULL, out);
+}
+
+bool pufferfish_scoped_string_pool_promote(
+        struct pufferfish_scoped_string_pool *const object,
+        const struct sea_turtle_string *const string,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!string) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t hash;
+    pufferfish_hash(string->data, string->size, &hash);
+    if (pufferfish_string_pool_get_with_hash(object->parent, string, hash,
+                                             out)) {
+        return true;
+    }
+    error_map();
+    return false;
+}
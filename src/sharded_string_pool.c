@@ -0,0 +1,329 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "string_pool_private.h"
+
+/**
+ * @brief Index of the shard responsible for hash.
+ * <p>The shard's hash table probes using the low bits of the hash so the
+ * shard is selected using the high bits.</p>
+ * @param [in] object sharded string pool instance.
+ * @param [in] hash of string.
+ * @return index of shard.
+ */
+static uintmax_t shard_index(
+        const struct pufferfish_sharded_string_pool *const object,
+        const uintmax_t hash) {
+    assert(object);
+    return (hash >> 32) % object->count;
+}
+
+/**
+ * @brief Shard responsible for hash.
+ * @param [in] object sharded string pool instance.
+ * @param [in] hash of string.
+ * @return string pool of shard.
+ */
+static struct pufferfish_string_pool *shard_of(
+        struct pufferfish_sharded_string_pool *const object,
+        const uintmax_t hash) {
+    assert(object);
+    return &object->shards[shard_index(object, hash)].pool;
+}
+
+/**
+ * @brief Map string pool error of a shard to a sharded string pool error.
+ */
+static void error_map(void) {
+    switch (pufferfish_error) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED: {
+            pufferfish_error =
+                    PUFFERFISH_SHARDED_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED;
+            break;
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED: {
+            pufferfish_error =
+                    PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            break;
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED: {
+            pufferfish_error =
+                    PUFFERFISH_SHARDED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED;
+            break;
+        }
+    }
+}
+
+bool pufferfish_sharded_string_pool_init(
+        struct pufferfish_sharded_string_pool *const object,
+        const uintmax_t count,
+        const uintmax_t flags) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!count) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_COUNT_IS_ZERO;
+        return false;
+    }
+    *object = (struct pufferfish_sharded_string_pool) {0};
+    void *shards;
+    if (count > SIZE_MAX / sizeof(*object->shards)
+        || posix_memalign(&shards, PUFFERFISH_SHARDED_STRING_POOL_CACHE_LINE,
+                          count * sizeof(*object->shards))) {
+        pufferfish_error =
+                PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    object->shards = shards;
+    for (uintmax_t i = 0; i < count; i++) {
+        if (pufferfish_string_pool_init_with_flags(&object->shards[i].pool,
+                                                   flags)) {
+            continue;
+        }
+        switch (pufferfish_error) {
+            default: {
+                seagrass_required_true(false);
+            }
+            case PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID: {
+                pufferfish_error =
+                        PUFFERFISH_SHARDED_STRING_POOL_ERROR_FLAGS_ARE_INVALID;
+                break;
+            }
+            case PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED: {
+                pufferfish_error =
+                        PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+                break;
+            }
+        }
+        while (i--) {
+            seagrass_required_true(pufferfish_string_pool_invalidate(
+                    &object->shards[i].pool));
+        }
+        free(object->shards);
+        object->shards = NULL;
+        return false;
+    }
+    object->count = count;
+    return true;
+}
+
+bool pufferfish_sharded_string_pool_invalidate(
+        struct pufferfish_sharded_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    for (uintmax_t i = 0; i < object->count; i++) {
+        seagrass_required_true(pufferfish_string_pool_invalidate(
+                &object->shards[i].pool));
+    }
+    free(object->shards);
+    *object = (struct pufferfish_sharded_string_pool) {0};
+    return true;
+}
+
+bool pufferfish_sharded_string_pool_get(
+        struct pufferfish_sharded_string_pool *const object,
+        const struct sea_turtle_string *const string,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!string) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t hash;
+    pufferfish_hash(string->data, string->size, &hash);
+    if (pufferfish_string_pool_get_with_hash(shard_of(object, hash), string,
+                                             hash, out)) {
+        return true;
+    }
+    error_map();
+    return false;
+}
+
+bool pufferfish_sharded_string_pool_get_chars(
+        struct pufferfish_sharded_string_pool *const object,
+        const char *const chars,
+        const size_t size,
+        const uintmax_t *const hash,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!chars) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t value;
+    if (hash) {
+        value = *hash;
+    } else {
+        pufferfish_hash(chars, size, &value);
+    }
+    if (pufferfish_string_pool_get_chars(shard_of(object, value), chars, size,
+                                         &value, out)) {
+        return true;
+    }
+    error_map();
+    return false;
+}
+
+bool pufferfish_sharded_string_pool_get_many(
+        struct pufferfish_sharded_string_pool *const object,
+        const struct sea_turtle_string *const *const strings,
+        const uintmax_t count,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!strings) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    for (uintmax_t i = 0; i < count; i++) {
+        if (!strings[i]) {
+            pufferfish_error =
+                    PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL;
+            return false;
+        }
+    }
+    if (!count) {
+        return true;
+    }
+    /* strings are grouped by shard so each shard is locked once */
+    const size_t item = sizeof(uintmax_t) * 3 + sizeof(*strings) + sizeof(*out);
+    uintmax_t *hashes;
+    if (count > (SIZE_MAX - sizeof(uintmax_t) * (object->count + 1)) / item
+        || !(hashes = malloc(count * item
+                             + sizeof(uintmax_t) * (object->count + 1)))) {
+        pufferfish_error =
+                PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    uintmax_t *const sorted_hashes = hashes + count;
+    uintmax_t *const indexes = sorted_hashes + count;
+    uintmax_t *const offsets = indexes + count;
+    const struct sea_turtle_string **const sorted_strings = (void *)
+            (offsets + object->count + 1);
+    struct triggerfish_strong **const sorted_out = (void *)
+            (sorted_strings + count);
+    memset(offsets, 0, sizeof(*offsets) * (object->count + 1));
+    for (uintmax_t i = 0; i < count; i++) {
+        pufferfish_hash(strings[i]->data, strings[i]->size, &hashes[i]);
+        offsets[shard_index(object, hashes[i]) + 1] += 1;
+    }
+    for (uintmax_t i = 0; i < object->count; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    for (uintmax_t i = 0; i < count; i++) {
+        const uintmax_t j = offsets[shard_index(object, hashes[i])]++;
+        sorted_hashes[j] = hashes[i];
+        sorted_strings[j] = strings[i];
+        indexes[j] = i;
+    }
+    /* offsets now hold the end of each shard's group */
+    bool result = true;
+    for (uintmax_t i = 0, begin = 0; i < object->count; i++) {
+        const uintmax_t end = offsets[i];
+        if (begin != end && !pufferfish_string_pool_get_many_with_hashes(
+                &object->shards[i].pool, sorted_strings + begin,
+                sorted_hashes + begin, end - begin, sorted_out + begin)) {
+            error_map();
+            for (uintmax_t j = 0; j < begin; j++) {
+                seagrass_required_true(triggerfish_strong_release(
+                        sorted_out[j]));
+            }
+            result = false;
+            break;
+        }
+        begin = end;
+    }
+    if (result) {
+        for (uintmax_t i = 0; i < count; i++) {
+            out[indexes[i]] = sorted_out[i];
+        }
+    }
+    free(hashes);
+    return result;
+}
+
+bool pufferfish_sharded_string_pool_shrink(
+        struct pufferfish_sharded_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    for (uintmax_t i = 0; i < object->count; i++) {
+        seagrass_required_true(pufferfish_string_pool_shrink(
+                &object->shards[i].pool));
+    }
+    return true;
+}
+
+bool pufferfish_sharded_string_pool_stats(
+        struct pufferfish_sharded_string_pool *const object,
+        struct pufferfish_string_pool_stats *const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    struct pufferfish_string_pool_stats sum = {0};
+    for (uintmax_t i = 0; i < object->count; i++) {
+        struct pufferfish_string_pool_stats shard;
+        if (!pufferfish_string_pool_stats(&object->shards[i].pool, &shard)) {
+            error_map();
+            return false;
+        }
+        sum.entries += shard.entries;
+        sum.live += shard.live;
+        sum.dead += shard.dead;
+        sum.bytes += shard.bytes;
+        sum.hits += shard.hits;
+        sum.misses += shard.misses;
+        sum.evictions += shard.evictions;
+        sum.upgrades += shard.upgrades;
+        sum.lock_waits += shard.lock_waits;
+        sum.lock_wait_ns += shard.lock_wait_ns;
+        for (uintmax_t j = 0; j < PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS;
+             j++) {
+            sum.lock_wait_histogram[j] += shard.lock_wait_histogram[j];
+        }
+    }
+    *out = sum;
+    return true;
+}
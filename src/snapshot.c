@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <seagrass.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "chars.h"
+#include "snapshot.h"
+
+/**
+ * @brief Check that the mapped file is a snapshot we can use.
+ * <p>Records are checked when they are looked up so that opening does not
+ * have to touch every page of the file.</p>
+ * @param [in] object snapshot instance with data and size set.
+ * @return true if the layout is consistent, otherwise false.
+ */
+static bool snapshot_valid(const struct pufferfish_string_pool_snapshot *const object) {
+    assert(object);
+    const struct pufferfish_snapshot_header *const header
+            = (const struct pufferfish_snapshot_header *) object->data;
+    if (object->size < sizeof(*header)
+        || memcmp(header->magic, PUFFERFISH_SNAPSHOT_MAGIC,
+                  sizeof(header->magic))
+        || PUFFERFISH_SNAPSHOT_VERSION != header->version
+        || PUFFERFISH_SNAPSHOT_BYTE_ORDER != header->byte_order
+        || PUFFERFISH_HASH_ID != header->hash
+        || object->size != header->size
+        || !header->length
+        || (header->length & (header->length - 1))
+        || header->count >= header->length) {
+        return false;
+    }
+    const uint64_t available = object->size - sizeof(*header);
+    if (header->length > available / sizeof(struct pufferfish_snapshot_slot)) {
+        return false;
+    }
+    const uint64_t remaining = available
+                               - header->length
+                                 * sizeof(struct pufferfish_snapshot_slot);
+    return header->count
+           <= remaining / sizeof(struct pufferfish_snapshot_record);
+}
+
+bool pufferfish_string_pool_snapshot_open(
+        const char *const path,
+        struct pufferfish_string_pool_snapshot **const out) {
+    if (!path) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    struct pufferfish_string_pool_snapshot *const object
+            = malloc(sizeof(*object));
+    if (!object) {
+        pufferfish_error = PUFFERFISH_SNAPSHOT_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (-1 == fd || fstat(fd, &status) || status.st_size <= 0) {
+        if (-1 != fd) {
+            close(fd);
+        }
+        free(object);
+        pufferfish_error = PUFFERFISH_SNAPSHOT_ERROR_IO_FAILED;
+        return false;
+    }
+    /* pages are shared through the page cache by every process mapping it */
+    void *const data = mmap(NULL, (size_t) status.st_size, PROT_READ,
+                            MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data) {
+        free(object);
+        pufferfish_error = PUFFERFISH_SNAPSHOT_ERROR_IO_FAILED;
+        return false;
+    }
+    *object = (struct pufferfish_string_pool_snapshot) {
+            .data = data,
+            .size = (size_t) status.st_size
+    };
+    if (!snapshot_valid(object)) {
+        seagrass_required_true(!munmap(data, object->size));
+        free(object);
+        pufferfish_error = PUFFERFISH_SNAPSHOT_ERROR_SNAPSHOT_IS_MALFORMED;
+        return false;
+    }
+    object->header = data;
+    object->slots = (const struct pufferfish_snapshot_slot *)
+            (object->data + sizeof(*object->header));
+    object->records = (const struct pufferfish_snapshot_record *)
+            (object->slots + object->header->length);
+    atomic_init(&object->references, 1);
+    *out = object;
+    return true;
+}
+
+bool pufferfish_string_pool_snapshot_close(
+        struct pufferfish_string_pool_snapshot *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    pufferfish_snapshot_release(object);
+    return true;
+}
+
+void pufferfish_snapshot_retain(
+        struct pufferfish_string_pool_snapshot *const object) {
+    assert(object);
+    atomic_fetch_add_explicit(&object->references, 1, memory_order_relaxed);
+}
+
+void pufferfish_snapshot_release(
+        struct pufferfish_string_pool_snapshot *const object) {
+    assert(object);
+    if (1 != atomic_fetch_sub_explicit(&object->references, 1,
+                                       memory_order_acq_rel)) {
+        return;
+    }
+    seagrass_required_true(!munmap((void *) object->data, object->size));
+    free(object);
+}
+
+const char *pufferfish_snapshot_record(
+        const struct pufferfish_string_pool_snapshot *const object,
+        const uint64_t i,
+        size_t *const size) {
+    assert(object);
+    assert(size);
+    if (i >= object->header->count) {
+        return NULL;
+    }
+    const struct pufferfish_snapshot_record *const record
+            = &object->records[i];
+    /* contents and their NUL must lie within the file */
+    if (record->offset >= object->size
+        || record->size >= object->size - record->offset
+        || object->data[record->offset + record->size]) {
+        return NULL;
+    }
+    *size = (size_t) record->size;
+    return (const char *) object->data + record->offset;
+}
+
+const char *pufferfish_snapshot_find(
+        const struct pufferfish_string_pool_snapshot *const object,
+        const uintmax_t hash,
+        const char *const chars,
+        const size_t size) {
+    assert(object);
+    assert(chars || !size);
+    const uint64_t mask = object->header->length - 1;
+    uint64_t i = hash & mask;
+    for (uint64_t probes = 0; probes < object->header->length;
+         probes++, i = (i + 1) & mask) {
+        const struct pufferfish_snapshot_slot *const slot = &object->slots[i];
+        if (!slot->record) {
+            return NULL;
+        }
+        if (hash != slot->hash) {
+            continue;
+        }
+        size_t found_size;
+        const char *const found = pufferfish_snapshot_record(
+                object, slot->record - 1, &found_size);
+        if (found && size == found_size
+            && pufferfish_chars_equal(chars, found, size)) {
+            return found;
+        }
+    }
+    return NULL;
+}
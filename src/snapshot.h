@@ -0,0 +1,105 @@
+#ifndef _PUFFERFISH_SNAPSHOT_H_
+#define _PUFFERFISH_SNAPSHOT_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pufferfish/string_pool.h>
+
+#define PUFFERFISH_SNAPSHOT_ERROR_IO_FAILED \
+    PUFFERFISH_STRING_POOL_ERROR_IO_FAILED
+#define PUFFERFISH_SNAPSHOT_ERROR_SNAPSHOT_IS_MALFORMED \
+    PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_MALFORMED
+#define PUFFERFISH_SNAPSHOT_ERROR_MEMORY_ALLOCATION_FAILED \
+    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+
+#define PUFFERFISH_SNAPSHOT_MAGIC                                   "PUFFPOOL"
+#define PUFFERFISH_SNAPSHOT_VERSION                                 1
+/* written in native byte order, a mismatch means a foreign byte order */
+#define PUFFERFISH_SNAPSHOT_BYTE_ORDER                              0x01020304
+
+/*
+ * Layout of a snapshot file, all integers are in native byte order:
+ *   header
+ *   slots[length]    open addressing index over records by hash
+ *   records[count]
+ *   chars            contents of strings, each followed by a NUL
+ */
+struct pufferfish_snapshot_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    /* PUFFERFISH_HASH_ID of the hash the index was built with */
+    uint32_t hash;
+    uint32_t reserved;
+    uint64_t count;
+    /* number of slots, a power of two larger than count */
+    uint64_t length;
+    /* size of the file in bytes */
+    uint64_t size;
+};
+
+struct pufferfish_snapshot_slot {
+    uint64_t hash;
+    /* one past the index of the record, 0 if the slot is empty */
+    uint64_t record;
+};
+
+struct pufferfish_snapshot_record {
+    /* from the start of the file */
+    uint64_t offset;
+    uint64_t size;
+};
+
+/* a mapped snapshot file, shared by string pools and their entries */
+struct pufferfish_string_pool_snapshot {
+    const unsigned char *data;
+    size_t size;
+    const struct pufferfish_snapshot_header *header;
+    const struct pufferfish_snapshot_slot *slots;
+    const struct pufferfish_snapshot_record *records;
+    /* owner plus string pools plus entries referring to its chars */
+    atomic_uintmax_t references;
+};
+
+/**
+ * @brief Add a reference to snapshot.
+ * @param [in] object snapshot instance.
+ */
+void pufferfish_snapshot_retain(struct pufferfish_string_pool_snapshot *object);
+
+/**
+ * @brief Remove a reference from snapshot, unmapping it with the last one.
+ * @param [in] object snapshot instance.
+ */
+void pufferfish_snapshot_release(struct pufferfish_string_pool_snapshot *object);
+
+/**
+ * @brief Find contents of string in snapshot.
+ * @param [in] object snapshot instance.
+ * @param [in] hash of chars as calculated by pufferfish_hash().
+ * @param [in] chars contents of string.
+ * @param [in] size of chars in bytes.
+ * @return contents of string inside the snapshot or <i>NULL</i> if it is
+ * not in the snapshot.
+ */
+const char *pufferfish_snapshot_find(
+        const struct pufferfish_string_pool_snapshot *object,
+        uintmax_t hash,
+        const char *chars,
+        size_t size);
+
+/**
+ * @brief Contents of a record.
+ * @param [in] object snapshot instance.
+ * @param [in] i index of record.
+ * @param [out] size receive size of contents in bytes.
+ * @return contents of record or <i>NULL</i> if the record is out of bounds.
+ */
+const char *pufferfish_snapshot_record(
+        const struct pufferfish_string_pool_snapshot *object,
+        uint64_t i,
+        size_t *size);
+
+#endif /* _PUFFERFISH_SNAPSHOT_H_ */
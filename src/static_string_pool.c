@@ -0,0 +1,640 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "chars.h"
+#include "string_pool_private.h"
+
+/* average number of strings per bucket */
+#define PUFFERFISH_STATIC_STRING_POOL_BUCKET_LOAD                   4
+
+/* string held by the static string pool */
+struct pufferfish_static_string_pool_entry {
+    /* instance of strong, must come first */
+    struct pufferfish_string_pool_entry_header header;
+    struct pufferfish_static_string_pool_entries *entries;
+    struct triggerfish_strong *strong;
+};
+
+/*
+ * Entries outlive the static string pool for as long as any of their strong
+ * references is alive. Tables built at run time are stored after them.
+ */
+struct pufferfish_static_string_pool_entries {
+    /* one per strong reference that has not been destroyed */
+    atomic_uintmax_t references;
+    struct pufferfish_static_string_pool_entry items[];
+};
+
+/**
+ * @brief Map string pool error of the fallback to a static string pool error.
+ */
+static void error_map(void) {
+    switch (pufferfish_error) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED: {
+            pufferfish_error =
+                    PUFFERFISH_STATIC_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED;
+            break;
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED: {
+            pufferfish_error =
+                    PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            break;
+        }
+        case PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED: {
+            pufferfish_error =
+                    PUFFERFISH_STATIC_STRING_POOL_ERROR_CHARS_ARE_MALFORMED;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Bucket of hash.
+ * <p>The slot is derived from a mix of the whole hash so the bucket is
+ * selected using the high bits.</p>
+ * @param [in] hash of string.
+ * @param [in] buckets number of buckets.
+ * @return index of bucket.
+ */
+static uintmax_t bucket_of(const uintmax_t hash, const uintmax_t buckets) {
+    return (hash >> 32) % buckets;
+}
+
+/**
+ * @brief Slot of hash displaced by seed.
+ * @param [in] hash of string.
+ * @param [in] seed of the string's bucket.
+ * @param [in] count number of slots.
+ * @return index of slot.
+ */
+static uintmax_t slot_of(const uintmax_t hash,
+                         const uint32_t seed,
+                         const uintmax_t count) {
+    uint64_t x = (uint64_t) hash ^ (seed * UINT64_C(0x9e3779b97f4a7c15));
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= UINT64_C(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+    return x % count;
+}
+
+/**
+ * @brief Find the slot holding chars.
+ * @param [in] table to search.
+ * @param [in] chars contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars.
+ * @param [out] out receive slot.
+ * @return true if chars are held, otherwise false.
+ */
+static bool table_find(const struct pufferfish_static_string_pool_table *const table,
+                       const char *const chars,
+                       const size_t size,
+                       const uintmax_t hash,
+                       uintmax_t *const out) {
+    assert(table);
+    assert(chars);
+    assert(out);
+    const uintmax_t i = slot_of(
+            hash, table->seeds[bucket_of(hash, table->buckets)],
+            table->count);
+    const struct pufferfish_static_string_pool_string *const string
+            = &table->strings[i];
+    if (hash != string->hash
+        || size != string->size
+        || !pufferfish_chars_equal(chars, string->data, size)) {
+        return false;
+    }
+    *out = i;
+    return true;
+}
+
+/**
+ * @brief Check that every string of table lies on its own slot.
+ * @param [in] table to check.
+ * @return true if table is consistent, otherwise false.
+ */
+static bool table_valid(const struct pufferfish_static_string_pool_table *const table) {
+    assert(table);
+    if (PUFFERFISH_HASH_ID != table->hash_id
+        || !table->count
+        || !table->buckets
+        || !table->seeds
+        || !table->strings) {
+        return false;
+    }
+    for (uintmax_t i = 0; i < table->count; i++) {
+        const struct pufferfish_static_string_pool_string *const string
+                = &table->strings[i];
+        if (!string->data
+            || string->data[string->size]
+            || i != slot_of(string->hash,
+                            table->seeds[bucket_of(string->hash,
+                                                   table->buckets)],
+                            table->count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Find a seed that displaces every string of a bucket onto a free
+ * slot.
+ * @param [in] hashes of strings.
+ * @param [in] members indexes of the bucket's strings.
+ * @param [in] size number of members.
+ * @param [in] count number of slots.
+ * @param [in,out] taken marks slots that are in use.
+ * @param [out] slots receive slot of each string.
+ * @param [out] out receive seed.
+ * @return true if a seed was found, otherwise false.
+ */
+static bool bucket_place(const uintmax_t *const hashes,
+                         const uintmax_t *const members,
+                         const uintmax_t size,
+                         const uintmax_t count,
+                         unsigned char *const taken,
+                         uintmax_t *const slots,
+                         uint32_t *const out) {
+    assert(hashes);
+    assert(members);
+    assert(taken);
+    assert(slots);
+    assert(out);
+    uint32_t seed = 0;
+    do {
+        uintmax_t placed = 0;
+        for (; placed < size; placed++) {
+            const uintmax_t i = members[placed];
+            const uintmax_t slot = slot_of(hashes[i], seed, count);
+            if (taken[slot]) {
+                break;
+            }
+            taken[slot] = 1;
+            slots[i] = slot;
+        }
+        if (placed == size) {
+            *out = seed;
+            return true;
+        }
+        while (placed--) {
+            taken[slots[members[placed]]] = 0;
+        }
+    } while (++seed);
+    return false;
+}
+
+/**
+ * @brief Build the minimal perfect hash of strings.
+ * <p>Strings are grouped into buckets which are placed largest first, each
+ * trying seeds until all of its strings land on free slots.</p>
+ * @param [in] strings to be placed.
+ * @param [in] count of strings.
+ * @param [in] buckets number of buckets.
+ * @param [out] hashes receive hash of each string.
+ * @param [out] slots receive slot of each string.
+ * @param [out] seeds receive seed of each bucket.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to build the table.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRINGS_ARE_NOT_DISTINCT if
+ * two strings cannot be told apart by their hash.
+ */
+static bool table_build(const struct sea_turtle_string *const *const strings,
+                        const uintmax_t count,
+                        const uintmax_t buckets,
+                        uintmax_t *const hashes,
+                        uintmax_t *const slots,
+                        uint32_t *const seeds) {
+    assert(strings);
+    assert(hashes);
+    assert(slots);
+    assert(seeds);
+    uintmax_t *const members = malloc(count * sizeof(*members));
+    uintmax_t *const starts = calloc(buckets + 1, sizeof(*starts));
+    uintmax_t *const order = malloc(buckets * sizeof(*order));
+    unsigned char *const taken = calloc(count, sizeof(*taken));
+    bool result = members && starts && order && taken;
+    if (!result) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        goto done;
+    }
+    /* empty buckets keep seed 0 */
+    memset(seeds, 0, buckets * sizeof(*seeds));
+    /* group strings by bucket */
+    for (uintmax_t i = 0; i < count; i++) {
+        pufferfish_hash(strings[i]->data, strings[i]->size, &hashes[i]);
+        starts[bucket_of(hashes[i], buckets) + 1]++;
+    }
+    uintmax_t largest = 0;
+    for (uintmax_t b = 0; b < buckets; b++) {
+        if (starts[b + 1] > largest) {
+            largest = starts[b + 1];
+        }
+        starts[b + 1] += starts[b];
+    }
+    for (uintmax_t i = 0; i < count; i++) {
+        members[starts[bucket_of(hashes[i], buckets)]++] = i;
+    }
+    /* each start has moved to the next bucket's start */
+    for (uintmax_t b = buckets; b; b--) {
+        starts[b] = starts[b - 1];
+    }
+    starts[0] = 0;
+    /* order buckets by decreasing size */
+    uintmax_t placed = 0;
+    for (uintmax_t size = largest; size; size--) {
+        for (uintmax_t b = 0; b < buckets; b++) {
+            if (size == starts[b + 1] - starts[b]) {
+                order[placed++] = b;
+            }
+        }
+    }
+    for (uintmax_t o = 0; result && o < placed; o++) {
+        const uintmax_t b = order[o];
+        const uintmax_t *const bucket = &members[starts[b]];
+        const uintmax_t size = starts[b + 1] - starts[b];
+        /* strings sharing a hash share every slot they could be placed on */
+        for (uintmax_t i = 0; result && i < size; i++) {
+            for (uintmax_t j = i + 1; result && j < size; j++) {
+                result = hashes[bucket[i]] != hashes[bucket[j]];
+            }
+        }
+        result = result && bucket_place(hashes, bucket, size, count, taken,
+                                        slots, &seeds[b]);
+        if (!result) {
+            pufferfish_error =
+                    PUFFERFISH_STATIC_STRING_POOL_ERROR_STRINGS_ARE_NOT_DISTINCT;
+        }
+    }
+    done:
+    free(members);
+    free(starts);
+    free(order);
+    free(taken);
+    return result;
+}
+
+static void on_entry_destroy(void *a) {
+    struct pufferfish_static_string_pool_entry *const entry = a;
+    struct pufferfish_static_string_pool_entries *const entries
+            = entry->entries;
+    if (1 == atomic_fetch_sub_explicit(&entries->references, 1,
+                                       memory_order_acq_rel)) {
+        free(entries);
+    }
+}
+
+/**
+ * @brief Create the strong references of the strings of table.
+ * <p>On failure entries are freed.</p>
+ * @param [in] entries allocated for table.
+ * @param [in] table whose strings the entries refer to.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if
+ * there is insufficient memory to create the strong references.
+ */
+static bool entries_init(
+        struct pufferfish_static_string_pool_entries *const entries,
+        const struct pufferfish_static_string_pool_table *const table) {
+    assert(entries);
+    assert(table);
+    atomic_init(&entries->references, table->count);
+    for (uintmax_t i = 0; i < table->count; i++) {
+        const struct pufferfish_static_string_pool_string *const string
+                = &table->strings[i];
+        struct pufferfish_static_string_pool_entry *const entry
+                = &entries->items[i];
+        *entry = (struct pufferfish_static_string_pool_entry) {
+                .header = {
+                        .string = {
+                                .size = string->size,
+                                .count = string->count,
+                                .data = (char *) string->data
+                        },
+                        .hash = string->hash
+                },
+                .entries = entries
+        };
+        if (triggerfish_strong_of(&entry->header.string, on_entry_destroy,
+                                  &entry->strong)) {
+            continue;
+        }
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED
+                               == triggerfish_error);
+        if (!i) {
+            free(entries);
+        } else {
+            /* the last strong reference to be released frees entries */
+            atomic_fetch_sub_explicit(&entries->references, table->count - i,
+                                      memory_order_relaxed);
+            while (i--) {
+                seagrass_required_true(triggerfish_strong_release(
+                        entries->items[i].strong));
+            }
+        }
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    return true;
+}
+
+bool pufferfish_static_string_pool_init(
+        struct pufferfish_static_string_pool *const object,
+        const struct sea_turtle_string *const *const strings,
+        const uintmax_t count,
+        struct pufferfish_string_pool *const fallback) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!strings) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!count) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_COUNT_IS_ZERO;
+        return false;
+    }
+    size_t chars = 0;
+    for (uintmax_t i = 0; i < count; i++) {
+        if (!strings[i]) {
+            pufferfish_error =
+                    PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL;
+            return false;
+        }
+        if (strings[i]->size >= SIZE_MAX - chars) {
+            pufferfish_error =
+                    PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+        chars += strings[i]->size + 1;
+    }
+    const uintmax_t buckets = 1 + (count - 1)
+                                  / PUFFERFISH_STATIC_STRING_POOL_BUCKET_LOAD;
+    /* entries, seeds, strings and their contents share one allocation */
+    const size_t item = sizeof(struct pufferfish_static_string_pool_entry)
+                        + sizeof(struct pufferfish_static_string_pool_string)
+                        + sizeof(uint32_t);
+    const size_t fixed = sizeof(struct pufferfish_static_string_pool_entries)
+                         + alignof(struct pufferfish_static_string_pool_string)
+                         + chars;
+    if (count > (SIZE_MAX - fixed) / item) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    struct pufferfish_static_string_pool_entries *const entries
+            = malloc(fixed + count * item);
+    uintmax_t *const hashes = malloc(count * sizeof(*hashes));
+    uintmax_t *const slots = malloc(count * sizeof(*slots));
+    if (!entries || !hashes || !slots) {
+        free(entries);
+        free(hashes);
+        free(slots);
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    uint32_t *const seeds = (uint32_t *) &entries->items[count];
+    const uintptr_t end = (uintptr_t) &seeds[buckets];
+    const size_t align = alignof(struct pufferfish_static_string_pool_string);
+    struct pufferfish_static_string_pool_string *const table_strings
+            = (void *) ((end + align - 1) & ~(uintptr_t) (align - 1));
+    char *data = (char *) &table_strings[count];
+    if (!table_build(strings, count, buckets, hashes, slots, seeds)) {
+        free(entries);
+        free(hashes);
+        free(slots);
+        return false;
+    }
+    for (uintmax_t i = 0; i < count; i++) {
+        memcpy(data, strings[i]->data, strings[i]->size);
+        data[strings[i]->size] = '\0';
+        table_strings[slots[i]] = (struct pufferfish_static_string_pool_string) {
+                .data = data,
+                .size = strings[i]->size,
+                .count = strings[i]->count,
+                .hash = hashes[i]
+        };
+        data += strings[i]->size + 1;
+    }
+    free(hashes);
+    free(slots);
+    const struct pufferfish_static_string_pool_table table = {
+            .hash_id = PUFFERFISH_HASH_ID,
+            .count = count,
+            .buckets = buckets,
+            .seeds = seeds,
+            .strings = table_strings
+    };
+    if (!entries_init(entries, &table)) {
+        return false;
+    }
+    *object = (struct pufferfish_static_string_pool) {
+            .table = table,
+            .fallback = fallback,
+            .entries = entries
+    };
+    return true;
+}
+
+bool pufferfish_static_string_pool_init_with_table(
+        struct pufferfish_static_string_pool *const object,
+        const struct pufferfish_static_string_pool_table *const table,
+        struct pufferfish_string_pool *const fallback) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!table) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_NULL;
+        return false;
+    }
+    if (!table_valid(table)) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_MALFORMED;
+        return false;
+    }
+    const size_t item = sizeof(struct pufferfish_static_string_pool_entry);
+    if (table->count > (SIZE_MAX - sizeof(
+            struct pufferfish_static_string_pool_entries)) / item) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    struct pufferfish_static_string_pool_entries *const entries = malloc(
+            sizeof(*entries) + table->count * item);
+    if (!entries) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    if (!entries_init(entries, table)) {
+        return false;
+    }
+    *object = (struct pufferfish_static_string_pool) {
+            .table = *table,
+            .fallback = fallback,
+            .entries = entries
+    };
+    return true;
+}
+
+bool pufferfish_static_string_pool_invalidate(
+        struct pufferfish_static_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    /* entries are freed once strings retrieved from them are released */
+    for (uintmax_t i = 0; i < object->table.count; i++) {
+        seagrass_required_true(triggerfish_strong_release(
+                object->entries->items[i].strong));
+    }
+    *object = (struct pufferfish_static_string_pool) {0};
+    return true;
+}
+
+/**
+ * @brief Retrieve the strong reference of held chars or from the fallback.
+ * @param [in] object static string pool instance.
+ * @param [in] string to hand to the fallback or <i>NULL</i> to hand it chars.
+ * @param [in] chars contents of string.
+ * @param [in] size of chars in bytes.
+ * @param [in] hash of chars.
+ * @param [out] out receive strong reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND if chars are
+ * not held and there is no fallback string pool.
+ */
+static bool get(struct pufferfish_static_string_pool *const object,
+                const struct sea_turtle_string *const string,
+                const char *const chars,
+                const size_t size,
+                const uintmax_t hash,
+                struct triggerfish_strong **const out) {
+    assert(object);
+    assert(chars);
+    assert(out);
+    uintmax_t i;
+    if (table_find(&object->table, chars, size, hash, &i)) {
+        struct triggerfish_strong *const strong
+                = object->entries->items[i].strong;
+        seagrass_required_true(triggerfish_strong_retain(strong));
+        *out = strong;
+        return true;
+    }
+    if (!object->fallback) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND;
+        return false;
+    }
+    if (string
+        ? pufferfish_string_pool_get_with_hash(object->fallback, string, hash,
+                                               out)
+        : pufferfish_string_pool_get_chars(object->fallback, chars, size,
+                                           &hash, out)) {
+        return true;
+    }
+    error_map();
+    return false;
+}
+
+bool pufferfish_static_string_pool_get(
+        struct pufferfish_static_string_pool *const object,
+        const struct sea_turtle_string *const string,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!string) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t hash;
+    pufferfish_hash(string->data, string->size, &hash);
+    return get(object, string, string->data, string->size, hash, out);
+}
+
+bool pufferfish_static_string_pool_get_chars(
+        struct pufferfish_static_string_pool *const object,
+        const char *const chars,
+        const size_t size,
+        const uintmax_t *const hash,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!chars) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t value;
+    if (hash) {
+        value = *hash;
+    } else {
+        pufferfish_hash(chars, size, &value);
+    }
+    return get(object, NULL, chars, size, value, out);
+}
+
+bool pufferfish_static_string_pool_find(
+        const struct pufferfish_static_string_pool *const object,
+        const char *const chars,
+        const size_t size,
+        const uintmax_t *const hash,
+        uintmax_t *const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!chars) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t value;
+    if (hash) {
+        value = *hash;
+    } else {
+        pufferfish_hash(chars, size, &value);
+    }
+    if (!table_find(&object->table, chars, size, value, out)) {
+        pufferfish_error =
+                PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "stats.h"
+
+#define PUFFERFISH_STATS_CACHE_LINE                                 64
+
+struct pufferfish_stats_stripe {
+    alignas(PUFFERFISH_STATS_CACHE_LINE)
+    atomic_uintmax_t counters[PUFFERFISH_STATS_COUNTERS];
+};
+
+struct pufferfish_stats {
+    struct pufferfish_stats_stripe stripes[PUFFERFISH_STATS_STRIPES];
+};
+
+static atomic_uint stripes;
+/* one past the stripe of the calling thread, 0 if not yet assigned */
+static _Thread_local unsigned int stripe;
+/* lock waits of the calling thread across all counters instances */
+static _Thread_local uintmax_t lock_waits;
+static _Thread_local uintmax_t lock_wait_ns;
+
+bool pufferfish_stats_of(struct pufferfish_stats **const out) {
+    assert(out);
+    void *memory;
+    if (posix_memalign(&memory, PUFFERFISH_STATS_CACHE_LINE,
+                       sizeof(struct pufferfish_stats))) {
+        pufferfish_error = PUFFERFISH_STATS_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    struct pufferfish_stats *const object = memory;
+    for (uintmax_t i = 0; i < PUFFERFISH_STATS_STRIPES; i++) {
+        for (uintmax_t j = 0; j < PUFFERFISH_STATS_COUNTERS; j++) {
+            atomic_init(&object->stripes[i].counters[j], 0);
+        }
+    }
+    *out = object;
+    return true;
+}
+
+void pufferfish_stats_destroy(struct pufferfish_stats *const object) {
+    assert(object);
+    free(object);
+}
+
+void pufferfish_stats_add(struct pufferfish_stats *const object,
+                          const enum pufferfish_stats_counter counter,
+                          const uintmax_t value) {
+    assert(object);
+    assert(counter < PUFFERFISH_STATS_COUNTERS);
+    if (!stripe) {
+        /* hand out stripes round-robin so threads rarely share one */
+        stripe = 1 + atomic_fetch_add_explicit(&stripes, 1,
+                                               memory_order_relaxed)
+                     % PUFFERFISH_STATS_STRIPES;
+    }
+    atomic_fetch_add_explicit(&object->stripes[stripe - 1].counters[counter],
+                              value, memory_order_relaxed);
+}
+
+void pufferfish_stats_lock_wait(struct pufferfish_stats *const object,
+                                const uintmax_t ns) {
+    assert(object);
+    uintmax_t bucket = 0;
+    while (bucket < PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS - 1
+           && ns >> (bucket + 1)) {
+        bucket += 1;
+    }
+    pufferfish_stats_add(object, PUFFERFISH_STATS_LOCK_WAITS, 1);
+    pufferfish_stats_add(object, PUFFERFISH_STATS_LOCK_WAIT_NS, ns);
+    pufferfish_stats_add(object, PUFFERFISH_STATS_LOCK_WAIT_HISTOGRAM + bucket,
+                         1);
+    lock_waits += 1;
+    lock_wait_ns += ns;
+}
+
+void pufferfish_stats_thread_lock_waits(uintmax_t *const waits,
+                                        uintmax_t *const ns) {
+    assert(waits);
+    assert(ns);
+    *waits = lock_waits;
+    *ns = lock_wait_ns;
+}
+
+void pufferfish_stats_sum(const struct pufferfish_stats *const object,
+                          uintmax_t out[const PUFFERFISH_STATS_COUNTERS]) {
+    assert(object);
+    assert(out);
+    for (uintmax_t j = 0; j < PUFFERFISH_STATS_COUNTERS; j++) {
+        out[j] = 0;
+    }
+    for (uintmax_t i = 0; i < PUFFERFISH_STATS_STRIPES; i++) {
+        for (uintmax_t j = 0; j < PUFFERFISH_STATS_COUNTERS; j++) {
+            out[j] += atomic_load_explicit(&object->stripes[i].counters[j],
+                                           memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef _PUFFERFISH_STATS_H_
+#define _PUFFERFISH_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pufferfish/string_pool.h>
+
+#define PUFFERFISH_STATS_ERROR_MEMORY_ALLOCATION_FAILED \
+    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+
+/* threads are spread over this many sets of counters */
+#define PUFFERFISH_STATS_STRIPES                                    16
+
+enum pufferfish_stats_counter {
+    PUFFERFISH_STATS_HITS,
+    PUFFERFISH_STATS_MISSES,
+    PUFFERFISH_STATS_EVICTIONS,
+    PUFFERFISH_STATS_UPGRADES,
+    PUFFERFISH_STATS_LOCK_WAITS,
+    PUFFERFISH_STATS_LOCK_WAIT_NS,
+    /* first of the power of two buckets of lock wait durations */
+    PUFFERFISH_STATS_LOCK_WAIT_HISTOGRAM,
+    PUFFERFISH_STATS_COUNTERS = PUFFERFISH_STATS_LOCK_WAIT_HISTOGRAM
+                                + PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS
+};
+
+struct pufferfish_stats;
+
+/**
+ * @brief Create counters all set to zero.
+ * @param [out] out receive counters.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STATS_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create counters.
+ */
+bool pufferfish_stats_of(struct pufferfish_stats **out);
+
+/**
+ * @brief Destroy counters.
+ * @param [in] object counters to be destroyed.
+ */
+void pufferfish_stats_destroy(struct pufferfish_stats *object);
+
+/**
+ * @brief Add to counter of the calling thread's stripe.
+ * <p>Safe to call concurrently, threads mostly update their own stripe so
+ * counting does not contend.</p>
+ * @param [in] object counters instance.
+ * @param [in] counter to add to.
+ * @param [in] value to be added.
+ */
+void pufferfish_stats_add(struct pufferfish_stats *object,
+                          enum pufferfish_stats_counter counter,
+                          uintmax_t value);
+
+/**
+ * @brief Count a lock acquisition that had to wait.
+ * <p>Adds to the lock wait count, the nanoseconds waited and the histogram
+ * bucket of the wait, as well as to the calling thread's own lock wait
+ * counters.</p>
+ * @param [in] object counters instance.
+ * @param [in] ns nanoseconds spent waiting for the lock.
+ */
+void pufferfish_stats_lock_wait(struct pufferfish_stats *object,
+                                uintmax_t ns);
+
+/**
+ * @brief Retrieve the lock waits counted for the calling thread.
+ * @param [out] waits receive number of lock acquisitions that had to wait.
+ * @param [out] ns receive nanoseconds spent waiting for them.
+ */
+void pufferfish_stats_thread_lock_waits(uintmax_t *waits, uintmax_t *ns);
+
+/**
+ * @brief Sum counters over all stripes.
+ * @param [in] object counters instance.
+ * @param [out] out receive sum of each counter.
+ */
+void pufferfish_stats_sum(const struct pufferfish_stats *object,
+                          uintmax_t out[PUFFERFISH_STATS_COUNTERS]);
+
+#endif /* _PUFFERFISH_STATS_H_ */
@@ -1,6 +1,13 @@
 #include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
 #include <assert.h>
 #include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <seagrass.h>
 #include <triggerfish.h>
 #include <seahorse.h>
@@ -11,19 +18,196 @@
 #include <test/cmocka.h>
 #endif
 
-#define PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND             (-1)
+#include "arena.h"
+#include "chars.h"
+#include "epoch.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "string_pool_private.h"
+#include "thread_cache.h"
+
+#define PUFFERFISH_STRING_POOL_FLAGS \
+    (PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE \
+     | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ \
+     | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS \
+     | PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK \
+     | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE \
+     | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM)
+
+/* flags that require the hash table */
+#define PUFFERFISH_STRING_POOL_HASH_TABLE_FLAGS \
+    (PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ \
+     | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS \
+     | PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK \
+     | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE)
+
+/* flags that require lock free read */
+#define PUFFERFISH_STRING_POOL_LOCK_FREE_READ_FLAGS \
+    PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE
+
+#define PUFFERFISH_STRING_POOL_TABLE_MINIMUM_LENGTH                 16
+#define PUFFERFISH_STRING_POOL_SYMBOLS_MINIMUM_LENGTH               64
+#define PUFFERFISH_STRING_POOL_SYMBOLS_MAXIMUM_LENGTH               UINT32_MAX
+
+/* marks a symbol slot holding the free list link instead of an entry */
+#define PUFFERFISH_STRING_POOL_SYMBOL_FREE                          1
+
+/* hashes are calculated this many strings ahead of the lookups in a batch */
+#define PUFFERFISH_STRING_POOL_PREFETCH_DISTANCE                    8
+
+/* retired entries are reclaimed in batches of at least this size */
+#define PUFFERFISH_STRING_POOL_RETIRED_LIMIT                        64
+
+/* number of slots an automatic shrink step examines */
+#define PUFFERFISH_STRING_POOL_AUTO_SHRINK_LIMIT                    1024
+
+/* dead entries the background reclaimer removes per write lock */
+#define PUFFERFISH_STRING_POOL_RECLAIMER_LIMIT                      256
+
+/* maximum number of entries in a block of the index */
+#define PUFFERFISH_STRING_POOL_INDEX_BLOCK_LENGTH                   256
+
+/* strings a thread of a bulk load is given at least */
+#define PUFFERFISH_STRING_POOL_LOAD_MINIMUM                         4096
+
+/* strong reference count of entry has reached zero */
+#define PUFFERFISH_STRING_POOL_ENTRY_DEAD                           (1 << 0)
+/* entry is no longer referenced by the string pool */
+#define PUFFERFISH_STRING_POOL_ENTRY_DETACHED                       (1 << 1)
+/* death of entry is counted by its arena */
+#define PUFFERFISH_STRING_POOL_ENTRY_COUNTED                        (1 << 2)
+/* entry is queued for removal once dead, only draining the queue removes it */
+#define PUFFERFISH_STRING_POOL_ENTRY_DEFERRED                       (1 << 3)
+/* string pool holds a strong reference of entry to keep it while unused */
+#define PUFFERFISH_STRING_POOL_ENTRY_CACHED                         (1 << 4)
+/* entry has been retrieved since the eviction clock last passed it */
+#define PUFFERFISH_STRING_POOL_ENTRY_REFERENCED                     (1 << 5)
+
+/* entry and the contents of its string share a single allocation */
+struct pufferfish_string_pool_entry {
+    struct sea_turtle_string string;
+    uintmax_t hash;
+    struct triggerfish_weak *weak;
+    /* arena the entry was carved from, NULL if allocated on its own */
+    struct pufferfish_arena *arena;
+    struct pufferfish_string_pool_entry *next;
+    atomic_uint state;
+    union {
+        uint32_t symbol;
+        /* position among the owned entries of a red-black tree */
+        uint32_t owned;
+    };
+    /* contents of string or, if they are in a snapshot, the snapshot */
+    char chars[];
+};
+
+/* entries are inspected through their header when their origin is unknown */
+static_assert(offsetof(struct pufferfish_string_pool_entry, string)
+              == offsetof(struct pufferfish_string_pool_entry_header, string)
+              && offsetof(struct pufferfish_string_pool_entry, hash)
+                 == offsetof(struct pufferfish_string_pool_entry_header, hash)
+              && offsetof(struct pufferfish_string_pool_entry, weak)
+                 == offsetof(struct pufferfish_string_pool_entry_header, weak)
+              && offsetof(struct pufferfish_string_pool_entry, arena)
+                 == offsetof(struct pufferfish_string_pool_entry_header,
+                             arena),
+              "entry does not start with the entry header");
+
+/* slots are read without the lock in lock free read mode */
+struct pufferfish_string_pool_slot {
+    atomic_uintmax_t hash;
+    struct pufferfish_string_pool_entry *_Atomic entry;
+};
+
+struct pufferfish_string_pool_table {
+    uintmax_t length;
+    uintmax_t used;
+    struct pufferfish_string_pool_table *next;
+    struct pufferfish_string_pool_slot slots[];
+};
+
+struct pufferfish_string_pool_index_block {
+    uintmax_t count;
+    struct pufferfish_string_pool_entry *entries[
+            PUFFERFISH_STRING_POOL_INDEX_BLOCK_LENGTH];
+};
+
+/*
+ * Hash table entries in string order, only used while holding the lock. They
+ * are kept in sorted blocks, none of them empty, so that adding or removing
+ * an entry only moves the entries of its block.
+ */
+struct pufferfish_string_pool_index {
+    uintmax_t count;
+    uintmax_t length;
+    uintmax_t capacity;
+    struct pufferfish_string_pool_index_block **blocks;
+};
+
+/* symbol slots are read without the lock in lock free read mode */
+struct pufferfish_string_pool_symbols {
+    uintmax_t length;
+    uintmax_t used;
+    struct pufferfish_string_pool_symbols *next;
+    atomic_uintptr_t entries[];
+};
+
+/* marks a slot whose entry has been removed from the hash table */
+static struct pufferfish_string_pool_entry tombstone;
+
+/* last serial handed out, 0 is never used so empty cache slots never match */
+static atomic_uintmax_t serials;
 
 bool pufferfish_string_pool_init(struct pufferfish_string_pool *const object) {
+    return pufferfish_string_pool_init_with_flags(
+            object, PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+}
+
+bool pufferfish_string_pool_init_with_flags(
+        struct pufferfish_string_pool *const object,
+        const uintmax_t flags) {
     if (!object) {
         pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
         return false;
     }
-    *object = (struct pufferfish_string_pool) {0};
+    if ((flags & ~PUFFERFISH_STRING_POOL_FLAGS)
+        || ((flags & PUFFERFISH_STRING_POOL_HASH_TABLE_FLAGS)
+            && !(flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE))
+        || ((flags & PUFFERFISH_STRING_POOL_LOCK_FREE_READ_FLAGS)
+            && !(flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ))) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID;
+        return false;
+    }
+    *object = (struct pufferfish_string_pool) {
+            .serial = 1 + atomic_fetch_add_explicit(&serials, 1,
+                                                    memory_order_relaxed),
+            .flags = flags
+    };
+    /* dead entries are queued on the arena */
+    if ((flags & (PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                  | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM))
+        && !pufferfish_arena_of(&object->arena)) {
+        return false;
+    }
+#ifndef PUFFERFISH_NO_STATS
+    if (!pufferfish_stats_of(&object->stats)) {
+        if (object->arena) {
+            pufferfish_arena_release(object->arena);
+        }
+        return false;
+    }
+#endif
     switch (pthread_rwlock_init(&object->lock, NULL)) {
         default: {
             seagrass_required_true(false);
         }
         case ENOMEM: {
+            if (object->arena) {
+                pufferfish_arena_release(object->arena);
+            }
+            if (object->stats) {
+                pufferfish_stats_destroy(object->stats);
+            }
             pufferfish_error =
                     PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
             return false;
@@ -37,244 +221,4156 @@ bool pufferfish_string_pool_init(struct pufferfish_string_pool *const object) {
     return true;
 }
 
-bool pufferfish_string_pool_invalidate(
-        struct pufferfish_string_pool *const object) {
+bool pufferfish_string_pool_init_with_snapshot(
+        struct pufferfish_string_pool *const object,
+        const uintmax_t flags,
+        struct pufferfish_string_pool_snapshot *const snapshot) {
     if (!object) {
         pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
         return false;
     }
-    seagrass_required_true(!pthread_rwlock_destroy(&object->lock));
-    seagrass_required_true(seahorse_red_black_tree_map_s_wr_invalidate(
-            &object->map));
-    *object = (struct pufferfish_string_pool) {0};
+    if (!snapshot) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_NULL;
+        return false;
+    }
+    if (!pufferfish_string_pool_init_with_flags(object, flags)) {
+        return false;
+    }
+    pufferfish_snapshot_retain(snapshot);
+    object->snapshot = snapshot;
     return true;
 }
 
 /**
- * @brief Get matching string strong reference.
- * @param [in] object map instance.
- * @param [in] key of reference to retrieve.
- * @param [out] out receive strong string reference.
+ * @brief Add to a counter of string pool.
+ * <p>Compiles to nothing if <i>PUFFERFISH_NO_STATS</i> is defined.</p>
+ * @param [in] object string pool instance.
+ * @param [in] counter to add to.
+ * @param [in] value to be added.
+ */
+static void stats_add(const struct pufferfish_string_pool *const object,
+                      const enum pufferfish_stats_counter counter,
+                      const uintmax_t value) {
+    assert(object);
+#ifndef PUFFERFISH_NO_STATS
+    pufferfish_stats_add(object->stats, counter, value);
+#endif
+}
+
+#ifndef PUFFERFISH_NO_STATS
+/**
+ * @brief Count a lock acquisition that had to wait.
+ * @param [in] object string pool instance.
+ * @param [in] begin time at which the wait for the lock began.
+ */
+static void lock_waited(const struct pufferfish_string_pool *const object,
+                        const struct timespec *const begin) {
+    assert(object);
+    assert(begin);
+    struct timespec end;
+    seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &end));
+    pufferfish_stats_lock_wait(
+            object->stats,
+            (uintmax_t) (end.tv_sec - begin->tv_sec) * 1000000000
+            + (uintmax_t) end.tv_nsec - (uintmax_t) begin->tv_nsec);
+}
+#endif
+
+/**
+ * @brief Take the read lock, counting the time spent waiting for it.
+ * @param [in] object string pool instance.
  * @return On success true, otherwise false if an error has occurred.
- * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string was not
- * found in string pool.
- * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
- * insufficient memory to retrieve the strong reference from string pool.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
  */
-static bool get(const struct seahorse_red_black_tree_map_s_wr *const object,
-                const struct sea_turtle_string *const key,
-                struct triggerfish_strong **const out) {
+static bool lock_read(struct pufferfish_string_pool *const object) {
     assert(object);
-    assert(key);
-    assert(out);
-    const struct triggerfish_weak *weak;
-    if (seahorse_red_black_tree_map_s_wr_get(object, key, &weak)) {
-        if (triggerfish_weak_strong(weak, out)) {
+#ifndef PUFFERFISH_NO_STATS
+    /* only a contended acquisition pays for reading the clock */
+    int error = pthread_rwlock_tryrdlock(&object->lock);
+    if (EBUSY == error) {
+        struct timespec begin;
+        seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &begin));
+        error = pthread_rwlock_rdlock(&object->lock);
+        if (!error) {
+            lock_waited(object, &begin);
+        }
+    }
+#else
+    const int error = pthread_rwlock_rdlock(&object->lock);
+#endif
+    switch (error) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case EAGAIN: {
+            pufferfish_error =
+                    PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED;
+            return false;
+        }
+        case 0: {
             return true;
         }
-        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
-                               == triggerfish_error);
-    } else if (SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
-               == seahorse_error) {
-        pufferfish_error =
-                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
-        return false;
+    }
+}
+
+/**
+ * @brief Take the write lock, counting the time spent waiting for it.
+ * @param [in] object string pool instance.
+ */
+static void lock_write(struct pufferfish_string_pool *const object) {
+    assert(object);
+#ifndef PUFFERFISH_NO_STATS
+    /* only a contended acquisition pays for reading the clock */
+    if (!pthread_rwlock_trywrlock(&object->lock)) {
+        return;
+    }
+    struct timespec begin;
+    seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &begin));
+    seagrass_required_true(!pthread_rwlock_wrlock(&object->lock));
+    lock_waited(object, &begin);
+#else
+    seagrass_required_true(!pthread_rwlock_wrlock(&object->lock));
+#endif
+}
+
+/**
+ * @brief Size of the allocation holding entry.
+ * @param [in] entry instance.
+ * @return size of entry in bytes.
+ */
+static size_t entry_size(const struct pufferfish_string_pool_entry *const entry) {
+    assert(entry);
+    if (entry->string.data != entry->chars) {
+        return offsetof(struct pufferfish_string_pool_entry, chars)
+               + sizeof(struct pufferfish_string_pool_snapshot *);
+    }
+    return offsetof(struct pufferfish_string_pool_entry, chars)
+           + entry->string.size + 1;
+}
+
+/**
+ * @brief Snapshot holding the contents of entry.
+ * @param [in] entry instance.
+ * @return snapshot or <i>NULL</i> if the contents are held by entry.
+ */
+static struct pufferfish_string_pool_snapshot *entry_snapshot(
+        const struct pufferfish_string_pool_entry *const entry) {
+    assert(entry);
+    struct pufferfish_string_pool_snapshot *snapshot = NULL;
+    if (entry->string.data != entry->chars) {
+        memcpy(&snapshot, entry->chars, sizeof(snapshot));
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Destroy entry while holding the write lock.
+ * @param [in] entry instance to be destroyed.
+ */
+static void entry_destroy(struct pufferfish_string_pool_entry *const entry) {
+    assert(entry);
+    if (entry->arena) {
+        pufferfish_arena_free(entry->arena, entry, entry_size(entry));
     } else {
-        seagrass_required_true(
-                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_KEY_NOT_FOUND
-                == seahorse_error);
+        free(entry);
+    }
+}
+
+/*
+ * Entries that are detached but still alive hold a reference to their arena
+ * as they are destroyed without the write lock and possibly after the string
+ * pool has been invalidated.
+ */
+static void on_entry_destroy(void *a) {
+    struct pufferfish_string_pool_entry *const entry = a;
+    /* the arena is alive for as long as the entry is */
+    const unsigned int flags = atomic_load_explicit(&entry->state,
+                                                    memory_order_relaxed);
+    if (flags & PUFFERFISH_STRING_POOL_ENTRY_COUNTED) {
+        atomic_fetch_add_explicit(&entry->arena->deaths, 1,
+                                  memory_order_relaxed);
+    }
+    /* counted before the entry is seen dead so that whoever removes it from
+     * the string pool finds it counted */
+    if (flags & PUFFERFISH_STRING_POOL_ENTRY_DEFERRED) {
+        atomic_fetch_add_explicit(&entry->arena->queued, 1,
+                                  memory_order_relaxed);
+    }
+    /* queued before the entry is seen dead, as from then on whoever detaches
+     * it destroys it and the arena may go away with the string pool */
+    if ((flags & PUFFERFISH_STRING_POOL_ENTRY_DEFERRED)
+        && !(flags & PUFFERFISH_STRING_POOL_ENTRY_DETACHED)) {
+        void *_Atomic *const dead = &entry->arena->dead;
+        entry->next = atomic_load_explicit(dead, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(
+                dead, (void **) &entry->next, entry,
+                memory_order_release, memory_order_relaxed));
+    }
+    const unsigned int state = atomic_fetch_or_explicit(
+            &entry->state, PUFFERFISH_STRING_POOL_ENTRY_DEAD,
+            memory_order_acq_rel);
+    if (!(state & PUFFERFISH_STRING_POOL_ENTRY_DETACHED)) {
+        /* the string pool owns the entry until it detaches it */
+        return;
+    }
+    struct pufferfish_string_pool_snapshot *const snapshot
+            = entry_snapshot(entry);
+    struct pufferfish_arena *const arena = entry->arena;
+    if (!arena) {
+        free(entry);
+    } else {
+        pufferfish_arena_defer(arena, entry, entry_size(entry));
+        pufferfish_arena_release(arena);
+    }
+    if (snapshot) {
+        pufferfish_snapshot_release(snapshot);
     }
-    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND;
-    return false;
 }
 
-static void on_destroy(void *a) {
-    seagrass_required_true(sea_turtle_string_invalidate(a));
+/**
+ * @brief Hand the ownership of entry to the string pool.
+ * @param [in] entry instance to be attached.
+ * @param [in] state of entry once attached.
+ */
+static void entry_attach(struct pufferfish_string_pool_entry *const entry,
+                         const unsigned int state) {
+    assert(entry);
+    atomic_store_explicit(&entry->state, state, memory_order_relaxed);
+    if (entry->arena) {
+        pufferfish_arena_release(entry->arena);
+    }
 }
 
 /**
- * @brief Add string to string pool.
+ * @brief State of entries once attached to string pool.
  * @param [in] object string pool instance.
- * @param [in] string to be added.
- * @param [out] out strong reference of added string.
+ * @return state of entry.
+ */
+static unsigned int attach_state(
+        const struct pufferfish_string_pool *const object) {
+    assert(object);
+    unsigned int state = 0;
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK) {
+        state |= PUFFERFISH_STRING_POOL_ENTRY_COUNTED;
+    }
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM) {
+        state |= PUFFERFISH_STRING_POOL_ENTRY_DEFERRED;
+    }
+    if (object->budget) {
+        state |= PUFFERFISH_STRING_POOL_ENTRY_CACHED;
+    }
+    return state;
+}
+
+/**
+ * @brief Mark entry as recently retrieved so that eviction passes it over.
+ * <p>Safe to call without holding the lock.</p>
+ * @param [in] entry instance that has been retrieved.
+ */
+static void entry_touch(struct pufferfish_string_pool_entry *const entry) {
+    assert(entry);
+    /* only the first retrieval after the clock has passed writes */
+    if (!(PUFFERFISH_STRING_POOL_ENTRY_REFERENCED
+          & atomic_load_explicit(&entry->state, memory_order_relaxed))) {
+        atomic_fetch_or_explicit(&entry->state,
+                                 PUFFERFISH_STRING_POOL_ENTRY_REFERENCED,
+                                 memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Remove the string pool's ownership of entry.
+ * <p>The entry is destroyed here if its strong reference count has already
+ * reached zero, otherwise it will be destroyed once it does.</p>
+ * @param [in] entry instance to be detached.
+ */
+static void entry_detach(struct pufferfish_string_pool_entry *const entry) {
+    assert(entry);
+    if (entry->arena) {
+        pufferfish_arena_retain(entry->arena);
+    }
+    seagrass_required_true(triggerfish_weak_destroy(entry->weak));
+    const unsigned int state = atomic_fetch_or_explicit(
+            &entry->state, PUFFERFISH_STRING_POOL_ENTRY_DETACHED,
+            memory_order_acq_rel);
+    if (state & PUFFERFISH_STRING_POOL_ENTRY_DEAD) {
+        struct pufferfish_string_pool_snapshot *const snapshot
+                = entry_snapshot(entry);
+        struct pufferfish_arena *const arena = entry->arena;
+        entry_destroy(entry);
+        if (arena) {
+            pufferfish_arena_release(arena);
+        }
+        if (snapshot) {
+            pufferfish_snapshot_release(snapshot);
+        }
+    }
+}
+
+/**
+ * @brief Create entry for string.
+ * <p>The entry starts out detached and must be attached once it has been
+ * added to the hash table.</p>
+ * @param [in] arena to carve entry from or <i>NULL</i> to allocate it on its
+ * own.
+ * @param [in] snapshot whose contents string refers to or <i>NULL</i> to have
+ * the contents copied into the entry.
+ * @param [in] string contents of entry.
+ * @param [in] hash of string.
+ * @param [out] out receive entry.
+ * @param [out] strong receive strong reference of entry.
  * @return On success true, otherwise false if an error has occurred.
  * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
- * insufficient memory to update the memory pool.
+ * insufficient memory to create entry.
  */
-static bool add(struct pufferfish_string_pool *const object,
-                const struct sea_turtle_string *const string,
-                struct triggerfish_strong **const out) {
-    assert(object);
+static bool entry_of(struct pufferfish_arena *const arena,
+                     struct pufferfish_string_pool_snapshot *const snapshot,
+                     const struct sea_turtle_string *const string,
+                     const uintmax_t hash,
+                     struct pufferfish_string_pool_entry **const out,
+                     struct triggerfish_strong **const strong) {
     assert(string);
     assert(out);
-    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
-    /* acquire write lock and recheck state */
-    seagrass_required_true(!pthread_rwlock_wrlock(&object->lock));
-    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
-    if (seahorse_red_black_tree_map_s_wr_get_entry(&object->map,
-                                                   string,
-                                                   &entry)) {
-        const struct triggerfish_weak *weak;
-        seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_get_value(
-                &object->map, entry, &weak));
-        if (triggerfish_weak_strong(weak, out)) {
-            return true;
-        }
-        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
-                               == triggerfish_error);
-        seagrass_required_true(seahorse_red_black_tree_map_s_wr_remove_entry(
-                &object->map, entry));
-    } else if (SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
-               == seahorse_error) {
+    assert(strong);
+    const size_t size = offsetof(struct pufferfish_string_pool_entry, chars)
+                        + (snapshot ? sizeof(snapshot) : string->size + 1);
+    if (!snapshot && size <= string->size) {
         pufferfish_error =
                 PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
         return false;
     }
-    struct sea_turtle_string *key = malloc(sizeof(*key));
-    if (!key) {
-        pufferfish_error =
-                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+    struct pufferfish_string_pool_entry *entry;
+    if (!arena) {
+        entry = malloc(size);
+        if (!entry) {
+            pufferfish_error =
+                    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+    } else if (!pufferfish_arena_allocate(arena, size, (void **) &entry)) {
         return false;
     }
-    if (!sea_turtle_string_init_string(key, string)) {
-        seagrass_required_true(SEA_TURTLE_STRING_ERROR_MEMORY_ALLOCATION_FAILED
-                               == sea_turtle_error);
-        free(key);
-        pufferfish_error =
-                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
-        return false;
+    *entry = (struct pufferfish_string_pool_entry) {
+            .string = *string,
+            .hash = hash,
+            .arena = arena
+    };
+    if (snapshot) {
+        memcpy(entry->chars, &snapshot, sizeof(snapshot));
+    } else {
+        entry->string.data = entry->chars;
+        memcpy(entry->chars, string->data, string->size);
+        entry->chars[string->size] = '\0';
     }
-    struct triggerfish_strong *strong;
-    if (!triggerfish_strong_of(key, on_destroy, &strong)) {
+    atomic_init(&entry->state, PUFFERFISH_STRING_POOL_ENTRY_DETACHED);
+    if (!triggerfish_strong_of(&entry->string, on_entry_destroy, strong)) {
         seagrass_required_true(TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED
                                == triggerfish_error);
-        seagrass_required_true(sea_turtle_string_invalidate(key));
-        free(key);
+        entry_destroy(entry);
         pufferfish_error =
                 PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
         return false;
     }
-    struct triggerfish_weak *weak;
-    if (!triggerfish_weak_of(strong, &weak)) {
+    if (arena) {
+        pufferfish_arena_retain(arena);
+    }
+    if (snapshot) {
+        pufferfish_snapshot_retain(snapshot);
+    }
+    if (!triggerfish_weak_of(*strong, &entry->weak)) {
         seagrass_required_true(TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED
                                == triggerfish_error);
-        seagrass_required_true(triggerfish_strong_release(strong));
+        seagrass_required_true(triggerfish_strong_release(*strong));
         pufferfish_error =
                 PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
         return false;
     }
-    const bool result = seahorse_red_black_tree_map_s_wr_add(
-            &object->map, string, weak);
-    if (!result) {
-        seagrass_required_true(
-                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
-                == seahorse_error);
-        seagrass_required_true(triggerfish_strong_release(strong));
-        pufferfish_error =
-                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
-    } else {
-        *out = strong;
-    }
-    seagrass_required_true(triggerfish_weak_destroy(weak));
-    return result;
+    *out = entry;
+    return true;
 }
 
-bool pufferfish_string_pool_get(struct pufferfish_string_pool *const object,
-                                const struct sea_turtle_string *const string,
-                                struct triggerfish_strong **const out) {
-    if (!object) {
-        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
-        return false;
-    }
-    if (!string) {
-        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
-        return false;
+/**
+ * @brief Create entry for string that is not in the string pool.
+ * <p>If the snapshot beneath the string pool holds the string the entry
+ * refers to its contents there instead of copying them.</p>
+ * @param [in] object string pool instance.
+ * @param [in] arena to carve entry from or <i>NULL</i> to allocate it on its
+ * own.
+ * @param [in] string contents of entry.
+ * @param [in] hash of string.
+ * @param [out] out receive entry.
+ * @param [out] strong receive strong reference of entry.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create entry.
+ */
+static bool entry_create(const struct pufferfish_string_pool *const object,
+                         struct pufferfish_arena *const arena,
+                         const struct sea_turtle_string *const string,
+                         const uintmax_t hash,
+                         struct pufferfish_string_pool_entry **const out,
+                         struct triggerfish_strong **const strong) {
+    assert(object);
+    assert(string);
+    if (object->snapshot) {
+        const char *const chars = pufferfish_snapshot_find(
+                object->snapshot, hash, string->data, string->size);
+        if (chars) {
+            struct sea_turtle_string frozen = *string;
+            frozen.data = (char *) chars;
+            return entry_of(arena, object->snapshot, &frozen, hash, out,
+                            strong);
+        }
     }
-    if (!out) {
-        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
-        return false;
+    return entry_of(arena, NULL, string, hash, out, strong);
+}
+
+/**
+ * @brief Find slot containing the entry for string.
+ * <p>Safe to call without holding the lock from inside an epoch protected
+ * read-side critical section.</p>
+ * @param [in] table hash table instance.
+ * @param [in] hash of string.
+ * @param [in] string to find.
+ * @param [out] out receive entry.
+ * @return slot of entry or <i>NULL</i> if string was not found.
+ */
+static struct pufferfish_string_pool_slot *table_find(
+        const struct pufferfish_string_pool_table *const table,
+        const uintmax_t hash,
+        const struct sea_turtle_string *const string,
+        struct pufferfish_string_pool_entry **const out) {
+    assert(string);
+    assert(out);
+    if (!table) {
+        return NULL;
     }
-    switch (pthread_rwlock_rdlock(&object->lock)) {
-        default: {
-            seagrass_required_true(false);
+    const uintmax_t mask = table->length - 1;
+    for (uintmax_t i = hash & mask;; i = (i + 1) & mask) {
+        struct pufferfish_string_pool_slot *const slot
+                = (struct pufferfish_string_pool_slot *) &table->slots[i];
+        struct pufferfish_string_pool_entry *const entry
+                = atomic_load_explicit(&slot->entry, memory_order_acquire);
+        if (!entry) {
+            return NULL;
         }
-        case EAGAIN: {
-            pufferfish_error =
-                    PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED;
-            return false;
+        if (&tombstone != entry
+            && hash == atomic_load_explicit(&slot->hash, memory_order_relaxed)
+            && string->size == entry->string.size
+            && pufferfish_chars_equal(string->data, entry->string.data,
+                                      string->size)) {
+            *out = entry;
+            return slot;
         }
-        case 0: {
-            /* fall-through */
+    }
+}
+
+/**
+ * @brief Place entry in the first free slot for its hash.
+ * @param [in] table hash table instance.
+ * @param [in] entry to be placed.
+ */
+static void table_place(struct pufferfish_string_pool_table *const table,
+                        struct pufferfish_string_pool_entry *const entry) {
+    assert(table);
+    assert(entry);
+    const uintmax_t mask = table->length - 1;
+    struct pufferfish_string_pool_slot *slot;
+    struct pufferfish_string_pool_entry *current;
+    for (uintmax_t i = entry->hash & mask;; i = (i + 1) & mask) {
+        slot = &table->slots[i];
+        current = atomic_load_explicit(&slot->entry, memory_order_relaxed);
+        if (!current || &tombstone == current) {
+            break;
         }
     }
-    bool result = get(&object->map, string, out);
+    if (!current) {
+        table->used += 1;
+    }
+    atomic_store_explicit(&slot->hash, entry->hash, memory_order_relaxed);
+    atomic_store_explicit(&slot->entry, entry, memory_order_release);
+}
+
+/**
+ * @brief Free index.
+ * @param [in] index instance or <i>NULL</i>.
+ */
+static void index_free(struct pufferfish_string_pool_index *const index) {
+    if (!index) {
+        return;
+    }
+    for (uintmax_t i = 0; i < index->length; i++) {
+        free(index->blocks[i]);
+    }
+    free(index->blocks);
+    free(index);
+}
+
+/**
+ * @brief Discard the index, the next cursor that needs it builds it again.
+ * @param [in] object string pool instance.
+ */
+static void index_drop(struct pufferfish_string_pool *const object) {
+    assert(object);
+    index_free(object->index);
+    object->index = NULL;
+}
+
+/**
+ * @brief Check whether entry comes before the position of key.
+ * @param [in] entry of index.
+ * @param [in] key to search for.
+ * @param [in] strict true if entries equal to key come before it as well.
+ * @return true if entry comes before key, otherwise false.
+ */
+static bool index_precedes(const struct pufferfish_string_pool_entry *const entry,
+                           const struct sea_turtle_string *const key,
+                           const bool strict) {
+    assert(entry);
+    assert(key);
+    const int result = sea_turtle_string_compare(&entry->string, key);
+    return result < 0 || (strict && !result);
+}
+
+/**
+ * @brief Find the first entry of the index after key.
+ * @param [in] index of hash table.
+ * @param [in] key to search for.
+ * @param [in] strict true to skip entries equal to key.
+ * @param [out] block receive position of block holding entry or length of
+ * index if there is none.
+ * @param [out] i receive position of entry in its block.
+ */
+static void index_search(const struct pufferfish_string_pool_index *const index,
+                         const struct sea_turtle_string *const key,
+                         const bool strict,
+                         uintmax_t *const block,
+                         uintmax_t *const i) {
+    assert(index);
+    assert(key);
+    assert(block);
+    assert(i);
+    /* first block whose last entry does not come before key */
+    uintmax_t low = 0;
+    uintmax_t high = index->length;
+    while (low < high) {
+        const uintmax_t middle = low + (high - low) / 2;
+        const struct pufferfish_string_pool_index_block *const at
+                = index->blocks[middle];
+        if (index_precedes(at->entries[at->count - 1], key, strict)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    *block = low;
+    *i = 0;
+    if (low == index->length) {
+        return;
+    }
+    const struct pufferfish_string_pool_index_block *const at
+            = index->blocks[low];
+    low = 0;
+    high = at->count;
+    while (low < high) {
+        const uintmax_t middle = low + (high - low) / 2;
+        if (index_precedes(at->entries[middle], key, strict)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    *i = low;
+}
+
+/**
+ * @brief Make room for a block in the index after block.
+ * <p>The upper half of the entries of block is moved to the new block, an
+ * empty index receives an empty block.</p>
+ * @param [in] index of hash table.
+ * @param [in] block position of full block, ignored if index is empty.
+ * @return On success true, otherwise false if there is insufficient memory.
+ */
+static bool index_split(struct pufferfish_string_pool_index *const index,
+                        const uintmax_t block) {
+    assert(index);
+    if (index->length == index->capacity) {
+        const uintmax_t capacity = index->capacity ? index->capacity * 2 : 4;
+        struct pufferfish_string_pool_index_block **const blocks = realloc(
+                index->blocks, capacity * sizeof(*blocks));
+        if (!blocks) {
+            return false;
+        }
+        index->blocks = blocks;
+        index->capacity = capacity;
+    }
+    struct pufferfish_string_pool_index_block *const added = malloc(
+            sizeof(*added));
+    if (!added) {
+        return false;
+    }
+    added->count = 0;
+    if (!index->length) {
+        index->blocks[index->length++] = added;
+        return true;
+    }
+    struct pufferfish_string_pool_index_block *const full
+            = index->blocks[block];
+    added->count = full->count / 2;
+    full->count -= added->count;
+    memcpy(added->entries, &full->entries[full->count],
+           added->count * sizeof(*added->entries));
+    memmove(&index->blocks[block + 2], &index->blocks[block + 1],
+            (index->length - block - 1) * sizeof(*index->blocks));
+    index->blocks[block + 1] = added;
+    index->length += 1;
+    return true;
+}
+
+/**
+ * @brief Add entry that has been placed in the hash table to the index.
+ * <p>Without an index there is nothing to do. If there is insufficient memory
+ * to grow the index it is discarded instead.</p>
+ * @param [in] object string pool instance.
+ * @param [in] entry to be added.
+ */
+static void index_insert(struct pufferfish_string_pool *const object,
+                         struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    struct pufferfish_string_pool_index *const index = object->index;
+    if (!index) {
+        return;
+    }
+    uintmax_t block;
+    uintmax_t i;
+    index_search(index, &entry->string, false, &block, &i);
+    if (block == index->length && block) {
+        /* comes after every entry */
+        block -= 1;
+        i = index->blocks[block]->count;
+    }
+    if (!index->length
+        || PUFFERFISH_STRING_POOL_INDEX_BLOCK_LENGTH
+           == index->blocks[block]->count) {
+        if (!index_split(index, block)) {
+            index_drop(object);
+            return;
+        }
+        if (i > index->blocks[block]->count) {
+            i -= index->blocks[block]->count;
+            block += 1;
+        }
+    }
+    struct pufferfish_string_pool_index_block *const at
+            = index->blocks[block];
+    memmove(&at->entries[i + 1], &at->entries[i],
+            (at->count - i) * sizeof(*at->entries));
+    at->entries[i] = entry;
+    at->count += 1;
+    index->count += 1;
+}
+
+/**
+ * @brief Remove entry from the index.
+ * <p>Blocks that become empty are freed and a block is merged into the one
+ * before it once both fit into half a block.</p>
+ * @param [in] index of hash table.
+ * @param [in] block position of block holding entry.
+ * @param [in] i position of entry in its block.
+ */
+static void index_erase(struct pufferfish_string_pool_index *const index,
+                        uintmax_t block,
+                        const uintmax_t i) {
+    assert(index);
+    struct pufferfish_string_pool_index_block *at = index->blocks[block];
+    memmove(&at->entries[i], &at->entries[i + 1],
+            (at->count - i - 1) * sizeof(*at->entries));
+    at->count -= 1;
+    index->count -= 1;
+    if (at->count && block + 1 < index->length
+        && at->count + index->blocks[block + 1]->count
+           <= PUFFERFISH_STRING_POOL_INDEX_BLOCK_LENGTH / 2) {
+        /* the following block is merged into this one */
+        const struct pufferfish_string_pool_index_block *const next
+                = index->blocks[block + 1];
+        memcpy(&at->entries[at->count], next->entries,
+               next->count * sizeof(*next->entries));
+        at->count += next->count;
+        block += 1;
+        at = index->blocks[block];
+        at->count = 0;
+    }
+    if (at->count) {
+        return;
+    }
+    free(at);
+    memmove(&index->blocks[block], &index->blocks[block + 1],
+            (index->length - block - 1) * sizeof(*index->blocks));
+    index->length -= 1;
+}
+
+/**
+ * @brief Remove entry that is unlinked from the hash table from the index.
+ * <p>An entry that was replaced in place while queued for removal may have
+ * been left out of an index built since, it is then not found.</p>
+ * @param [in] object string pool instance.
+ * @param [in] entry to be removed.
+ */
+static void index_remove(struct pufferfish_string_pool *const object,
+                         const struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    struct pufferfish_string_pool_index *const index = object->index;
+    if (!index) {
+        return;
+    }
+    uintmax_t block;
+    uintmax_t i;
+    index_search(index, &entry->string, false, &block, &i);
+    /* entries of the same string may precede it */
+    for (; block < index->length; block++, i = 0) {
+        const struct pufferfish_string_pool_index_block *const at
+                = index->blocks[block];
+        for (; i < at->count; i++) {
+            if (entry == at->entries[i]) {
+                index_erase(index, block, i);
+                return;
+            }
+            if (sea_turtle_string_compare(&at->entries[i]->string,
+                                          &entry->string)) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Retire dead entry that has been unlinked from the hash table.
+ * <p>In lock free read mode a reader may still be looking at the entry so
+ * detaching it is deferred until the retired entries are reclaimed.</p>
+ * @param [in] object string pool instance.
+ * @param [in] entry to be retired.
+ */
+static void retire_entry(struct pufferfish_string_pool *const object,
+                         struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    index_remove(object, entry);
+    /* a replaced entry may not have been counted yet so the count of deaths
+     * is only an estimate */
+    const unsigned int counted = PUFFERFISH_STRING_POOL_ENTRY_COUNTED
+                                 | PUFFERFISH_STRING_POOL_ENTRY_DEAD;
+    if (counted == (counted & atomic_load_explicit(&entry->state,
+                                                   memory_order_acquire))) {
+        atomic_fetch_sub_explicit(&object->arena->deaths, 1,
+                                  memory_order_relaxed);
+    }
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ)) {
+        entry_detach(entry);
+        return;
+    }
+    /* cached references to the entry must not outlive the grace period */
+    atomic_fetch_add_explicit(&object->generation, 1, memory_order_release);
+    entry->next = object->retired_entries;
+    object->retired_entries = entry;
+    object->retired += 1;
+}
+
+/**
+ * @brief Retire hash table that has been replaced.
+ * @param [in] object string pool instance.
+ * @param [in] table to be retired.
+ */
+static void retire_table(struct pufferfish_string_pool *const object,
+                         struct pufferfish_string_pool_table *const table) {
+    assert(object);
+    assert(table);
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ)) {
+        free(table);
+        return;
+    }
+    table->next = object->retired_tables;
+    object->retired_tables = table;
+    object->retired += 1;
+}
+
+/**
+ * @brief Retire symbol table that has been replaced.
+ * @param [in] object string pool instance.
+ * @param [in] symbols to be retired.
+ */
+static void retire_symbols(struct pufferfish_string_pool *const object,
+                           struct pufferfish_string_pool_symbols *const symbols) {
+    assert(object);
+    assert(symbols);
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ)) {
+        free(symbols);
+        return;
+    }
+    symbols->next = object->retired_symbols;
+    object->retired_symbols = symbols;
+    object->retired += 1;
+}
+
+/**
+ * @brief Reclaim retired entries and hash tables.
+ * @param [in] object string pool instance.
+ */
+static void retired_reclaim(struct pufferfish_string_pool *const object) {
+    assert(object);
+    if (!object->retired) {
+        return;
+    }
+    pufferfish_epoch_synchronize();
+    while (object->retired_entries) {
+        struct pufferfish_string_pool_entry *const entry
+                = object->retired_entries;
+        object->retired_entries = entry->next;
+        entry_detach(entry);
+    }
+    while (object->retired_tables) {
+        struct pufferfish_string_pool_table *const table
+                = object->retired_tables;
+        object->retired_tables = table->next;
+        free(table);
+    }
+    while (object->retired_symbols) {
+        struct pufferfish_string_pool_symbols *const symbols
+                = object->retired_symbols;
+        object->retired_symbols = symbols->next;
+        free(symbols);
+    }
+    object->retired = 0;
+}
+
+/**
+ * @brief Take an unused symbol.
+ * <p>Released symbols are handed out again before the symbol table grows.</p>
+ * @param [in] object string pool instance.
+ * @param [out] out receive symbol.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to grow the symbol table or all symbols are in use.
+ */
+static bool symbol_acquire(struct pufferfish_string_pool *const object,
+                           uint32_t *const out) {
+    assert(object);
+    assert(out);
+    struct pufferfish_string_pool_symbols *symbols = atomic_load_explicit(
+            &object->symbols, memory_order_relaxed);
+    if (object->symbols_free) {
+        const uint32_t symbol = object->symbols_free - 1;
+        object->symbols_free = atomic_load_explicit(
+                &symbols->entries[symbol], memory_order_relaxed) >> 1;
+        *out = symbol;
+        return true;
+    }
+    if (!symbols || symbols->used == symbols->length) {
+        const uintmax_t length = symbols
+                ? symbols->length * 2
+                : PUFFERFISH_STRING_POOL_SYMBOLS_MINIMUM_LENGTH;
+        struct pufferfish_string_pool_symbols *const grown
+                = symbols && symbols->length
+                             >= PUFFERFISH_STRING_POOL_SYMBOLS_MAXIMUM_LENGTH
+                        ? NULL
+                        : calloc(1, sizeof(*grown)
+                                    + length * sizeof(grown->entries[0]));
+        if (!grown) {
+            pufferfish_error =
+                    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+        grown->length = length;
+        if (symbols) {
+            grown->used = symbols->used;
+            for (uintmax_t i = 0; i < symbols->used; i++) {
+                atomic_init(&grown->entries[i], atomic_load_explicit(
+                        &symbols->entries[i], memory_order_relaxed));
+            }
+            retire_symbols(object, symbols);
+        }
+        atomic_store_explicit(&object->symbols, grown, memory_order_release);
+        symbols = grown;
+    }
+    *out = (uint32_t) symbols->used++;
+    return true;
+}
+
+/**
+ * @brief Hand symbol out again once it is needed.
+ * @param [in] object string pool instance.
+ * @param [in] symbol to be released.
+ */
+static void symbol_release(struct pufferfish_string_pool *const object,
+                           const uint32_t symbol) {
+    assert(object);
+    struct pufferfish_string_pool_symbols *const symbols
+            = atomic_load_explicit(&object->symbols, memory_order_relaxed);
+    seagrass_required_true(symbols && symbol < symbols->used);
+    atomic_store_explicit(&symbols->entries[symbol],
+                          (object->symbols_free << 1)
+                          | PUFFERFISH_STRING_POOL_SYMBOL_FREE,
+                          memory_order_release);
+    object->symbols_free = (uintmax_t) symbol + 1;
+}
+
+/**
+ * @brief Have symbol stand for entry.
+ * @param [in] object string pool instance.
+ * @param [in] symbol acquired for entry.
+ * @param [in] entry to be numbered.
+ */
+static void symbol_assign(struct pufferfish_string_pool *const object,
+                          const uint32_t symbol,
+                          struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    struct pufferfish_string_pool_symbols *const symbols
+            = atomic_load_explicit(&object->symbols, memory_order_relaxed);
+    entry->symbol = symbol;
+    atomic_store_explicit(&symbols->entries[symbol], (uintptr_t) entry,
+                          memory_order_release);
+}
+
+/**
+ * @brief Rebuild hash table to fit the given number of entries.
+ * <p>Entries are moved using their cached hash and tombstones are dropped.</p>
+ * @param [in] object string pool instance.
+ * @param [in] count number of entries the hash table must fit.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to rebuild the hash table.
+ */
+static bool table_resize(struct pufferfish_string_pool *const object,
+                         const uintmax_t count) {
+    assert(object);
+    uintmax_t length = PUFFERFISH_STRING_POOL_TABLE_MINIMUM_LENGTH;
+    while (length / 2 < count) {
+        length <<= 1;
+    }
+    struct pufferfish_string_pool_table *const table = calloc(
+            1, sizeof(*table) + length * sizeof(table->slots[0]));
+    if (!table) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    table->length = length;
+    struct pufferfish_string_pool_table *const current = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    if (current) {
+        for (uintmax_t i = 0; i < current->length; i++) {
+            struct pufferfish_string_pool_entry *const entry
+                    = atomic_load_explicit(&current->slots[i].entry,
+                                           memory_order_relaxed);
+            if (entry && &tombstone != entry) {
+                table_place(table, entry);
+            }
+        }
+        retire_table(object, current);
+    }
+    atomic_store_explicit(&object->table, table, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Replace the entry in slot of the hash table with a tombstone.
+ * <p>The entry is left to the caller to retire.</p>
+ * @param [in] object string pool instance.
+ * @param [in] slot holding entry.
+ * @param [in] entry to be removed.
+ */
+static void table_remove(struct pufferfish_string_pool *const object,
+                         struct pufferfish_string_pool_slot *const slot,
+                         const struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(slot);
+    assert(entry);
+    atomic_store_explicit(&slot->entry, &tombstone, memory_order_release);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_SYMBOLS) {
+        symbol_release(object, entry->symbol);
+    }
+    object->count -= 1;
+}
+
+/**
+ * @brief Release the hash table if it is empty or drop its tombstones if
+ * there are many.
+ * @param [in] object string pool instance.
+ */
+static void table_compact(struct pufferfish_string_pool *const object) {
+    assert(object);
+    struct pufferfish_string_pool_table *const table = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    if (!table) {
+        return;
+    }
+    if (!object->count) {
+        atomic_store_explicit(&object->table, NULL, memory_order_release);
+        retire_table(object, table);
+    } else if (table->used - object->count > table->length / 4) {
+        /* dropping tombstones is an optimization so failure is harmless */
+        (void) table_resize(object, object->count);
+    }
+}
+
+/**
+ * @brief Remove queued entry from the hash table.
+ * <p>The entry may already have been replaced in its slot by an entry for
+ * the same string, which then keeps its symbol.</p>
+ * @param [in] object string pool instance.
+ * @param [in] entry to be removed.
+ * @return true if entry was removed, false if it had been replaced.
+ */
+static bool table_unlink(struct pufferfish_string_pool *const object,
+                         struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    struct pufferfish_string_pool_table *const table = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    if (!table) {
+        return false;
+    }
+    const uintmax_t mask = table->length - 1;
+    for (uintmax_t i = entry->hash & mask;; i = (i + 1) & mask) {
+        struct pufferfish_string_pool_slot *const slot = &table->slots[i];
+        const struct pufferfish_string_pool_entry *const current
+                = atomic_load_explicit(&slot->entry, memory_order_relaxed);
+        if (!current) {
+            return false;
+        }
+        if (current == entry) {
+            table_remove(object, slot, entry);
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Make room for one more owned entry.
+ * @param [in] object string pool instance.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to grow the owned entries.
+ */
+static bool owned_reserve(struct pufferfish_string_pool *const object) {
+    assert(object);
+    if (object->owned_count < object->owned_capacity) {
+        return true;
+    }
+    const uintmax_t capacity = object->owned_capacity
+                               ? object->owned_capacity * 2 : 4;
+    struct pufferfish_string_pool_entry **owned = NULL;
+    /* positions are kept in 32 bits */
+    if (capacity <= (uintmax_t) UINT32_MAX + 1) {
+        owned = realloc(object->owned, capacity * sizeof(*owned));
+    }
+    if (!owned) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    object->owned = owned;
+    object->owned_capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Add attached entry to the owned entries.
+ * <p>Room must have been made by owned_reserve().</p>
+ * @param [in] object string pool instance.
+ * @param [in] entry to be added.
+ */
+static void owned_add(struct pufferfish_string_pool *const object,
+                      struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    assert(object->owned_count < object->owned_capacity);
+    entry->owned = (uint32_t) object->owned_count;
+    object->owned[object->owned_count++] = entry;
+}
+
+/**
+ * @brief Remove entry that is about to be detached from the owned entries.
+ * @param [in] object string pool instance.
+ * @param [in] entry to be removed.
+ */
+static void owned_remove(struct pufferfish_string_pool *const object,
+                         const struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    assert(entry->owned < object->owned_count);
+    assert(entry == object->owned[entry->owned]);
+    struct pufferfish_string_pool_entry *const last
+            = object->owned[--object->owned_count];
+    object->owned[entry->owned] = last;
+    last->owned = entry->owned;
+}
+
+/**
+ * @brief Remove the red-black tree node of queued entry.
+ * <p>The node is left alone if it has been replaced by one for a live entry
+ * of the same string or already removed by shrinking.</p>
+ * @param [in] object string pool instance.
+ * @param [in] entry whose node is to be removed.
+ */
+static void tree_unlink(struct pufferfish_string_pool *const object,
+                        const struct pufferfish_string_pool_entry *const entry) {
+    assert(object);
+    assert(entry);
+    const struct seahorse_red_black_tree_map_s_wr_entry *node;
+    if (!seahorse_red_black_tree_map_s_wr_get_entry(&object->map,
+                                                    &entry->string, &node)) {
+        /* shrinking removes what is left behind on failure */
+        seagrass_required_true(
+                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_KEY_NOT_FOUND
+                == seahorse_error
+                || SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
+                   == seahorse_error);
+        return;
+    }
+    const struct triggerfish_weak *weak;
+    seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_get_value(
+            &object->map, node, &weak));
+    struct triggerfish_strong *strong;
+    if (triggerfish_weak_strong(weak, &strong)) {
+        seagrass_required_true(triggerfish_strong_release(strong));
+        return;
+    }
+    seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                           == triggerfish_error);
+    seagrass_required_true(seahorse_red_black_tree_map_s_wr_remove_entry(
+            &object->map, node));
+}
+
+/**
+ * @brief Remove the next queued dead entries while holding the write lock.
+ * <p>Entries are moved off the lock-free queue the destroy callback feeds
+ * before they are removed, so that the queue stays usable by threads
+ * releasing strings meanwhile.</p>
+ * @param [in] object string pool instance.
+ * @param [in] limit maximum number of entries to remove.
+ * @return true if no queued entries are left.
+ */
+static bool drain_step(struct pufferfish_string_pool *const object,
+                       const uintmax_t limit) {
+    assert(object);
+    assert(limit);
+    struct pufferfish_string_pool_entry *queued = atomic_exchange_explicit(
+            &object->arena->dead, NULL, memory_order_acquire);
+    while (queued) {
+        struct pufferfish_string_pool_entry *const next = queued->next;
+        queued->next = object->dead;
+        object->dead = queued;
+        queued = next;
+    }
+    const bool hashed = object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE;
+    for (uintmax_t i = 0; object->dead && i < limit; i++) {
+        struct pufferfish_string_pool_entry *const entry = object->dead;
+        object->dead = entry->next;
+        /* a replaced entry stopped being counted when it was replaced */
+        if (!hashed || table_unlink(object, entry)) {
+            atomic_fetch_sub_explicit(&object->arena->queued, 1,
+                                      memory_order_relaxed);
+        }
+        if (hashed) {
+            retire_entry(object, entry);
+        } else {
+            tree_unlink(object, entry);
+            owned_remove(object, entry);
+            entry_detach(entry);
+        }
+    }
+    const bool result = !object->dead;
+    if (hashed && result) {
+        table_compact(object);
+    }
+    if (result || object->retired >= PUFFERFISH_STRING_POOL_RETIRED_LIMIT) {
+        retired_reclaim(object);
+    }
+    return result;
+}
+
+/**
+ * @brief Have the string pool hold a strong reference of live entry so that
+ * it is kept once unused.
+ * @param [in] entry instance to be kept.
+ */
+static void cache_hold(struct pufferfish_string_pool_entry *const entry) {
+    assert(entry);
+    struct triggerfish_strong *strong;
+    if (!triggerfish_weak_strong(entry->weak, &strong)) {
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+        return;
+    }
+    const unsigned int state = atomic_fetch_or_explicit(
+            &entry->state, PUFFERFISH_STRING_POOL_ENTRY_CACHED,
+            memory_order_relaxed);
+    if (state & PUFFERFISH_STRING_POOL_ENTRY_CACHED) {
+        seagrass_required_true(triggerfish_strong_release(strong));
+    }
+}
+
+/**
+ * @brief Release the strong reference the string pool holds of kept entry.
+ * @param [in] entry instance that is kept.
+ * @param [in] unused only release it if nothing else references entry.
+ * @return true if the strong reference has been released.
+ */
+static bool cache_drop(struct pufferfish_string_pool_entry *const entry,
+                       const bool unused) {
+    assert(entry);
+    struct triggerfish_strong *strong;
+    seagrass_required_true(triggerfish_weak_strong(entry->weak, &strong));
+    if (unused) {
+        uintmax_t count;
+        seagrass_required_true(triggerfish_strong_count(strong, &count));
+        /* one is held by the string pool and one was just retrieved */
+        if (count > 2) {
+            seagrass_required_true(triggerfish_strong_release(strong));
+            return false;
+        }
+    }
+    atomic_fetch_and_explicit(&entry->state,
+                              ~PUFFERFISH_STRING_POOL_ENTRY_CACHED,
+                              memory_order_relaxed);
+    seagrass_required_true(triggerfish_strong_release(strong));
+    seagrass_required_true(triggerfish_strong_release(strong));
+    return true;
+}
+
+/**
+ * @brief Release the strong references of all kept entries.
+ * <p>Entries that die are left to be removed by shrinking or, if they are
+ * queued, by draining the queue.</p>
+ * @param [in] object string pool instance.
+ */
+static void cache_clear(struct pufferfish_string_pool *const object) {
+    assert(object);
+    const struct pufferfish_string_pool_table *const table
+            = atomic_load_explicit(&object->table, memory_order_relaxed);
+    for (uintmax_t i = 0; table && i < table->length; i++) {
+        struct pufferfish_string_pool_entry *const entry
+                = atomic_load_explicit(&table->slots[i].entry,
+                                       memory_order_relaxed);
+        if (entry && &tombstone != entry
+            && (PUFFERFISH_STRING_POOL_ENTRY_CACHED
+                & atomic_load_explicit(&entry->state, memory_order_relaxed))) {
+            (void) cache_drop(entry, false);
+        }
+    }
+}
+
+/**
+ * @brief Evict unused entries until the string pool is within its budget.
+ * <p>The clock hand sweeps the hash table giving recently retrieved entries
+ * a second chance, it stops after two turns if there is nothing left to
+ * evict as then the remaining entries are all in use.</p>
+ * @param [in] object string pool instance.
+ */
+static void cache_evict(struct pufferfish_string_pool *const object) {
+    assert(object);
+    struct pufferfish_string_pool_table *const table = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    /* queued entries stay counted until the queue is drained, they are
+     * left out as draining removes them anyway */
+    const uintmax_t queued = atomic_load_explicit(&object->arena->queued,
+                                                  memory_order_relaxed);
+    if (!table || object->count <= object->budget + queued) {
+        return;
+    }
+    uintmax_t excess = object->count - object->budget - queued;
+    for (uintmax_t i = 0; excess && i < 2 * table->length; i++) {
+        if (object->clock_hand >= table->length) {
+            object->clock_hand = 0;
+        }
+        struct pufferfish_string_pool_slot *const slot
+                = &table->slots[object->clock_hand++];
+        struct pufferfish_string_pool_entry *const entry
+                = atomic_load_explicit(&slot->entry, memory_order_relaxed);
+        if (!entry || &tombstone == entry) {
+            continue;
+        }
+        unsigned int state = atomic_load_explicit(&entry->state,
+                                                  memory_order_acquire);
+        if (state & PUFFERFISH_STRING_POOL_ENTRY_DEAD) {
+            /* queued entries were left out of the excess */
+            if (state & PUFFERFISH_STRING_POOL_ENTRY_DEFERRED) {
+                continue;
+            }
+        } else {
+            if (!(state & PUFFERFISH_STRING_POOL_ENTRY_CACHED)) {
+                continue;
+            }
+            if (state & PUFFERFISH_STRING_POOL_ENTRY_REFERENCED) {
+                atomic_fetch_and_explicit(
+                        &entry->state,
+                        ~PUFFERFISH_STRING_POOL_ENTRY_REFERENCED,
+                        memory_order_relaxed);
+                continue;
+            }
+            if (!cache_drop(entry, true)) {
+                continue;
+            }
+            stats_add(object, PUFFERFISH_STATS_EVICTIONS, 1);
+            /* a lock free reader may have retrieved it meanwhile */
+            state = atomic_load_explicit(&entry->state, memory_order_acquire);
+            if (!(state & PUFFERFISH_STRING_POOL_ENTRY_DEAD)) {
+                continue;
+            }
+        }
+        excess -= 1;
+        if (!(state & PUFFERFISH_STRING_POOL_ENTRY_DEFERRED)) {
+            table_remove(object, slot, entry);
+            retire_entry(object, entry);
+        }
+    }
+}
+
+/**
+ * @brief Hand every entry of the red-black tree, dead or alive, over to its
+ * strong references before the string pool goes away.
+ * <p>Entries are reached through the owned entries rather than their weak
+ * references, which expire as soon as a string is released, so that queued
+ * entries are destroyed here and live ones once they die.</p>
+ * @param [in] object string pool instance.
+ */
+static void tree_detach(struct pufferfish_string_pool *const object) {
+    assert(object);
+    for (uintmax_t i = 0; i < object->owned_count; i++) {
+        entry_detach(object->owned[i]);
+    }
+    free(object->owned);
+    object->owned = NULL;
+    object->owned_count = 0;
+    object->owned_capacity = 0;
+}
+
+struct pufferfish_string_pool_reclaimer {
+    struct pufferfish_string_pool *string_pool;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    uintmax_t period;
+    /* guarded by mutex */
+    bool stopping;
+};
+
+/**
+ * @brief Drain the queue of dead entries once per period until stopped.
+ * @param [in] argument reclaimer instance.
+ * @return <i>NULL</i>.
+ */
+static void *reclaimer_run(void *const argument) {
+    struct pufferfish_string_pool_reclaimer *const object = argument;
+    struct pufferfish_string_pool *const string_pool = object->string_pool;
+    seagrass_required_true(!pthread_mutex_lock(&object->mutex));
+    while (!object->stopping) {
+        struct timespec until;
+        seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &until));
+        const uintmax_t nanoseconds = until.tv_nsec
+                                      + object->period % 1000000000;
+        until.tv_sec += (time_t) (object->period / 1000000000
+                                  + nanoseconds / 1000000000);
+        until.tv_nsec = (long) (nanoseconds % 1000000000);
+        const int error = pthread_cond_timedwait(&object->condition,
+                                                 &object->mutex, &until);
+        seagrass_required_true(!error || ETIMEDOUT == error);
+        if (object->stopping) {
+            break;
+        }
+        seagrass_required_true(!pthread_mutex_unlock(&object->mutex));
+        /* readers and writers get the lock between batches */
+        bool done;
+        do {
+            lock_write(string_pool);
+            done = drain_step(string_pool,
+                              PUFFERFISH_STRING_POOL_RECLAIMER_LIMIT);
+            seagrass_required_true(!pthread_rwlock_unlock(&string_pool->lock));
+        } while (!done);
+        seagrass_required_true(!pthread_mutex_lock(&object->mutex));
+    }
+    seagrass_required_true(!pthread_mutex_unlock(&object->mutex));
+    return NULL;
+}
+
+/**
+ * @brief Create reclaimer and start its thread.
+ * @param [in] string_pool to drain the queue of.
+ * @param [in] period between drains in nanoseconds.
+ * @param [out] out receive reclaimer.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there are
+ * insufficient resources to start the thread.
+ */
+static bool reclaimer_of(struct pufferfish_string_pool *const string_pool,
+                         const uintmax_t period,
+                         struct pufferfish_string_pool_reclaimer **const out) {
+    assert(string_pool);
+    assert(period);
+    assert(out);
+    struct pufferfish_string_pool_reclaimer *const object
+            = malloc(sizeof(*object));
+    if (!object) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    *object = (struct pufferfish_string_pool_reclaimer) {
+            .string_pool = string_pool,
+            .period = period
+    };
+    /* waiting on the monotonic clock is immune to the time being set */
+    pthread_condattr_t attributes;
+    bool result = !pthread_condattr_init(&attributes);
+    if (result) {
+        seagrass_required_true(!pthread_condattr_setclock(&attributes,
+                                                          CLOCK_MONOTONIC));
+        result = !pthread_cond_init(&object->condition, &attributes);
+        seagrass_required_true(!pthread_condattr_destroy(&attributes));
+    }
+    if (result && pthread_mutex_init(&object->mutex, NULL)) {
+        seagrass_required_true(!pthread_cond_destroy(&object->condition));
+        result = false;
+    }
+    if (result && pthread_create(&object->thread, NULL, reclaimer_run,
+                                 object)) {
+        seagrass_required_true(!pthread_mutex_destroy(&object->mutex));
+        seagrass_required_true(!pthread_cond_destroy(&object->condition));
+        result = false;
+    }
+    if (!result) {
+        free(object);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    *out = object;
+    return true;
+}
+
+/**
+ * @brief Stop reclaimer, wait for its thread to exit and destroy it.
+ * <p>Must be called without holding the lock of the string pool.</p>
+ * @param [in] object reclaimer instance.
+ */
+static void reclaimer_stop(struct pufferfish_string_pool_reclaimer *const object) {
+    assert(object);
+    seagrass_required_true(!pthread_mutex_lock(&object->mutex));
+    object->stopping = true;
+    seagrass_required_true(!pthread_cond_signal(&object->condition));
+    seagrass_required_true(!pthread_mutex_unlock(&object->mutex));
+    seagrass_required_true(!pthread_join(object->thread, NULL));
+    seagrass_required_true(!pthread_mutex_destroy(&object->mutex));
+    seagrass_required_true(!pthread_cond_destroy(&object->condition));
+    free(object);
+}
+
+bool pufferfish_string_pool_invalidate(
+        struct pufferfish_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    /* the reclaimer may be waiting for the lock */
+    if (object->reclaimer) {
+        reclaimer_stop(object->reclaimer);
+    }
+    seagrass_required_true(!pthread_rwlock_destroy(&object->lock));
+    if (object->shrink_cursor_string) {
+        seagrass_required_true(triggerfish_strong_release(
+                object->shrink_cursor_string));
+    }
+    cache_clear(object);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        if (object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM) {
+            (void) drain_step(object, UINTMAX_MAX);
+        }
+    } else {
+        /* queued entries are detached along with the others, strings
+         * released meanwhile included */
+        tree_detach(object);
+    }
+    seagrass_required_true(seahorse_red_black_tree_map_s_wr_invalidate(
+            &object->map));
+    retired_reclaim(object);
+    struct pufferfish_string_pool_table *const table = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    if (table) {
+        for (uintmax_t i = 0; i < table->length; i++) {
+            struct pufferfish_string_pool_entry *const entry
+                    = atomic_load_explicit(&table->slots[i].entry,
+                                           memory_order_relaxed);
+            if (entry && &tombstone != entry) {
+                entry_detach(entry);
+            }
+        }
+        free(table);
+    }
+    free(atomic_load_explicit(&object->symbols, memory_order_relaxed));
+    index_free(object->index);
+    if (object->arena) {
+        pufferfish_arena_release(object->arena);
+    }
+    if (object->stats) {
+        pufferfish_stats_destroy(object->stats);
+    }
+    if (object->snapshot) {
+        pufferfish_snapshot_release(object->snapshot);
+    }
+    *object = (struct pufferfish_string_pool) {0};
+    return true;
+}
+
+/**
+ * @brief Get matching string strong reference.
+ * @param [in] object map instance.
+ * @param [in] key of reference to retrieve.
+ * @param [out] out receive strong string reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string was not
+ * found in string pool.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve the strong reference from string pool.
+ */
+static bool get(const struct seahorse_red_black_tree_map_s_wr *const object,
+                const struct sea_turtle_string *const key,
+                struct triggerfish_strong **const out) {
+    assert(object);
+    assert(key);
+    assert(out);
+    const struct triggerfish_weak *weak;
+    if (seahorse_red_black_tree_map_s_wr_get(object, key, &weak)) {
+        if (triggerfish_weak_strong(weak, out)) {
+            return true;
+        }
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+    } else if (SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
+               == seahorse_error) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    } else {
+        seagrass_required_true(
+                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_KEY_NOT_FOUND
+                == seahorse_error);
+    }
+    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND;
+    return false;
+}
+
+/**
+ * @brief Add string to the red-black tree while holding the write lock.
+ * @param [in] object string pool instance.
+ * @param [in] hash of string as calculated by pufferfish_hash().
+ * @param [in] string to be added.
+ * @param [out] out strong reference of added string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to update the memory pool.
+ */
+static bool tree_insert(struct pufferfish_string_pool *const object,
+                        const uintmax_t hash,
+                        const struct sea_turtle_string *const string,
+                        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
+    if (seahorse_red_black_tree_map_s_wr_get_entry(&object->map,
+                                                   string,
+                                                   &entry)) {
+        const struct triggerfish_weak *weak;
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_get_value(
+                &object->map, entry, &weak));
+        if (triggerfish_weak_strong(weak, out)) {
+            stats_add(object, PUFFERFISH_STATS_HITS, 1);
+            return true;
+        }
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_remove_entry(
+                &object->map, entry));
+    } else if (SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
+               == seahorse_error) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    /* queued entries must outlive their death until the queue is drained */
+    const bool deferred = object->flags
+                          & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM;
+    if (deferred && !owned_reserve(object)) {
+        return false;
+    }
+    struct pufferfish_string_pool_entry *added;
+    struct triggerfish_strong *strong;
+    if (!entry_create(object, deferred ? object->arena : NULL, string, hash,
+                      &added, &strong)) {
+        return false;
+    }
+    /* the map keeps its own copy of the weak reference */
+    struct triggerfish_weak *const weak = added->weak;
+    const bool result = seahorse_red_black_tree_map_s_wr_add(
+            &object->map, string, weak);
+    if (!result) {
+        seagrass_required_true(
+                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MEMORY_ALLOCATION_FAILED
+                == seahorse_error);
+        seagrass_required_true(triggerfish_strong_release(strong));
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+    } else {
+        stats_add(object, PUFFERFISH_STATS_MISSES, 1);
+        *out = strong;
+    }
+    if (result && deferred) {
+        /* detaching the entry destroys its weak reference */
+        entry_attach(added, attach_state(object));
+        owned_add(object, added);
+    } else {
+        seagrass_required_true(triggerfish_weak_destroy(weak));
+    }
+    return result;
+}
+
+/**
+ * @brief Add string to string pool while holding the write lock.
+ * @param [in] object string pool instance.
+ * @param [in] string to be added.
+ * @param [out] out strong reference of added string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to update the memory pool.
+ */
+static bool insert(struct pufferfish_string_pool *const object,
+                   const struct sea_turtle_string *const string,
+                   struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    /* every entry carries its hash so that it can be read from its strong
+     * references */
+    uintmax_t hash;
+    pufferfish_hash(string->data, string->size, &hash);
+    return tree_insert(object, hash, string, out);
+}
+
+/**
+ * @brief Add string to string pool.
+ * @param [in] object string pool instance.
+ * @param [in] string to be added.
+ * @param [out] out strong reference of added string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to update the memory pool.
+ */
+static bool add(struct pufferfish_string_pool *const object,
+                const struct sea_turtle_string *const string,
+                struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    stats_add(object, PUFFERFISH_STATS_UPGRADES, 1);
+    /* acquire write lock and recheck state */
+    lock_write(object);
+    return insert(object, string, out);
+}
+
+/**
+ * @brief Remove dead entries in a range of slots of the hash table.
+ * @param [in] object string pool instance.
+ * @param [in] table hash table instance.
+ * @param [in] begin first slot to examine.
+ * @param [in] end one past the last slot to examine.
+ */
+static void table_sweep(struct pufferfish_string_pool *const object,
+                        struct pufferfish_string_pool_table *const table,
+                        const uintmax_t begin,
+                        const uintmax_t end) {
+    assert(object);
+    assert(table);
+    assert(end <= table->length);
+    for (uintmax_t i = begin; i < end; i++) {
+        struct pufferfish_string_pool_slot *const slot = &table->slots[i];
+        struct pufferfish_string_pool_entry *const entry
+                = atomic_load_explicit(&slot->entry, memory_order_relaxed);
+        if (!entry || &tombstone == entry) {
+            continue;
+        }
+        /* queued entries are left to draining the queue */
+        const unsigned int state = atomic_load_explicit(&entry->state,
+                                                        memory_order_acquire);
+        if (!(state & PUFFERFISH_STRING_POOL_ENTRY_DEAD)
+            || (state & PUFFERFISH_STRING_POOL_ENTRY_DEFERRED)) {
+            continue;
+        }
+        table_remove(object, slot, entry);
+        retire_entry(object, entry);
+    }
+}
+
+/**
+ * @brief Remove all dead entries from hash table.
+ * @param [in] object string pool instance.
+ */
+static void table_shrink(struct pufferfish_string_pool *const object) {
+    assert(object);
+    struct pufferfish_string_pool_table *const table = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    if (table) {
+        table_sweep(object, table, 0, table->length);
+        table_compact(object);
+    }
+    object->shrink_cursor = 0;
+    retired_reclaim(object);
+}
+
+/**
+ * @brief Remove dead entries among the next slots of the hash table.
+ * @param [in] object string pool instance.
+ * @param [in] limit maximum number of slots to examine.
+ * @return true if the pass over the hash table has completed.
+ */
+static bool table_shrink_step(struct pufferfish_string_pool *const object,
+                              const uintmax_t limit) {
+    assert(object);
+    assert(limit);
+    struct pufferfish_string_pool_table *const table = atomic_load_explicit(
+            &object->table, memory_order_relaxed);
+    if (!table) {
+        object->shrink_cursor = 0;
+        return true;
+    }
+    /* the hash table may have been resized since the previous step */
+    const uintmax_t begin = object->shrink_cursor < table->length
+            ? object->shrink_cursor : 0;
+    const uintmax_t end = table->length - begin > limit
+            ? begin + limit : table->length;
+    table_sweep(object, table, begin, end);
+    object->shrink_cursor = end;
+    const bool result = end == table->length;
+    if (result) {
+        object->shrink_cursor = 0;
+        table_compact(object);
+    }
+    if (result || object->retired >= PUFFERFISH_STRING_POOL_RETIRED_LIMIT) {
+        retired_reclaim(object);
+    }
+    return result;
+}
+
+/**
+ * @brief Get matching string strong reference from hash table.
+ * <p>Safe to call without holding the lock from inside an epoch protected
+ * read-side critical section.</p>
+ * @param [in] object string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string of reference to retrieve.
+ * @param [out] out receive strong string reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string was not
+ * found in string pool.
+ */
+static bool table_get(const struct pufferfish_string_pool *const object,
+                      const uintmax_t hash,
+                      const struct sea_turtle_string *const string,
+                      struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    struct pufferfish_string_pool_entry *entry;
+    if (table_find(atomic_load_explicit(&object->table, memory_order_acquire),
+                   hash, string, &entry)) {
+        if (triggerfish_weak_strong(entry->weak, out)) {
+            entry_touch(entry);
+            stats_add(object, PUFFERFISH_STATS_HITS, 1);
+            return true;
+        }
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+    }
+    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND;
+    return false;
+}
+
+/**
+ * @brief Add string to hash table while holding the write lock.
+ * @param [in] object string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string to be added.
+ * @param [out] out strong reference of added string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to update the memory pool.
+ */
+static bool table_insert(struct pufferfish_string_pool *const object,
+                         const uintmax_t hash,
+                         const struct sea_turtle_string *const string,
+                         struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    struct pufferfish_string_pool_entry *found;
+    struct pufferfish_string_pool_slot *const slot = table_find(
+            atomic_load_explicit(&object->table, memory_order_relaxed),
+            hash, string, &found);
+    if (slot) {
+        if (triggerfish_weak_strong(found->weak, out)) {
+            entry_touch(found);
+            stats_add(object, PUFFERFISH_STATS_HITS, 1);
+            return true;
+        }
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+    }
+    const bool symbols = object->flags & PUFFERFISH_STRING_POOL_FLAG_SYMBOLS;
+    uint32_t symbol = 0;
+    if (slot) {
+        /* the same string keeps its symbol */
+        symbol = found->symbol;
+    } else if (symbols && !symbol_acquire(object, &symbol)) {
+        return false;
+    }
+    struct pufferfish_string_pool_entry *entry;
+    struct triggerfish_strong *strong;
+    if (!entry_create(object, object->arena, string, hash, &entry, &strong)) {
+        if (!slot && symbols) {
+            symbol_release(object, symbol);
+        }
+        return false;
+    }
+    if (slot) {
+        /* replace the dead entry in place */
+        entry_attach(entry, attach_state(object));
+        if (symbols) {
+            symbol_assign(object, symbol, entry);
+        }
+        atomic_store_explicit(&slot->entry, entry, memory_order_release);
+        index_insert(object, entry);
+        /* a queued entry is retired once it is taken off the queue */
+        if (!(PUFFERFISH_STRING_POOL_ENTRY_DEFERRED
+              & atomic_load_explicit(&found->state, memory_order_relaxed))) {
+            retire_entry(object, found);
+        } else {
+            atomic_fetch_sub_explicit(&object->arena->queued, 1,
+                                      memory_order_relaxed);
+        }
+    } else {
+        const struct pufferfish_string_pool_table *const table
+                = atomic_load_explicit(&object->table, memory_order_relaxed);
+        if ((!table || (table->used + 1) * 4 > table->length * 3)
+            && !table_resize(object, object->count + 1)) {
+            seagrass_required_true(triggerfish_weak_destroy(entry->weak));
+            seagrass_required_true(triggerfish_strong_release(strong));
+            if (symbols) {
+                symbol_release(object, symbol);
+            }
+            return false;
+        }
+        entry_attach(entry, attach_state(object));
+        if (symbols) {
+            symbol_assign(object, symbol, entry);
+        }
+        table_place(atomic_load_explicit(&object->table, memory_order_relaxed),
+                    entry);
+        object->count += 1;
+        index_insert(object, entry);
+    }
+    if (object->budget) {
+        /* held by the string pool so that the string is kept once unused */
+        seagrass_required_true(triggerfish_strong_retain(strong));
+        cache_evict(object);
+    }
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK) {
+        const uintmax_t deaths = atomic_load_explicit(&object->arena->deaths,
+                                                      memory_order_relaxed);
+        if (deaths >= PUFFERFISH_STRING_POOL_RETIRED_LIMIT
+            && deaths >= object->count / 16) {
+            /* queued entries are only removed by draining the queue */
+            (void) (object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM
+                    ? drain_step(object,
+                                 PUFFERFISH_STRING_POOL_AUTO_SHRINK_LIMIT)
+                    : table_shrink_step(
+                            object, PUFFERFISH_STRING_POOL_AUTO_SHRINK_LIMIT));
+        }
+    }
+    if (object->retired >= PUFFERFISH_STRING_POOL_RETIRED_LIMIT) {
+        retired_reclaim(object);
+    }
+    stats_add(object, PUFFERFISH_STATS_MISSES, 1);
+    *out = strong;
+    return true;
+}
+
+/**
+ * @brief Add string to hash table.
+ * @param [in] object string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string to be added.
+ * @param [out] out strong reference of added string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to update the memory pool.
+ */
+static bool table_add(struct pufferfish_string_pool *const object,
+                      const uintmax_t hash,
+                      const struct sea_turtle_string *const string,
+                      struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    stats_add(object, PUFFERFISH_STATS_UPGRADES, 1);
+    /* acquire write lock and recheck state */
+    lock_write(object);
+    return table_insert(object, hash, string, out);
+}
+
+/**
+ * @brief Get matching string strong reference through the calling thread's
+ * cache.
+ * <p>Must be called from inside an epoch protected read-side critical
+ * section. A cached entry is only trusted while the generation of the string
+ * pool is unchanged, every entry is retired after advancing it and reclaimed
+ * only once the readers that could have observed the old generation are
+ * gone.</p>
+ * @param [in] object string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string of reference to retrieve.
+ * @param [out] out receive strong string reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string was not
+ * found in string pool.
+ */
+static bool cache_get(const struct pufferfish_string_pool *const object,
+                      const uintmax_t hash,
+                      const struct sea_turtle_string *const string,
+                      struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    struct pufferfish_thread_cache_slot *const slot
+            = pufferfish_thread_cache_slot(hash);
+    if (!slot) {
+        return table_get(object, hash, string, out);
+    }
+    /* read before probing so an entry retired meanwhile is cached as stale */
+    const uintmax_t generation = atomic_load_explicit(&object->generation,
+                                                      memory_order_acquire);
+    if (object->serial == slot->serial
+        && generation == slot->generation
+        && hash == slot->hash) {
+        struct pufferfish_string_pool_entry *const entry = slot->entry;
+        if (string->size == entry->string.size
+            && pufferfish_chars_equal(string->data, entry->string.data,
+                                      string->size)) {
+            if (triggerfish_weak_strong(entry->weak, out)) {
+                entry_touch(entry);
+                pufferfish_thread_cache_hit();
+                stats_add(object, PUFFERFISH_STATS_HITS, 1);
+                return true;
+            }
+            seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                                   == triggerfish_error);
+        }
+    }
+    pufferfish_thread_cache_miss();
+    struct pufferfish_string_pool_entry *entry;
+    if (table_find(atomic_load_explicit(&object->table, memory_order_acquire),
+                   hash, string, &entry)) {
+        if (triggerfish_weak_strong(entry->weak, out)) {
+            entry_touch(entry);
+            *slot = (struct pufferfish_thread_cache_slot) {
+                    .serial = object->serial,
+                    .generation = generation,
+                    .hash = hash,
+                    .entry = entry
+            };
+            stats_add(object, PUFFERFISH_STATS_HITS, 1);
+            return true;
+        }
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+    }
+    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND;
+    return false;
+}
+
+/**
+ * @brief Get matching string strong reference without taking the lock.
+ * @param [in] object string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string of reference to retrieve.
+ * @param [out] out receive strong string reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string was not
+ * found in string pool.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register the calling thread as a reader.
+ */
+static bool lock_free_get(const struct pufferfish_string_pool *const object,
+                          const uintmax_t hash,
+                          const struct sea_turtle_string *const string,
+                          struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    if (!pufferfish_epoch_enter()) {
+        return false;
+    }
+    const bool result = object->flags & PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE
+                        ? cache_get(object, hash, string, out)
+                        : table_get(object, hash, string, out);
+    pufferfish_epoch_exit();
+    return result;
+}
+
+bool pufferfish_string_pool_get(struct pufferfish_string_pool *const object,
+                                const struct sea_turtle_string *const string,
+                                struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!string) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t hash = 0;
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        pufferfish_hash(string->data, string->size, &hash);
+    }
+    return pufferfish_string_pool_get_with_hash(object, string, hash, out);
+}
+
+bool pufferfish_string_pool_get_with_hash(
+        struct pufferfish_string_pool *const object,
+        const struct sea_turtle_string *const string,
+        const uintmax_t hash,
+        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ) {
+        if (lock_free_get(object, hash, string, out)) {
+            return true;
+        }
+        lock_write(object);
+        const bool result = table_insert(object, hash, string, out);
+        seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+        return result;
+    }
+    if (!lock_read(object)) {
+        return false;
+    }
+    bool result;
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        result = table_get(object, hash, string, out);
+        if (!result) {
+            seagrass_required_true(PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND
+                                   == pufferfish_error);
+            result = table_add(object, hash, string, out);
+        }
+    } else {
+        result = get(&object->map, string, out);
+        if (result) {
+            stats_add(object, PUFFERFISH_STATS_HITS, 1);
+        } else {
+            switch (pufferfish_error) {
+                default: {
+                    seagrass_required_true(false);
+                }
+                case PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED: {
+                    break;
+                }
+                case PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND: {
+                    result = add(object, string, out);
+                }
+            }
+        }
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return result;
+}
+
+/**
+ * @brief Find string in hash table.
+ * @param [in] object string pool instance.
+ * @param [in] hash of string.
+ * @param [in] string of reference to retrieve.
+ * @param [out] out receive strong string reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string was not
+ * found in string pool.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register the calling thread as a reader.
+ */
+static bool table_lookup(struct pufferfish_string_pool *const object,
+                         const uintmax_t hash,
+                         const struct sea_turtle_string *const string,
+                         struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ) {
+        return lock_free_get(object, hash, string, out);
+    }
+    if (!lock_read(object)) {
+        return false;
+    }
+    const bool result = table_get(object, hash, string, out);
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return result;
+}
+
+bool pufferfish_string_pool_find_with_hash(
+        struct pufferfish_string_pool *const object,
+        const struct sea_turtle_string *const string,
+        const uintmax_t hash,
+        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(string);
+    assert(out);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        return table_lookup(object, hash, string, out);
+    }
+    if (!lock_read(object)) {
+        return false;
+    }
+    const bool result = get(&object->map, string, out);
+    if (result) {
+        stats_add(object, PUFFERFISH_STATS_HITS, 1);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return result;
+}
+
+bool pufferfish_string_pool_get_chars(
+        struct pufferfish_string_pool *const object,
+        const char *const chars,
+        const size_t size,
+        const uintmax_t *const hash,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!chars) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    uintmax_t value = 0;
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        if (hash) {
+            value = *hash;
+        } else {
+            pufferfish_hash(chars, size, &value);
+        }
+        /* finding a pooled string only needs its contents */
+        const struct sea_turtle_string view = {
+                .data = (char *) chars,
+                .size = size
+        };
+        if (table_lookup(object, value, &view, out)) {
+            return true;
+        }
+        if (PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND != pufferfish_error) {
+            return false;
+        }
+    }
+    struct sea_turtle_string string;
+    size_t count;
+    if (!sea_turtle_string_init(&string, chars, size, &count)) {
+        pufferfish_error =
+                SEA_TURTLE_STRING_ERROR_MEMORY_ALLOCATION_FAILED
+                == sea_turtle_error
+                ? PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+                : PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED;
+        return false;
+    }
+    const bool result = pufferfish_string_pool_get_with_hash(object, &string,
+                                                             value, out);
+    seagrass_required_true(sea_turtle_string_invalidate(&string));
+    return result;
+}
+
+/**
+ * @brief Hash of string in batch.
+ * @param [in] object string pool instance.
+ * @param [in] strings of batch.
+ * @param [in] hashes of strings or <i>NULL</i> to calculate them.
+ * @param [in] i index of string in batch.
+ * @return hash of string or 0 if not using a hash table.
+ */
+static uintmax_t batch_hash(const struct pufferfish_string_pool *const object,
+                            const struct sea_turtle_string *const *const strings,
+                            const uintmax_t *const hashes,
+                            const uintmax_t i) {
+    assert(object);
+    assert(strings);
+    if (hashes) {
+        return hashes[i];
+    }
+    uintmax_t hash = 0;
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        pufferfish_hash(strings[i]->data, strings[i]->size, &hash);
+    }
+    return hash;
+}
+
+/**
+ * @brief Start loading the first slot probed for hash.
+ * @param [in] table hash table instance or <i>NULL</i>.
+ * @param [in] hash to be probed.
+ */
+static void table_prefetch(const struct pufferfish_string_pool_table *const table,
+                           const uintmax_t hash) {
+#if defined(__GNUC__)
+    if (table) {
+        __builtin_prefetch(&table->slots[hash & (table->length - 1)]);
+    }
+#endif
+}
+
+/**
+ * @brief Release the strong references retrieved so far for a batch.
+ * @param [in] count of strings in batch.
+ * @param [in] out strong references of batch, <i>NULL</i> if not retrieved.
+ */
+static void batch_release(const uintmax_t count,
+                          struct triggerfish_strong **const out) {
+    assert(out);
+    for (uintmax_t i = 0; i < count; i++) {
+        if (out[i]) {
+            seagrass_required_true(triggerfish_strong_release(out[i]));
+            out[i] = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Retrieve the pooled strings of a batch from the hash table.
+ * <p>Hashes are calculated ahead of the lookups and the first slot they probe
+ * is prefetched so that cache misses overlap.</p>
+ * @param [in] object string pool instance.
+ * @param [in] strings of batch.
+ * @param [in] hashes of strings or <i>NULL</i> to calculate them.
+ * @param [in] count of strings in batch.
+ * @param [out] out receive strong references, <i>NULL</i> for misses.
+ * @return number of misses.
+ */
+static uintmax_t table_get_many(
+        const struct pufferfish_string_pool *const object,
+        const struct sea_turtle_string *const *const strings,
+        const uintmax_t *const hashes,
+        const uintmax_t count,
+        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(strings);
+    assert(out);
+    const struct pufferfish_string_pool_table *const table
+            = atomic_load_explicit(&object->table, memory_order_acquire);
+    uintmax_t ahead[PUFFERFISH_STRING_POOL_PREFETCH_DISTANCE];
+    for (uintmax_t i = 0;
+         i < count && i < PUFFERFISH_STRING_POOL_PREFETCH_DISTANCE; i++) {
+        ahead[i] = batch_hash(object, strings, hashes, i);
+        table_prefetch(table, ahead[i]);
+    }
+    uintmax_t misses = 0;
+    for (uintmax_t i = 0; i < count; i++) {
+        const uintmax_t slot = i % PUFFERFISH_STRING_POOL_PREFETCH_DISTANCE;
+        const uintmax_t hash = ahead[slot];
+        const uintmax_t next = i + PUFFERFISH_STRING_POOL_PREFETCH_DISTANCE;
+        if (next < count) {
+            ahead[slot] = batch_hash(object, strings, hashes, next);
+            table_prefetch(table, ahead[slot]);
+        }
+        if (!table_get(object, hash, strings[i], &out[i])) {
+            out[i] = NULL;
+            misses += 1;
+        }
+    }
+    return misses;
+}
+
+/**
+ * @brief Retrieve the pooled strings of a batch from the red-black tree.
+ * @param [in] object string pool instance.
+ * @param [in] strings of batch.
+ * @param [in] count of strings in batch.
+ * @param [out] out receive strong references, <i>NULL</i> for misses.
+ * @param [out] misses receive number of misses.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve pooled string instance.
+ */
+static bool get_many(const struct pufferfish_string_pool *const object,
+                     const struct sea_turtle_string *const *const strings,
+                     const uintmax_t count,
+                     struct triggerfish_strong **const out,
+                     uintmax_t *const misses) {
+    assert(object);
+    assert(strings);
+    assert(out);
+    assert(misses);
+    *misses = 0;
+    for (uintmax_t i = 0; i < count; i++) {
+        if (get(&object->map, strings[i], &out[i])) {
+            stats_add(object, PUFFERFISH_STATS_HITS, 1);
+            continue;
+        }
+        out[i] = NULL;
+        if (PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+            == pufferfish_error) {
+            batch_release(i, out);
+            return false;
+        }
+        seagrass_required_true(PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND
+                               == pufferfish_error);
+        *misses += 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Add the misses of a batch while holding the write lock.
+ * @param [in] object string pool instance.
+ * @param [in] strings of batch.
+ * @param [in] hashes of strings or <i>NULL</i> to calculate them.
+ * @param [in] count of strings in batch.
+ * @param [in,out] out strong references, misses are <i>NULL</i>.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to update the memory pool.
+ */
+static bool insert_many(struct pufferfish_string_pool *const object,
+                        const struct sea_turtle_string *const *const strings,
+                        const uintmax_t *const hashes,
+                        const uintmax_t count,
+                        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(strings);
+    assert(out);
+    for (uintmax_t i = 0; i < count; i++) {
+        if (out[i]) {
+            continue;
+        }
+        const bool result = object->flags
+                            & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                ? table_insert(object,
+                               batch_hash(object, strings, hashes, i),
+                               strings[i], &out[i])
+                : insert(object, strings[i], &out[i]);
+        if (!result) {
+            seagrass_required_true(
+                    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+                    == pufferfish_error);
+            batch_release(count, out);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pufferfish_string_pool_get_many(
+        struct pufferfish_string_pool *const object,
+        const struct sea_turtle_string *const *const strings,
+        const uintmax_t count,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!strings) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    for (uintmax_t i = 0; i < count; i++) {
+        if (!strings[i]) {
+            pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+            return false;
+        }
+    }
+    return pufferfish_string_pool_get_many_with_hashes(object, strings, NULL,
+                                                       count, out);
+}
+
+bool pufferfish_string_pool_get_many_with_hashes(
+        struct pufferfish_string_pool *const object,
+        const struct sea_turtle_string *const *const strings,
+        const uintmax_t *const hashes,
+        const uintmax_t count,
+        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(strings);
+    assert(out);
+    if (!count) {
+        return true;
+    }
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ) {
+        if (!pufferfish_epoch_enter()) {
+            return false;
+        }
+        const uintmax_t misses = table_get_many(object, strings, hashes,
+                                                count, out);
+        pufferfish_epoch_exit();
+        if (!misses) {
+            return true;
+        }
+        lock_write(object);
+        const bool result = insert_many(object, strings, hashes, count, out);
+        seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+        return result;
+    }
+    if (!lock_read(object)) {
+        return false;
+    }
+    uintmax_t misses;
+    bool result = true;
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        misses = table_get_many(object, strings, hashes, count, out);
+    } else {
+        result = get_many(object, strings, count, out, &misses);
+    }
+    if (result && misses) {
+        seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+        stats_add(object, PUFFERFISH_STATS_UPGRADES, 1);
+        /* all misses are added under a single write lock acquisition */
+        lock_write(object);
+        result = insert_many(object, strings, hashes, count, out);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return result;
+}
+
+/* work of one thread of a bulk load */
+struct pufferfish_string_pool_load {
+    const struct sea_turtle_string *const *strings;
+    /* lines of a file that are validated into strings in place or NULL */
+    struct sea_turtle_string *lines;
+    uintmax_t *hashes;
+    /* index of the first string that is equal to each string */
+    uintmax_t *first;
+    uintmax_t count;
+    uintmax_t threads;
+    uintmax_t part;
+    /* number of strings this thread has hashed into each partition */
+    uintmax_t *sizes;
+    /* distinct strings of the partition as their index + 1 */
+    uintmax_t *set;
+    uintmax_t length;
+    /* end of the lines of the part that have been validated */
+    uintmax_t validated;
+    uintmax_t error;
+    pthread_t thread;
+    bool started;
+};
+
+/**
+ * @brief First string of a part of a bulk load.
+ * @param [in] load work of any thread of the bulk load.
+ * @param [in] part index of part, the number of threads for the end.
+ * @return index of the first string of part.
+ */
+static uintmax_t load_begin(const struct pufferfish_string_pool_load *const load,
+                            const uintmax_t part) {
+    assert(load);
+    return load->count * part / load->threads;
+}
+
+/**
+ * @brief Partition of a bulk load whose thread deduplicates hash.
+ * @param [in] load work of any thread of the bulk load.
+ * @param [in] hash of string.
+ * @return index of partition.
+ */
+static uintmax_t load_partition(
+        const struct pufferfish_string_pool_load *const load,
+        const uintmax_t hash) {
+    assert(load);
+    /* the low bits are left to the probes of the set */
+    return (hash >> 32) % load->threads;
+}
+
+/**
+ * @brief Validate and hash the strings of a part of a bulk load.
+ * @param [in] argument work of thread.
+ * @return <i>NULL</i>.
+ */
+static void *load_hash(void *const argument) {
+    struct pufferfish_string_pool_load *const load = argument;
+    assert(load);
+    const uintmax_t end = load_begin(load, load->part + 1);
+    for (uintmax_t i = load_begin(load, load->part); i < end; i++) {
+        if (load->lines) {
+            struct sea_turtle_string string;
+            size_t count;
+            if (!sea_turtle_string_init(&string, load->lines[i].data,
+                                        load->lines[i].size, &count)) {
+                load->error =
+                        SEA_TURTLE_STRING_ERROR_MEMORY_ALLOCATION_FAILED
+                        == sea_turtle_error
+                        ? PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+                        : PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED;
+                break;
+            }
+            load->lines[i] = string;
+            load->validated = i + 1;
+        }
+        pufferfish_hash(load->strings[i]->data, load->strings[i]->size,
+                        &load->hashes[i]);
+        load->sizes[load_partition(load, load->hashes[i])] += 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find the first of the equal strings of a partition of a bulk load.
+ * @param [in] argument work of thread.
+ * @return <i>NULL</i>.
+ */
+static void *load_dedup(void *const argument) {
+    struct pufferfish_string_pool_load *const load = argument;
+    assert(load);
+    const uintmax_t mask = load->length - 1;
+    for (uintmax_t i = 0; i < load->count; i++) {
+        const uintmax_t hash = load->hashes[i];
+        if (load->part != load_partition(load, hash)) {
+            continue;
+        }
+        const struct sea_turtle_string *const string = load->strings[i];
+        load->first[i] = i;
+        uintmax_t j = hash & mask;
+        for (; load->set[j]; j = (j + 1) & mask) {
+            const uintmax_t k = load->set[j] - 1;
+            if (hash == load->hashes[k]
+                && string->size == load->strings[k]->size
+                && pufferfish_chars_equal(string->data,
+                                          load->strings[k]->data,
+                                          string->size)) {
+                load->first[i] = k;
+                break;
+            }
+        }
+        if (i == load->first[i]) {
+            load->set[j] = i + 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run routine for every part of a bulk load.
+ * <p>The first part runs on the calling thread, as does any part whose thread
+ * could not be started.</p>
+ * @param [in] loads work of the threads of the bulk load.
+ * @param [in] routine to be run.
+ */
+static void load_run(struct pufferfish_string_pool_load *const loads,
+                     void *(*const routine)(void *)) {
+    assert(loads);
+    assert(routine);
+    for (uintmax_t i = 1; i < loads->threads; i++) {
+        loads[i].started = !pthread_create(&loads[i].thread, NULL, routine,
+                                           &loads[i]);
+        if (!loads[i].started) {
+            routine(&loads[i]);
+        }
+    }
+    routine(loads);
+    for (uintmax_t i = 1; i < loads->threads; i++) {
+        if (loads[i].started) {
+            seagrass_required_true(!pthread_join(loads[i].thread, NULL));
+        }
+    }
+}
+
+/**
+ * @brief Hash the strings of a bulk load and find the first of equal strings.
+ * <p>Strings are hashed in contiguous parts and then deduplicated in
+ * partitions by hash, one part and one partition per thread, so that no
+ * thread waits for another.</p>
+ * @param [in] loads work of the threads of the bulk load.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to deduplicate the strings.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED if a line does not
+ * form a valid string.
+ */
+static bool load_index(struct pufferfish_string_pool_load *const loads) {
+    assert(loads);
+    const uintmax_t threads = loads->threads;
+    load_run(loads, load_hash);
+    for (uintmax_t i = 0; i < threads; i++) {
+        if (loads[i].error) {
+            pufferfish_error = loads[i].error;
+            return false;
+        }
+    }
+    /* sets are allocated up front so that the threads do not allocate */
+    uintmax_t total = 0;
+    for (uintmax_t i = 0; i < threads; i++) {
+        uintmax_t size = 0;
+        for (uintmax_t j = 0; j < threads; j++) {
+            size += loads[j].sizes[i];
+        }
+        uintmax_t length = PUFFERFISH_STRING_POOL_TABLE_MINIMUM_LENGTH;
+        while (length / 2 < size) {
+            length <<= 1;
+        }
+        loads[i].length = length;
+        total += length;
+    }
+    uintmax_t *const sets = calloc(total, sizeof(*sets));
+    if (!sets) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    for (uintmax_t i = 0, offset = 0; i < threads; i++) {
+        loads[i].set = sets + offset;
+        offset += loads[i].length;
+    }
+    load_run(loads, load_dedup);
+    free(sets);
+    return true;
+}
+
+/**
+ * @brief Prepare the work of the threads of a bulk load.
+ * @param [in] strings to be loaded.
+ * @param [in] lines to be validated into strings or <i>NULL</i>.
+ * @param [in] count of strings.
+ * @param [in] threads to load with at most.
+ * @param [out] out receive work of the threads, the first element holding
+ * the hashes.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to prepare the bulk load.
+ */
+static bool load_init(const struct sea_turtle_string *const *const strings,
+                      struct sea_turtle_string *const lines,
+                      const uintmax_t count,
+                      uintmax_t threads,
+                      struct pufferfish_string_pool_load **const out) {
+    assert(strings);
+    assert(out);
+    /* small loads are not worth starting threads for */
+    if (threads > count / PUFFERFISH_STRING_POOL_LOAD_MINIMUM) {
+        threads = count / PUFFERFISH_STRING_POOL_LOAD_MINIMUM;
+    }
+    if (!threads) {
+        threads = 1;
+    }
+    struct pufferfish_string_pool_load *const loads = calloc(threads,
+                                                             sizeof(*loads));
+    uintmax_t *const sizes = calloc(threads * threads, sizeof(*sizes));
+    uintmax_t *const hashes = malloc((count ? count : 1) * 2
+                                     * sizeof(*hashes));
+    if (!loads || !sizes || !hashes) {
+        free(loads);
+        free(sizes);
+        free(hashes);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    for (uintmax_t i = 0; i < threads; i++) {
+        loads[i] = (struct pufferfish_string_pool_load) {
+                .strings = strings,
+                .lines = lines,
+                .hashes = hashes,
+                .first = hashes + count,
+                .count = count,
+                .threads = threads,
+                .part = i,
+                .sizes = sizes + i * threads
+        };
+        loads[i].validated = load_begin(&loads[i], i);
+    }
+    *out = loads;
+    return true;
+}
+
+/**
+ * @brief Release the work of the threads of a bulk load.
+ * <p>Lines that have been validated into strings are invalidated.</p>
+ * @param [in] loads work of the threads.
+ */
+static void load_invalidate(struct pufferfish_string_pool_load *const loads) {
+    assert(loads);
+    for (uintmax_t i = 0; loads->lines && i < loads->threads; i++) {
+        for (uintmax_t j = load_begin(loads, i); j < loads[i].validated; j++) {
+            seagrass_required_true(sea_turtle_string_invalidate(
+                    &loads->lines[j]));
+        }
+    }
+    free(loads->sizes);
+    free(loads->hashes);
+    free(loads);
+}
+
+/**
+ * @brief Add the deduplicated strings of a bulk load to the string pool.
+ * <p>The write lock is taken once and a hash table is grown once to hold all
+ * distinct strings, so that none of them causes it to be rebuilt.</p>
+ * @param [in] object string pool instance.
+ * @param [in] loads work of the threads of the bulk load.
+ * @param [in] duplicates whether strings that are equal to an earlier one
+ * receive a strong reference as well.
+ * @param [out] out receive strong references of strings in pool, elements of
+ * duplicates are left untouched unless they receive one.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to add the strings.
+ */
+static bool load_insert(struct pufferfish_string_pool *const object,
+                        const struct pufferfish_string_pool_load *const loads,
+                        const bool duplicates,
+                        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(loads);
+    assert(out);
+    const uintmax_t count = loads->count;
+    uintmax_t distinct = 0;
+    for (uintmax_t i = 0; i < count; i++) {
+        distinct += i == loads->first[i];
+    }
+    const bool hashed = object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE;
+    lock_write(object);
+    bool result = true;
+    if (hashed) {
+        const struct pufferfish_string_pool_table *const table
+                = atomic_load_explicit(&object->table, memory_order_relaxed);
+        if (distinct && (!table
+                         || (table->used + distinct) * 4 > table->length * 3)) {
+            result = table_resize(object, object->count + distinct);
+        }
+    }
+    uintmax_t i = 0;
+    for (; result && i < count; i++) {
+        const uintmax_t first = loads->first[i];
+        if (i != first) {
+            if (duplicates) {
+                seagrass_required_true(triggerfish_strong_retain(out[first]));
+                out[i] = out[first];
+            }
+            continue;
+        }
+        result = hashed
+                ? table_insert(object, loads->hashes[i], loads->strings[i],
+                               &out[i])
+                : tree_insert(object, loads->hashes[i], loads->strings[i],
+                              &out[i]);
+    }
+    if (result && duplicates) {
+        stats_add(object, PUFFERFISH_STATS_HITS, count - distinct);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
     if (!result) {
-        switch (pufferfish_error) {
-            default: {
-                seagrass_required_true(false);
+        seagrass_required_true(
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+                == pufferfish_error);
+        /* the string that failed is the last one examined */
+        for (uintmax_t j = 0; j + 1 < i; j++) {
+            if (duplicates || j == loads->first[j]) {
+                seagrass_required_true(triggerfish_strong_release(out[j]));
+            }
+        }
+    }
+    return result;
+}
+
+bool pufferfish_string_pool_load(
+        struct pufferfish_string_pool *const object,
+        const struct sea_turtle_string *const *const strings,
+        const uintmax_t count,
+        const uintmax_t threads,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!strings) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    if (!threads) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO;
+        return false;
+    }
+    for (uintmax_t i = 0; i < count; i++) {
+        if (!strings[i]) {
+            pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+            return false;
+        }
+    }
+    if (!count) {
+        return true;
+    }
+    struct pufferfish_string_pool_load *loads;
+    if (!load_init(strings, NULL, count, threads, &loads)) {
+        return false;
+    }
+    const bool result = load_index(loads)
+                        && load_insert(object, loads, true, out);
+    load_invalidate(loads);
+    return result;
+}
+
+/**
+ * @brief Read the contents of a file.
+ * @param [in] path of file.
+ * @param [out] out receive contents, followed by a terminating null byte.
+ * @param [out] size receive size of contents in bytes.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to hold the contents.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_IO_FAILED if the file could not be
+ * read.
+ */
+static bool load_read(const char *const path, char **const out,
+                      size_t *const size) {
+    assert(path);
+    assert(out);
+    assert(size);
+    FILE *const file = fopen(path, "rb");
+    if (!file) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_IO_FAILED;
+        return false;
+    }
+    long end;
+    if (fseek(file, 0, SEEK_END)
+        || 0 > (end = ftell(file))
+        || fseek(file, 0, SEEK_SET)) {
+        fclose(file);
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_IO_FAILED;
+        return false;
+    }
+    char *const chars = malloc((size_t) end + 1);
+    if (!chars) {
+        fclose(file);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    const bool result = (size_t) end == fread(chars, 1, (size_t) end, file);
+    if (fclose(file) || !result) {
+        free(chars);
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_IO_FAILED;
+        return false;
+    }
+    chars[end] = '\0';
+    *out = chars;
+    *size = (size_t) end;
+    return true;
+}
+
+bool pufferfish_string_pool_load_file(
+        struct pufferfish_string_pool *const object,
+        const char *const path,
+        const uintmax_t threads,
+        struct triggerfish_strong ***const out,
+        uintmax_t *const count) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!path) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL;
+        return false;
+    }
+    if (!out || !count) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    if (!threads) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO;
+        return false;
+    }
+    char *chars;
+    size_t size;
+    if (!load_read(path, &chars, &size)) {
+        return false;
+    }
+    /* a final newline does not start another line */
+    uintmax_t length = 0;
+    for (const char *at = chars, *const end = chars + size; at < end;
+         length++) {
+        const char *const newline = memchr(at, '\n', end - at);
+        at = newline ? newline + 1 : end;
+    }
+    const uintmax_t item = sizeof(struct sea_turtle_string)
+                           + sizeof(struct sea_turtle_string *)
+                           + sizeof(struct triggerfish_strong *);
+    struct sea_turtle_string *const lines = malloc(
+            (length ? length : 1) * item);
+    if (!lines) {
+        free(chars);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    const struct sea_turtle_string **const strings
+            = (const struct sea_turtle_string **) (lines + length);
+    struct triggerfish_strong **const strongs
+            = (struct triggerfish_strong **) (strings + length);
+    for (uintmax_t i = 0, offset = 0; i < length; i++) {
+        const char *const newline = memchr(chars + offset, '\n',
+                                           size - offset);
+        const size_t line = newline
+                ? (size_t) (newline - chars) - offset
+                : size - offset;
+        /* a view into the file until it is validated */
+        lines[i] = (struct sea_turtle_string) {
+                .data = chars + offset,
+                .size = line
+        };
+        strings[i] = &lines[i];
+        offset += line + 1;
+    }
+    struct pufferfish_string_pool_load *loads;
+    if (!load_init(strings, lines, length, threads, &loads)) {
+        free(lines);
+        free(chars);
+        return false;
+    }
+    bool result = load_index(loads);
+    free(chars);
+    struct triggerfish_strong **distinct = NULL;
+    uintmax_t j = 0;
+    if (result && (result = load_insert(object, loads, false, strongs))) {
+        distinct = malloc((length ? length : 1) * sizeof(*distinct));
+        for (uintmax_t i = 0; distinct && i < length; i++) {
+            if (i == loads->first[i]) {
+                distinct[j++] = strongs[i];
+            }
+        }
+        if (!distinct) {
+            for (uintmax_t i = 0; i < length; i++) {
+                if (i == loads->first[i]) {
+                    seagrass_required_true(triggerfish_strong_release(
+                            strongs[i]));
+                }
+            }
+            pufferfish_error =
+                    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            result = false;
+        }
+    }
+    load_invalidate(loads);
+    free(lines);
+    if (result) {
+        *out = distinct;
+        *count = j;
+    }
+    return result;
+}
+
+bool pufferfish_string_pool_symbol(struct pufferfish_string_pool *const object,
+                                   struct triggerfish_strong *const string,
+                                   uint32_t *const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!string) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_SYMBOLS)) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED;
+        return false;
+    }
+    /* only the header is shared by entries of static string pools */
+    const struct pufferfish_string_pool_entry_header *header;
+    seagrass_required_true(triggerfish_strong_instance(string,
+                                                       (void **) &header));
+    /* entries are carved from the arena of their string pool */
+    if (!header->arena || header->arena != object->arena) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_FOREIGN;
+        return false;
+    }
+    *out = ((const struct pufferfish_string_pool_entry *) header)->symbol;
+    return true;
+}
+
+/**
+ * @brief Get strong reference of the entry symbol stands for.
+ * <p>Safe to call without holding the lock from inside an epoch protected
+ * read-side critical section.</p>
+ * @param [in] object string pool instance.
+ * @param [in] symbol of string.
+ * @param [out] out receive strong string reference.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID if symbol does not
+ * stand for a string in the string pool.
+ */
+static bool symbol_get(const struct pufferfish_string_pool *const object,
+                       const uint32_t symbol,
+                       struct triggerfish_strong **const out) {
+    assert(object);
+    assert(out);
+    const struct pufferfish_string_pool_symbols *const symbols
+            = atomic_load_explicit(&object->symbols, memory_order_acquire);
+    if (symbols && symbol < symbols->length) {
+        /* slots past the used ones are zero */
+        const uintptr_t value = atomic_load_explicit(
+                &symbols->entries[symbol], memory_order_acquire);
+        const struct pufferfish_string_pool_entry *const entry
+                = (const void *) value;
+        if (entry && !(value & PUFFERFISH_STRING_POOL_SYMBOL_FREE)) {
+            if (triggerfish_weak_strong(entry->weak, out)) {
+                return true;
+            }
+            seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                                   == triggerfish_error);
+        }
+    }
+    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID;
+    return false;
+}
+
+bool pufferfish_string_pool_resolve(struct pufferfish_string_pool *const object,
+                                    const uint32_t symbol,
+                                    struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_SYMBOLS)) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED;
+        return false;
+    }
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ) {
+        if (!pufferfish_epoch_enter()) {
+            return false;
+        }
+        const bool result = symbol_get(object, symbol, out);
+        pufferfish_epoch_exit();
+        return result;
+    }
+    if (!lock_read(object)) {
+        return false;
+    }
+    const bool result = symbol_get(object, symbol, out);
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return result;
+}
+
+bool pufferfish_string_pool_header(
+        const struct triggerfish_strong *const string,
+        struct pufferfish_string_pool_header *const out) {
+    if (!string) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    /* static string pool entries share the leading fields */
+    const struct pufferfish_string_pool_entry_header *header;
+    seagrass_required_true(triggerfish_strong_instance(string,
+                                                       (void **) &header));
+    *out = (struct pufferfish_string_pool_header) {
+            .string = &header->string,
+            .hash = header->hash,
+            .size = header->string.size
+    };
+    return true;
+}
+
+bool pufferfish_string_pool_same(const struct triggerfish_strong *const a,
+                                 const struct triggerfish_strong *const b,
+                                 bool *const out) {
+    if (!a || !b) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    /* the weak reference of an entry always yields the same strong one */
+    *out = a == b;
+    return true;
+}
+
+bool pufferfish_string_pool_shrink(
+        struct pufferfish_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    lock_write(object);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM) {
+        (void) drain_step(object, UINTMAX_MAX);
+    }
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        table_shrink(object);
+        seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+        return true;
+    }
+    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
+    if (seahorse_red_black_tree_map_s_wr_first_entry(&object->map, &entry)) {
+        const struct triggerfish_weak *weak;
+        do {
+            seagrass_required_true(
+                    seahorse_red_black_tree_map_s_wr_entry_get_value(
+                            &object->map, entry, &weak));
+            struct triggerfish_strong *strong;
+            if (triggerfish_weak_strong(weak, &strong)) {
+                seagrass_required_true(triggerfish_strong_release(strong));
+                if (!seahorse_red_black_tree_map_s_wr_next_entry(entry,
+                                                                 &entry)) {
+                    seagrass_required_true(
+                            SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
+                            == seahorse_error);
+                    break;
+                }
+                continue;
             }
-            case PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED: {
+            seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                                   == triggerfish_error);
+            const struct seahorse_red_black_tree_map_s_wr_entry *next;
+            const bool result = seahorse_red_black_tree_map_s_wr_next_entry(
+                    entry, &next);
+            if (!result) {
+                seagrass_required_true(
+                        SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
+                        == seahorse_error);
+            }
+            seagrass_required_true(
+                    seahorse_red_black_tree_map_s_wr_remove_entry(
+                            &object->map, entry));
+            if (result) {
+                entry = next;
+            } else {
                 break;
             }
-            case PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND: {
-                result = add(object, string, out);
+        } while (true);
+    } else {
+        seagrass_required_true(
+                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MAP_IS_EMPTY
+                == seahorse_error);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return true;
+}
+
+/**
+ * @brief Set the entry the next shrink step of the red-black tree resumes
+ * after.
+ * @param [in] object string pool instance.
+ * @param [in] strong reference of entry or <i>NULL</i> to start over.
+ */
+static void shrink_cursor_set(struct pufferfish_string_pool *const object,
+                              struct triggerfish_strong *const strong) {
+    assert(object);
+    if (object->shrink_cursor_string) {
+        seagrass_required_true(triggerfish_strong_release(
+                object->shrink_cursor_string));
+    }
+    object->shrink_cursor_string = strong;
+}
+
+/**
+ * @brief Remove dead entries among the next entries of the red-black tree.
+ * <p>The last live entry examined is kept alive to resume after it.</p>
+ * @param [in] object string pool instance.
+ * @param [in] limit maximum number of entries to examine.
+ * @return true if the pass over the red-black tree has completed.
+ */
+static bool shrink_step(struct pufferfish_string_pool *const object,
+                        const uintmax_t limit) {
+    assert(object);
+    assert(limit);
+    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
+    bool result;
+    if (object->shrink_cursor_string) {
+        const struct sea_turtle_string *key;
+        seagrass_required_true(triggerfish_strong_instance(
+                object->shrink_cursor_string, (void **) &key));
+        result = seahorse_red_black_tree_map_s_wr_higher_entry(
+                &object->map, key, &entry);
+        if (!result) {
+            seagrass_required_true(
+                    SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_ENTRY_NOT_FOUND
+                    == seahorse_error);
+        }
+    } else {
+        result = seahorse_red_black_tree_map_s_wr_first_entry(&object->map,
+                                                              &entry);
+        if (!result) {
+            seagrass_required_true(
+                    SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MAP_IS_EMPTY
+                    == seahorse_error);
+        }
+    }
+    for (uintmax_t i = 0; result && i < limit; i++) {
+        const struct triggerfish_weak *weak;
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_get_value(
+                &object->map, entry, &weak));
+        struct triggerfish_strong *strong;
+        const bool alive = triggerfish_weak_strong(weak, &strong);
+        if (alive) {
+            shrink_cursor_set(object, strong);
+        } else {
+            seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                                   == triggerfish_error);
+        }
+        const struct seahorse_red_black_tree_map_s_wr_entry *next;
+        result = seahorse_red_black_tree_map_s_wr_next_entry(entry, &next);
+        if (!result) {
+            seagrass_required_true(
+                    SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
+                    == seahorse_error);
+        }
+        if (!alive) {
+            seagrass_required_true(
+                    seahorse_red_black_tree_map_s_wr_remove_entry(
+                            &object->map, entry));
+        }
+        entry = next;
+    }
+    if (result) {
+        return false;
+    }
+    shrink_cursor_set(object, NULL);
+    return true;
+}
+
+bool pufferfish_string_pool_shrink_step(
+        struct pufferfish_string_pool *const object,
+        const uintmax_t limit,
+        bool *const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!limit) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    lock_write(object);
+    *out = object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+            ? table_shrink_step(object, limit)
+            : shrink_step(object, limit);
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return true;
+}
+
+bool pufferfish_string_pool_drain(struct pufferfish_string_pool *const object,
+                                  const uintmax_t limit,
+                                  bool *const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!limit) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM)) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED;
+        return false;
+    }
+    lock_write(object);
+    *out = drain_step(object, limit);
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return true;
+}
+
+bool pufferfish_string_pool_reclaimer_start(
+        struct pufferfish_string_pool *const object,
+        const uintmax_t period) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!period) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_PERIOD_IS_ZERO;
+        return false;
+    }
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM)) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED;
+        return false;
+    }
+    lock_write(object);
+    bool result;
+    if (object->reclaimer) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_RUNNING;
+        result = false;
+    } else {
+        result = reclaimer_of(object, period, &object->reclaimer);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return result;
+}
+
+bool pufferfish_string_pool_reclaimer_stop(
+        struct pufferfish_string_pool *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    lock_write(object);
+    struct pufferfish_string_pool_reclaimer *const reclaimer
+            = object->reclaimer;
+    object->reclaimer = NULL;
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    if (!reclaimer) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_STOPPED;
+        return false;
+    }
+    /* the reclaimer takes the lock so it is stopped without holding it */
+    reclaimer_stop(reclaimer);
+    return true;
+}
+
+bool pufferfish_string_pool_set_budget(
+        struct pufferfish_string_pool *const object,
+        const uintmax_t budget) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE)) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_HASH_TABLE_IS_DISABLED;
+        return false;
+    }
+    lock_write(object);
+    object->budget = budget;
+    if (!budget) {
+        cache_clear(object);
+        if (object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM) {
+            (void) drain_step(object, UINTMAX_MAX);
+        }
+        table_shrink(object);
+    } else {
+        /* strings in use are kept once unused like those added from now on */
+        const struct pufferfish_string_pool_table *const table
+                = atomic_load_explicit(&object->table, memory_order_relaxed);
+        for (uintmax_t i = 0; table && i < table->length; i++) {
+            struct pufferfish_string_pool_entry *const entry
+                    = atomic_load_explicit(&table->slots[i].entry,
+                                           memory_order_relaxed);
+            if (entry && &tombstone != entry) {
+                cache_hold(entry);
+            }
+        }
+        cache_evict(object);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    return true;
+}
+
+bool pufferfish_string_pool_thread_cache_counters(uintmax_t *const hits,
+                                                  uintmax_t *const misses) {
+    if (!hits || !misses) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    pufferfish_thread_cache_counters(hits, misses);
+    return true;
+}
+
+bool pufferfish_string_pool_thread_lock_waits(uintmax_t *const waits,
+                                              uintmax_t *const wait_ns) {
+    if (!waits || !wait_ns) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    pufferfish_stats_thread_lock_waits(waits, wait_ns);
+    return true;
+}
+
+/**
+ * @brief Count the entries of the red-black tree while holding the lock.
+ * @param [in] object string pool instance.
+ * @param [in,out] out receive entries, live, dead and bytes.
+ */
+static void tree_stats(const struct pufferfish_string_pool *const object,
+                       struct pufferfish_string_pool_stats *const out) {
+    assert(object);
+    assert(out);
+    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
+    if (!seahorse_red_black_tree_map_s_wr_first_entry(&object->map, &entry)) {
+        seagrass_required_true(
+                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MAP_IS_EMPTY
+                == seahorse_error);
+        return;
+    }
+    do {
+        const struct triggerfish_weak *weak;
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_get_value(
+                &object->map, entry, &weak));
+        out->entries += 1;
+        struct triggerfish_strong *strong;
+        if (!triggerfish_weak_strong(weak, &strong)) {
+            seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                                   == triggerfish_error);
+            /* the entry of a dead string has already been destroyed */
+            out->dead += 1;
+            continue;
+        }
+        struct pufferfish_string_pool_entry *instance;
+        seagrass_required_true(triggerfish_strong_instance(
+                strong, (void **) &instance));
+        out->live += 1;
+        out->bytes += entry_size(instance);
+        seagrass_required_true(triggerfish_strong_release(strong));
+    } while (seahorse_red_black_tree_map_s_wr_next_entry(entry, &entry));
+    seagrass_required_true(SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
+                           == seahorse_error);
+}
+
+/**
+ * @brief Count the entries of the hash table while holding the lock.
+ * @param [in] object string pool instance.
+ * @param [in,out] out receive entries, live, dead and bytes.
+ */
+static void table_stats(const struct pufferfish_string_pool *const object,
+                        struct pufferfish_string_pool_stats *const out) {
+    assert(object);
+    assert(out);
+    /* entries are carved from the arena so it accounts for their bytes */
+    out->bytes = object->arena->reserved;
+    const struct pufferfish_string_pool_table *const table
+            = atomic_load_explicit(&object->table, memory_order_relaxed);
+    if (table) {
+        out->bytes += offsetof(struct pufferfish_string_pool_table, slots)
+                      + table->length * sizeof(*table->slots);
+        for (uintmax_t i = 0; i < table->length; i++) {
+            const struct pufferfish_string_pool_entry *const entry
+                    = atomic_load_explicit(&table->slots[i].entry,
+                                           memory_order_relaxed);
+            if (!entry || &tombstone == entry) {
+                continue;
+            }
+            out->entries += 1;
+            if (PUFFERFISH_STRING_POOL_ENTRY_DEAD
+                & atomic_load_explicit(&entry->state, memory_order_acquire)) {
+                out->dead += 1;
+            } else {
+                out->live += 1;
+            }
+        }
+    }
+    const struct pufferfish_string_pool_symbols *const symbols
+            = atomic_load_explicit(&object->symbols, memory_order_relaxed);
+    if (symbols) {
+        out->bytes += offsetof(struct pufferfish_string_pool_symbols, entries)
+                      + symbols->length * sizeof(*symbols->entries);
+    }
+    const struct pufferfish_string_pool_index *const index = object->index;
+    if (index) {
+        out->bytes += sizeof(*index)
+                      + index->capacity * sizeof(*index->blocks)
+                      + index->length * sizeof(**index->blocks);
+    }
+}
+
+bool pufferfish_string_pool_stats(
+        struct pufferfish_string_pool *const object,
+        struct pufferfish_string_pool_stats *const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    if (!lock_read(object)) {
+        return false;
+    }
+    *out = (struct pufferfish_string_pool_stats) {0};
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        table_stats(object, out);
+    } else {
+        tree_stats(object, out);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+#ifndef PUFFERFISH_NO_STATS
+    uintmax_t counters[PUFFERFISH_STATS_COUNTERS];
+    pufferfish_stats_sum(object->stats, counters);
+    out->hits = counters[PUFFERFISH_STATS_HITS];
+    out->misses = counters[PUFFERFISH_STATS_MISSES];
+    out->evictions = counters[PUFFERFISH_STATS_EVICTIONS];
+    out->upgrades = counters[PUFFERFISH_STATS_UPGRADES];
+    out->lock_waits = counters[PUFFERFISH_STATS_LOCK_WAITS];
+    out->lock_wait_ns = counters[PUFFERFISH_STATS_LOCK_WAIT_NS];
+    for (uintmax_t i = 0; i < PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS; i++) {
+        out->lock_wait_histogram[i]
+                = counters[PUFFERFISH_STATS_LOCK_WAIT_HISTOGRAM + i];
+    }
+#endif
+    return true;
+}
+
+/* string to be written to a snapshot */
+struct pufferfish_string_pool_saved {
+    const char *data;
+    uint64_t size;
+    uint64_t hash;
+    /* keeps the entry alive while it is written, NULL for snapshot strings */
+    struct triggerfish_strong *strong;
+};
+
+/**
+ * @brief Collect strings of the snapshot beneath the string pool.
+ * @param [in] object string pool instance.
+ * @param [out] out receive strings.
+ * @param [in,out] count number of strings in out.
+ */
+static void save_snapshot(const struct pufferfish_string_pool *const object,
+                          struct pufferfish_string_pool_saved *const out,
+                          uintmax_t *const count) {
+    assert(object);
+    assert(out);
+    assert(count);
+    if (!object->snapshot) {
+        return;
+    }
+    const struct pufferfish_snapshot_header *const header
+            = object->snapshot->header;
+    for (uint64_t i = 0; i < header->length; i++) {
+        const struct pufferfish_snapshot_slot *const slot
+                = &object->snapshot->slots[i];
+        size_t size;
+        const char *const data = slot->record
+                ? pufferfish_snapshot_record(object->snapshot,
+                                             slot->record - 1, &size)
+                : NULL;
+        if (data && *count < header->count) {
+            out[(*count)++] = (struct pufferfish_string_pool_saved) {
+                    .data = data,
+                    .size = size,
+                    .hash = slot->hash
+            };
+        }
+    }
+}
+
+/**
+ * @brief Collect a strongly referenced entry unless it is from the snapshot.
+ * @param [in] weak reference of entry.
+ * @param [out] out receive string.
+ * @param [in,out] count number of strings in out.
+ */
+static void save_entry(const struct triggerfish_weak *const weak,
+                       struct pufferfish_string_pool_saved *const out,
+                       uintmax_t *const count) {
+    assert(weak);
+    assert(out);
+    assert(count);
+    struct triggerfish_strong *strong;
+    if (!triggerfish_weak_strong(weak, &strong)) {
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+        return;
+    }
+    struct pufferfish_string_pool_entry *entry;
+    seagrass_required_true(triggerfish_strong_instance(strong,
+                                                       (void **) &entry));
+    if (entry_snapshot(entry)) {
+        /* already collected from the snapshot */
+        seagrass_required_true(triggerfish_strong_release(strong));
+        return;
+    }
+    out[(*count)++] = (struct pufferfish_string_pool_saved) {
+            .data = entry->string.data,
+            .size = entry->string.size,
+            .hash = entry->hash,
+            .strong = strong
+    };
+}
+
+/**
+ * @brief Collect the strings to be saved while holding the read lock.
+ * @param [in] object string pool instance.
+ * @param [out] out receive strings.
+ * @param [out] count receive number of strings.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to collect strings.
+ */
+static bool save_collect(const struct pufferfish_string_pool *const object,
+                         struct pufferfish_string_pool_saved **const out,
+                         uintmax_t *const count) {
+    assert(object);
+    assert(out);
+    assert(count);
+    uintmax_t capacity = object->snapshot
+            ? object->snapshot->header->count : 0;
+    uintmax_t entries = object->count;
+    if (!(object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE)) {
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_count(
+                &object->map, &entries));
+    }
+    capacity += entries;
+    struct pufferfish_string_pool_saved *const saved
+            = malloc((capacity ? capacity : 1) * sizeof(*saved));
+    if (!saved) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    *count = 0;
+    save_snapshot(object, saved, count);
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE) {
+        const struct pufferfish_string_pool_table *const table
+                = atomic_load_explicit(&object->table, memory_order_relaxed);
+        for (uintmax_t i = 0; table && i < table->length; i++) {
+            const struct pufferfish_string_pool_entry *const entry
+                    = atomic_load_explicit(&table->slots[i].entry,
+                                           memory_order_relaxed);
+            if (entry && &tombstone != entry) {
+                save_entry(entry->weak, saved, count);
             }
         }
+    } else {
+        const struct seahorse_red_black_tree_map_s_wr_entry *entry;
+        if (seahorse_red_black_tree_map_s_wr_first_entry(&object->map,
+                                                         &entry)) {
+            do {
+                const struct triggerfish_weak *weak;
+                seagrass_required_true(
+                        seahorse_red_black_tree_map_s_wr_entry_get_value(
+                                &object->map, entry, &weak));
+                save_entry(weak, saved, count);
+            } while (seahorse_red_black_tree_map_s_wr_next_entry(entry,
+                                                                 &entry));
+        }
+    }
+    *out = saved;
+    return true;
+}
+
+/**
+ * @brief Permissions a file created by open(2) with mode 0666 would get.
+ * <p>The file mode creation mask is read from /proc where possible, as
+ * setting it to read it back briefly affects files created by other
+ * threads.</p>
+ * @return 0666 without the bits of the file mode creation mask.
+ */
+static mode_t save_mode(void) {
+    unsigned int mask;
+    bool found = false;
+    FILE *const file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[128];
+        while (!found && fgets(line, sizeof(line), file)) {
+            found = 1 == sscanf(line, "Umask: %o", &mask);
+        }
+        fclose(file);
+    }
+    if (!found) {
+        const mode_t old = umask(0);
+        umask(old);
+        mask = old;
+    }
+    return 0666 & ~(mode_t) mask;
+}
+
+/**
+ * @brief Write collected strings in the snapshot file format.
+ * <p>The file is readable by whoever could read a file created with
+ * open(2), and is synced to disk before it replaces the file at path.</p>
+ * @param [in] saved strings to be written.
+ * @param [in] count number of strings.
+ * @param [in] path of file to write.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to build the index.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_IO_FAILED if the file could not be
+ * written.
+ */
+static bool save_write(const struct pufferfish_string_pool_saved *const saved,
+                       const uintmax_t count,
+                       const char *const path) {
+    assert(saved);
+    assert(path);
+    /* at most half full so that probe sequences stay short */
+    uint64_t length = PUFFERFISH_STRING_POOL_TABLE_MINIMUM_LENGTH;
+    while (length / 2 < count) {
+        length *= 2;
+    }
+    struct pufferfish_snapshot_slot *const slots = calloc(length,
+                                                          sizeof(*slots));
+    struct pufferfish_snapshot_record *const records = malloc(
+            (count ? count : 1) * sizeof(*records));
+    if (!slots || !records) {
+        free(slots);
+        free(records);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    struct pufferfish_snapshot_header header = {
+            .magic = PUFFERFISH_SNAPSHOT_MAGIC,
+            .version = PUFFERFISH_SNAPSHOT_VERSION,
+            .byte_order = PUFFERFISH_SNAPSHOT_BYTE_ORDER,
+            .hash = PUFFERFISH_HASH_ID,
+            .count = count,
+            .length = length
+    };
+    uint64_t offset = sizeof(header)
+                      + length * sizeof(*slots)
+                      + count * sizeof(*records);
+    for (uintmax_t i = 0; i < count; i++) {
+        records[i] = (struct pufferfish_snapshot_record) {
+                .offset = offset,
+                .size = saved[i].size
+        };
+        offset += saved[i].size + 1;
+        uint64_t j = saved[i].hash & (length - 1);
+        while (slots[j].record) {
+            j = (j + 1) & (length - 1);
+        }
+        slots[j] = (struct pufferfish_snapshot_slot) {
+                .hash = saved[i].hash,
+                .record = i + 1
+        };
+    }
+    header.size = offset;
+    /* replaced by rename so that mappings of the old file stay intact */
+    const size_t size = strlen(path);
+    char *const temporary = malloc(size + sizeof(".XXXXXX"));
+    if (!temporary) {
+        free(slots);
+        free(records);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    memcpy(temporary, path, size);
+    memcpy(temporary + size, ".XXXXXX", sizeof(".XXXXXX"));
+    int fd = mkstemp(temporary);
+    /* mkstemp() creates the file accessible to its owner only */
+    if (-1 != fd && fchmod(fd, save_mode())) {
+        close(fd);
+        unlink(temporary);
+        fd = -1;
+    }
+    FILE *const file = -1 == fd ? NULL : fdopen(fd, "wb");
+    if (-1 != fd && !file) {
+        close(fd);
+    }
+    bool result = file
+                  && 1 == fwrite(&header, sizeof(header), 1, file)
+                  && length == fwrite(slots, sizeof(*slots), length, file)
+                  && count == fwrite(records, sizeof(*records), count, file);
+    for (uintmax_t i = 0; result && i < count; i++) {
+        result = saved[i].size == fwrite(saved[i].data, 1, saved[i].size,
+                                         file)
+                 && EOF != fputc('\0', file);
+    }
+    /* a crash must not leave an empty file under the real name */
+    if (result && (fflush(file) || fsync(fd))) {
+        result = false;
+    }
+    if (file && fclose(file)) {
+        result = false;
+    }
+    if (result && rename(temporary, path)) {
+        result = false;
+    }
+    if (!result && -1 != fd) {
+        unlink(temporary);
+    }
+    free(temporary);
+    free(slots);
+    free(records);
+    if (!result) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_IO_FAILED;
+    }
+    return result;
+}
+
+bool pufferfish_string_pool_save(struct pufferfish_string_pool *const object,
+                                 const char *const path) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!path) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL;
+        return false;
+    }
+    if (!lock_read(object)) {
+        return false;
     }
+    struct pufferfish_string_pool_saved *saved;
+    uintmax_t count;
+    const bool collected = save_collect(object, &saved, &count);
     seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
+    if (!collected) {
+        return false;
+    }
+    /* the strong references keep the collected entries alive */
+    const bool result = save_write(saved, count, path);
+    for (uintmax_t i = 0; i < count; i++) {
+        if (saved[i].strong) {
+            seagrass_required_true(triggerfish_strong_release(
+                    saved[i].strong));
+        }
+    }
+    free(saved);
     return result;
 }
 
-bool pufferfish_string_pool_shrink(
-        struct pufferfish_string_pool *const object) {
+bool pufferfish_string_pool_cursor_init(
+        struct pufferfish_string_pool_cursor *const object,
+        struct pufferfish_string_pool *const string_pool,
+        const char *const prefix,
+        const size_t size) {
     if (!object) {
         pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
         return false;
     }
-    seagrass_required_true(!pthread_rwlock_wrlock(&object->lock));
-    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
-    if (seahorse_red_black_tree_map_s_wr_first_entry(&object->map, &entry)) {
-        const struct triggerfish_weak *weak;
-        do {
-            seagrass_required_true(
-                    seahorse_red_black_tree_map_s_wr_entry_get_value(
-                            &object->map, entry, &weak));
-            struct triggerfish_strong *strong;
-            if (triggerfish_weak_strong(weak, &strong)) {
-                seagrass_required_true(triggerfish_strong_release(strong));
-                if (!seahorse_red_black_tree_map_s_wr_next_entry(entry,
-                                                                 &entry)) {
-                    seagrass_required_true(
-                            SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
-                            == seahorse_error);
-                    break;
-                }
-                continue;
+    if (!string_pool) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_POOL_IS_NULL;
+        return false;
+    }
+    if (!prefix) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL;
+        return false;
+    }
+    struct sea_turtle_string *const string = malloc(sizeof(*string));
+    if (!string) {
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    size_t count;
+    if (!sea_turtle_string_init(string, prefix, size, &count)) {
+        free(string);
+        pufferfish_error =
+                SEA_TURTLE_STRING_ERROR_MEMORY_ALLOCATION_FAILED
+                == sea_turtle_error
+                ? PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED
+                : PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED;
+        return false;
+    }
+    *object = (struct pufferfish_string_pool_cursor) {
+            .string_pool = string_pool,
+            .prefix = string
+    };
+    return true;
+}
+
+bool pufferfish_string_pool_cursor_invalidate(
+        struct pufferfish_string_pool_cursor *const object) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (object->last) {
+        seagrass_required_true(triggerfish_strong_release(object->last));
+    }
+    seagrass_required_true(sea_turtle_string_invalidate(object->prefix));
+    free(object->prefix);
+    *object = (struct pufferfish_string_pool_cursor) {0};
+    return true;
+}
+
+/**
+ * @brief Check whether string starts with the prefix of cursor.
+ * @param [in] object cursor instance.
+ * @param [in] string to check.
+ * @return true if string starts with prefix, otherwise false.
+ */
+static bool cursor_prefixed(
+        const struct pufferfish_string_pool_cursor *const object,
+        const struct sea_turtle_string *const string) {
+    assert(object);
+    assert(string);
+    return string->size >= object->prefix->size
+           && !memcmp(string->data, object->prefix->data,
+                      object->prefix->size);
+}
+
+/**
+ * @brief Key the cursor resumes from.
+ * @param [in] object cursor instance.
+ * @param [out] strict receive true if strings equal to the key have been
+ * visited already.
+ * @return last string visited or else the prefix.
+ */
+static const struct sea_turtle_string *cursor_key(
+        const struct pufferfish_string_pool_cursor *const object,
+        bool *const strict) {
+    assert(object);
+    assert(strict);
+    *strict = object->last;
+    if (!object->last) {
+        return object->prefix;
+    }
+    const struct sea_turtle_string *key;
+    seagrass_required_true(triggerfish_strong_instance(object->last,
+                                                       (void **) &key));
+    return key;
+}
+
+/**
+ * @brief Order entries by their string.
+ * @param [in] a pointer to first entry.
+ * @param [in] b pointer to second entry.
+ * @return negative, zero or positive as a is less than, equal to or greater
+ * than b.
+ */
+static int index_compare(const void *const a, const void *const b) {
+    const struct pufferfish_string_pool_entry *const *const x = a;
+    const struct pufferfish_string_pool_entry *const *const y = b;
+    return sea_turtle_string_compare(&(*x)->string, &(*y)->string);
+}
+
+/**
+ * @brief Sort the entries of the hash table while holding the write lock.
+ * <p>Dead entries are included as well, they are skipped when visited so
+ * that the index survives strings being released. Blocks are left half full
+ * so that entries added afterwards rarely split them.</p>
+ * @param [in] object string pool instance.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to build the index.
+ */
+static bool index_build(struct pufferfish_string_pool *const object) {
+    assert(object);
+    assert(!object->index);
+    const struct pufferfish_string_pool_table *const table
+            = atomic_load_explicit(&object->table, memory_order_relaxed);
+    const uintmax_t count = table ? object->count : 0;
+    const uintmax_t fill = PUFFERFISH_STRING_POOL_INDEX_BLOCK_LENGTH / 2;
+    const uintmax_t capacity = count ? (count + fill - 1) / fill : 1;
+    struct pufferfish_string_pool_index *const index = calloc(
+            1, sizeof(*index));
+    struct pufferfish_string_pool_entry **const entries = malloc(
+            (count ? count : 1) * sizeof(*entries));
+    struct pufferfish_string_pool_index_block **const blocks = malloc(
+            capacity * sizeof(*blocks));
+    if (!index || !entries || !blocks) {
+        free(index);
+        free(entries);
+        free(blocks);
+        pufferfish_error =
+                PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        return false;
+    }
+    uintmax_t length = 0;
+    for (uintmax_t i = 0; table && i < table->length; i++) {
+        struct pufferfish_string_pool_entry *const entry
+                = atomic_load_explicit(&table->slots[i].entry,
+                                       memory_order_relaxed);
+        if (entry && &tombstone != entry) {
+            seagrass_required_true(length < count);
+            entries[length++] = entry;
+        }
+    }
+    qsort(entries, length, sizeof(*entries), index_compare);
+    index->blocks = blocks;
+    index->capacity = capacity;
+    for (uintmax_t i = 0; i < length; i += fill) {
+        struct pufferfish_string_pool_index_block *const block = malloc(
+                sizeof(*block));
+        if (!block) {
+            free(entries);
+            index_free(index);
+            pufferfish_error =
+                    PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+            return false;
+        }
+        block->count = length - i < fill ? length - i : fill;
+        memcpy(block->entries, &entries[i],
+               block->count * sizeof(*block->entries));
+        index->blocks[index->length++] = block;
+    }
+    index->count = length;
+    free(entries);
+    object->index = index;
+    return true;
+}
+
+/**
+ * @brief Retrieve the next string of the index while holding the lock.
+ * @param [in] object cursor instance.
+ * @param [out] out strong reference of next string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE if there are no more
+ * strings with the prefix.
+ */
+static bool cursor_table_next(
+        const struct pufferfish_string_pool_cursor *const object,
+        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(out);
+    const struct pufferfish_string_pool_index *const index
+            = object->string_pool->index;
+    bool strict;
+    const struct sea_turtle_string *const key = cursor_key(object, &strict);
+    uintmax_t block;
+    uintmax_t i;
+    index_search(index, key, strict, &block, &i);
+    for (; block < index->length; block++, i = 0) {
+        const struct pufferfish_string_pool_index_block *const at
+                = index->blocks[block];
+        for (; i < at->count; i++) {
+            const struct pufferfish_string_pool_entry *const entry
+                    = at->entries[i];
+            if (!cursor_prefixed(object, &entry->string)) {
+                pufferfish_error =
+                        PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE;
+                return false;
+            }
+            if (triggerfish_weak_strong(entry->weak, out)) {
+                return true;
             }
             seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
                                    == triggerfish_error);
-            const struct seahorse_red_black_tree_map_s_wr_entry *next;
-            const bool result = seahorse_red_black_tree_map_s_wr_next_entry(
-                    entry, &next);
-            if (!result) {
-                seagrass_required_true(
-                        SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
-                        == seahorse_error);
-            }
+        }
+    }
+    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE;
+    return false;
+}
+
+/**
+ * @brief Retrieve the next string of the red-black tree while holding the
+ * lock.
+ * @param [in] object cursor instance.
+ * @param [out] out strong reference of next string.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE if there are no more
+ * strings with the prefix.
+ */
+static bool cursor_tree_next(
+        const struct pufferfish_string_pool_cursor *const object,
+        struct triggerfish_strong **const out) {
+    assert(object);
+    assert(out);
+    const struct seahorse_red_black_tree_map_s_wr *const map
+            = &object->string_pool->map;
+    bool strict;
+    const struct sea_turtle_string *const key = cursor_key(object, &strict);
+    const struct seahorse_red_black_tree_map_s_wr_entry *entry;
+    bool result = strict
+            ? seahorse_red_black_tree_map_s_wr_higher_entry(map, key, &entry)
+            : seahorse_red_black_tree_map_s_wr_ceiling_entry(map, key, &entry);
+    if (!result) {
+        seagrass_required_true(
+                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_ENTRY_NOT_FOUND
+                == seahorse_error
+                || SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MAP_IS_EMPTY
+                   == seahorse_error);
+    }
+    while (result) {
+        const struct sea_turtle_string *string;
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_key(
+                map, entry, &string));
+        if (!cursor_prefixed(object, string)) {
+            break;
+        }
+        const struct triggerfish_weak *weak;
+        seagrass_required_true(seahorse_red_black_tree_map_s_wr_entry_get_value(
+                map, entry, &weak));
+        if (triggerfish_weak_strong(weak, out)) {
+            return true;
+        }
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == triggerfish_error);
+        result = seahorse_red_black_tree_map_s_wr_next_entry(entry, &entry);
+        if (!result) {
             seagrass_required_true(
-                    seahorse_red_black_tree_map_s_wr_remove_entry(
-                            &object->map, entry));
-            if (result) {
-                entry = next;
-            } else {
-                break;
-            }
-        } while (true);
+                    SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_END_OF_SEQUENCE
+                    == seahorse_error);
+        }
+    }
+    pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE;
+    return false;
+}
+
+bool pufferfish_string_pool_cursor_next(
+        struct pufferfish_string_pool_cursor *const object,
+        struct triggerfish_strong **const out) {
+    if (!object) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL;
+        return false;
+    }
+    if (!out) {
+        pufferfish_error = PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL;
+        return false;
+    }
+    struct pufferfish_string_pool *const string_pool = object->string_pool;
+    if (!lock_read(string_pool)) {
+        return false;
+    }
+    bool result;
+    if (!(string_pool->flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE)) {
+        result = cursor_tree_next(object, out);
+    } else if (string_pool->index) {
+        result = cursor_table_next(object, out);
     } else {
-        seagrass_required_true(
-                SEAHORSE_RED_BLACK_TREE_MAP_S_WR_ERROR_MAP_IS_EMPTY
-                == seahorse_error);
+        /* acquire write lock and recheck state */
+        seagrass_required_true(!pthread_rwlock_unlock(&string_pool->lock));
+        lock_write(string_pool);
+        result = (string_pool->index || index_build(string_pool))
+                 && cursor_table_next(object, out);
+    }
+    seagrass_required_true(!pthread_rwlock_unlock(&string_pool->lock));
+    if (!result) {
+        return false;
+    }
+    /* releasing the previous string may destroy its entry, so it is done
+     * without holding the lock */
+    struct triggerfish_strong *const last = object->last;
+    seagrass_required_true(triggerfish_strong_retain(*out));
+    object->last = *out;
+    if (last) {
+        seagrass_required_true(triggerfish_strong_release(last));
     }
-    seagrass_required_true(!pthread_rwlock_unlock(&object->lock));
     return true;
 }
@@ -0,0 +1,97 @@
+#ifndef _PUFFERFISH_STRING_POOL_PRIVATE_H_
+#define _PUFFERFISH_STRING_POOL_PRIVATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sea-turtle.h>
+
+struct pufferfish_string_pool;
+struct pufferfish_arena;
+struct triggerfish_strong;
+struct triggerfish_weak;
+
+#define PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND             (-1)
+
+/*
+ * Leading fields of the entries of string pools and static string pools, so
+ * that any strong reference either hands out can be inspected.
+ */
+struct pufferfish_string_pool_entry_header {
+    /* instance of strong, must come first */
+    struct sea_turtle_string string;
+    uintmax_t hash;
+    /* NULL if the entry is never removed from its string pool */
+    struct triggerfish_weak *weak;
+    /* arena the entry was carved from, NULL if it belongs to no arena */
+    struct pufferfish_arena *arena;
+};
+
+/**
+ * @brief Retrieve the matching strong reference using a precalculated hash.
+ * @param [in] object string pool instance.
+ * @param [in] string to find in string pool.
+ * @param [in] hash of string as calculated by pufferfish_hash().
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve pooled string instance.
+ * @note <b>object</b>, <b>string</b> and <b>out</b> must not be <i>NULL</i>.
+ */
+bool pufferfish_string_pool_get_with_hash(
+        struct pufferfish_string_pool *object,
+        const struct sea_turtle_string *string,
+        uintmax_t hash,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the matching strong reference only if string is already
+ * pooled.
+ * @param [in] object string pool instance.
+ * @param [in] string to find in string pool, with a hash table only its size
+ * and data are used.
+ * @param [in] hash of string as calculated by pufferfish_hash().
+ * @param [out] out strong reference of string in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_STRING_NOT_FOUND if string is not
+ * pooled.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve pooled string instance.
+ * @note <b>object</b>, <b>string</b> and <b>out</b> must not be <i>NULL</i>.
+ */
+bool pufferfish_string_pool_find_with_hash(
+        struct pufferfish_string_pool *object,
+        const struct sea_turtle_string *string,
+        uintmax_t hash,
+        struct triggerfish_strong **out);
+
+/**
+ * @brief Retrieve the matching strong references of a batch using
+ * precalculated hashes.
+ * @param [in] object string pool instance.
+ * @param [in] strings to find in string pool.
+ * @param [in] hashes of strings as calculated by pufferfish_hash() or
+ * <i>NULL</i> to have them calculated.
+ * @param [in] count of strings.
+ * @param [out] out receive strong references of strings in pool.
+ * @return On success true, otherwise false if an error has occurred.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED if the
+ * maximum number of concurrent operations on this string pool instance has
+ * been reached.
+ * @throws PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to retrieve pooled string instances.
+ * @note <b>object</b>, <b>strings</b> and <b>out</b> must not be <i>NULL</i>.
+ */
+bool pufferfish_string_pool_get_many_with_hashes(
+        struct pufferfish_string_pool *object,
+        const struct sea_turtle_string *const *strings,
+        const uintmax_t *hashes,
+        uintmax_t count,
+        struct triggerfish_strong **out);
+
+#endif /* _PUFFERFISH_STRING_POOL_PRIVATE_H_ */
@@ -0,0 +1,76 @@
+#include <stdlib.h>
+#include <stdalign.h>
+#include <pthread.h>
+#include <seagrass.h>
+#include <pufferfish.h>
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#include "thread_cache.h"
+
+#define PUFFERFISH_THREAD_CACHE_CACHE_LINE                          64
+
+struct pufferfish_thread_cache {
+    struct pufferfish_thread_cache_slot
+            slots[PUFFERFISH_THREAD_CACHE_LENGTH];
+};
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_key_t key;
+static _Thread_local struct pufferfish_thread_cache *cache;
+/* counted even while the cache could not be created */
+static _Thread_local uintmax_t hits;
+static _Thread_local uintmax_t misses;
+
+static void on_thread_exit(void *a) {
+    free(a);
+}
+
+static void on_once(void) {
+    seagrass_required_true(!pthread_key_create(&key, on_thread_exit));
+}
+
+/**
+ * @brief Create the cache of the calling thread.
+ * @return On success true, otherwise false if there is insufficient memory.
+ */
+static bool cache_create(void) {
+    seagrass_required_true(!pthread_once(&once, on_once));
+    void *memory;
+    /* slots never straddle a cache line */
+    if (posix_memalign(&memory, PUFFERFISH_THREAD_CACHE_CACHE_LINE,
+                       sizeof(*cache))) {
+        return false;
+    }
+    if (pthread_setspecific(key, memory)) {
+        free(memory);
+        return false;
+    }
+    cache = memory;
+    *cache = (struct pufferfish_thread_cache) {0};
+    return true;
+}
+
+struct pufferfish_thread_cache_slot *pufferfish_thread_cache_slot(
+        const uintmax_t hash) {
+    if (!cache && !cache_create()) {
+        return NULL;
+    }
+    return &cache->slots[hash & (PUFFERFISH_THREAD_CACHE_LENGTH - 1)];
+}
+
+void pufferfish_thread_cache_hit(void) {
+    hits += 1;
+}
+
+void pufferfish_thread_cache_miss(void) {
+    misses += 1;
+}
+
+void pufferfish_thread_cache_counters(uintmax_t *const out_hits,
+                                      uintmax_t *const out_misses) {
+    *out_hits = hits;
+    *out_misses = misses;
+}
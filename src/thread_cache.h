@@ -0,0 +1,47 @@
+#ifndef _PUFFERFISH_THREAD_CACHE_H_
+#define _PUFFERFISH_THREAD_CACHE_H_
+
+#include <stdint.h>
+
+/* number of slots in the cache of each thread, must be a power of two */
+#define PUFFERFISH_THREAD_CACHE_LENGTH                              256
+
+/* slots are only ever accessed by the thread owning the cache */
+struct pufferfish_thread_cache_slot {
+    /* serial of the string pool the entry belongs to, 0 if empty */
+    uintmax_t serial;
+    /* generation of the string pool when the entry was cached */
+    uintmax_t generation;
+    uintmax_t hash;
+    void *entry;
+};
+
+/**
+ * @brief Slot of the calling thread's cache for hash.
+ * <p>The cache is created on first use and destroyed when the calling
+ * thread exits.</p>
+ * @param [in] hash to find slot for.
+ * @return slot for hash or <i>NULL</i> if there is insufficient memory to
+ * create the cache.
+ */
+struct pufferfish_thread_cache_slot *pufferfish_thread_cache_slot(
+        uintmax_t hash);
+
+/**
+ * @brief Count a lookup that was answered by the calling thread's cache.
+ */
+void pufferfish_thread_cache_hit(void);
+
+/**
+ * @brief Count a lookup that was not answered by the calling thread's cache.
+ */
+void pufferfish_thread_cache_miss(void);
+
+/**
+ * @brief Counters of the calling thread's cache.
+ * @param [out] hits receive number of lookups answered by the cache.
+ * @param [out] misses receive number of lookups not answered by the cache.
+ */
+void pufferfish_thread_cache_counters(uintmax_t *hits, uintmax_t *misses);
+
+#endif /* _PUFFERFISH_THREAD_CACHE_H_ */
@@ -1,13 +1,74 @@
 #include <stdarg.h>
 #include <stddef.h>
+#include <string.h>
 #include <setjmp.h>
 #include <cmocka.h>
 #include <pufferfish.h>
 
 #include <test/cmocka.h>
 
+#include "chars.h"
+#include "hash_private.h"
+
+static void check_chars_equal(void **state) {
+    char a[40];
+    char b[40];
+    for (size_t i = 0; i < sizeof(a); i++) {
+        a[i] = b[i] = (char) ('a' + i);
+    }
+    for (size_t size = 0; size <= sizeof(a); size++) {
+        assert_true(pufferfish_chars_equal(a, b, size));
+        for (size_t i = 0; i < size; i++) {
+            b[i] = 'X';
+            assert_false(pufferfish_chars_equal(a, b, size));
+            b[i] = a[i];
+        }
+        /* bytes beyond size are never compared */
+        if (size < sizeof(a)) {
+            b[size] = 'X';
+            assert_true(pufferfish_chars_equal(a, b, size));
+            b[size] = a[size];
+        }
+    }
+}
+
+static void check_hash(void **state) {
+    unsigned char data[256 + 8];
+    uint64_t x = 88172645463325252u;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        data[i] = (unsigned char) x;
+    }
+    /* accelerated and portable hashes agree for every size and alignment */
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size + offset <= sizeof(data); size++) {
+            uintmax_t hash, portable;
+            pufferfish_hash(data + offset, size, &hash);
+            pufferfish_hash_portable(data + offset, size, &portable);
+            assert_int_equal(hash, portable);
+        }
+    }
+}
+
+static void check_hash_values(void **state) {
+    /* these change together with PUFFERFISH_HASH_ID */
+    assert_int_equal(PUFFERFISH_HASH_ID, 2);
+    uintmax_t hash;
+    pufferfish_hash("", 0, &hash);
+    assert_int_equal(hash, UINTMAX_C(0x9188004641f6882d));
+    pufferfish_hash("pufferfish", 10, &hash);
+    assert_int_equal(hash, UINTMAX_C(0x193848b521d7e01f));
+    pufferfish_hash("https://example.com/aquarium/pufferfish", 39, &hash);
+    assert_int_equal(hash, UINTMAX_C(0x353f080541d14fa7));
+}
+
 int main(int argc, char *argv[]) {
     const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_chars_equal),
+            cmocka_unit_test(check_hash),
+            cmocka_unit_test(check_hash_values),
     };
     //cmocka_set_message_output(CM_OUTPUT_XML);
     return cmocka_run_group_tests(tests, NULL, NULL);
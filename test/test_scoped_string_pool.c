@@ -0,0 +1,332 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+#include <test/cmocka.h>
+
+#define STRINGS_COUNT                                               1000
+
+static void check_invalidate_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_invalidate(NULL));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_init(NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_parent_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_scoped_string_pool object;
+    assert_false(pufferfish_scoped_string_pool_init(&object, NULL));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_PARENT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool parent;
+    assert_true(pufferfish_string_pool_init(&parent));
+    struct pufferfish_scoped_string_pool object;
+    assert_true(pufferfish_scoped_string_pool_init(&object, &parent));
+    assert_ptr_equal(object.parent, &parent);
+    assert_null(object.chunks);
+    assert_int_equal(object.count, 0);
+    assert_true(pufferfish_scoped_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&parent));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_get(NULL, (void *) 1,
+                                                   (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_get((void *) 1, NULL,
+                                                   (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_get((void *) 1, (void *) 1,
+                                                   NULL));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool parent;
+    assert_true(pufferfish_string_pool_init(&parent));
+    struct pufferfish_scoped_string_pool object;
+    assert_true(pufferfish_scoped_string_pool_init(&object, &parent));
+    struct sea_turtle_string string;
+    size_t count;
+    assert_true(sea_turtle_string_init(&string, "scoped", 6, &count));
+    const struct sea_turtle_string *out;
+    malloc_is_overridden = calloc_is_overridden = true;
+    assert_false(pufferfish_scoped_string_pool_get(&object, &string, &out));
+    malloc_is_overridden = calloc_is_overridden = false;
+    assert_int_equal(
+            PUFFERFISH_SCOPED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+            pufferfish_error);
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_scoped_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&parent));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_with_parent(const uintmax_t flags) {
+    struct pufferfish_string_pool parent;
+    assert_true(pufferfish_string_pool_init_with_flags(&parent, flags));
+    struct triggerfish_strong *pooled;
+    assert_true(pufferfish_string_pool_get_chars(&parent, "parent", 6, NULL,
+                                                 &pooled));
+    const struct sea_turtle_string *instance;
+    assert_true(triggerfish_strong_instance(pooled, (void **) &instance));
+    struct pufferfish_scoped_string_pool object;
+    assert_true(pufferfish_scoped_string_pool_init(&object, &parent));
+    /* strings of the parent are shared rather than copied */
+    struct sea_turtle_string string;
+    size_t count;
+    assert_true(sea_turtle_string_init(&string, "parent", 6, &count));
+    const struct sea_turtle_string *out;
+    assert_true(pufferfish_scoped_string_pool_get(&object, &string, &out));
+    assert_ptr_equal(out->data, instance->data);
+    assert_true(sea_turtle_string_invalidate(&string));
+    /* new strings stay in the scope */
+    const struct sea_turtle_string *scoped[STRINGS_COUNT];
+    for (uintmax_t i = 0; i < STRINGS_COUNT; i++) {
+        char chars[32];
+        const int length = snprintf(chars, sizeof(chars), "scoped-%ju", i);
+        assert_true(sea_turtle_string_init(&string, chars, length, &count));
+        assert_true(pufferfish_scoped_string_pool_get(&object, &string,
+                                                      &scoped[i]));
+        assert_ptr_not_equal(scoped[i], &string);
+        assert_int_equal(scoped[i]->size, length);
+        assert_memory_equal(scoped[i]->data, chars, length);
+        assert_true(sea_turtle_string_invalidate(&string));
+    }
+    assert_int_equal(object.count, 1 + STRINGS_COUNT);
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(&parent, &stats));
+    assert_int_equal(stats.entries, 1);
+    /* equal strings are the same instance for the lifetime of the scope */
+    for (uintmax_t i = 0; i < STRINGS_COUNT; i++) {
+        const struct sea_turtle_string *again;
+        assert_true(pufferfish_scoped_string_pool_get(&object, scoped[i],
+                                                      &again));
+        assert_ptr_equal(again, scoped[i]);
+    }
+    assert_true(pufferfish_scoped_string_pool_get(&object, instance, &out));
+    assert_ptr_equal(out->data, instance->data);
+    /* the parent's string outlives its own strong while it is borrowed */
+    assert_true(triggerfish_strong_release(pooled));
+    assert_memory_equal(out->data, "parent", 6);
+    assert_true(pufferfish_scoped_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&parent));
+}
+
+static void check_get(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    check_get_with_parent(0);
+    check_get_with_parent(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_get_chars(
+            NULL, (void *) 1, 1, NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_get_chars(
+            (void *) 1, NULL, 1, NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_get_chars(
+            (void *) 1, (void *) 1, 1, NULL, NULL));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_are_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    const uintmax_t flags[] = {0, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE};
+    for (uintmax_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        struct pufferfish_string_pool parent;
+        assert_true(pufferfish_string_pool_init_with_flags(&parent, flags[i]));
+        struct pufferfish_scoped_string_pool object;
+        assert_true(pufferfish_scoped_string_pool_init(&object, &parent));
+        const struct sea_turtle_string *out;
+        assert_false(pufferfish_scoped_string_pool_get_chars(
+                &object, "\xff\xfe", 2, NULL, &out));
+        assert_int_equal(
+                PUFFERFISH_SCOPED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED,
+                pufferfish_error);
+        assert_int_equal(object.count, 0);
+        assert_true(pufferfish_scoped_string_pool_invalidate(&object));
+        assert_true(pufferfish_string_pool_invalidate(&parent));
+    }
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    const uintmax_t flags[] = {0, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE};
+    for (uintmax_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        struct pufferfish_string_pool parent;
+        assert_true(pufferfish_string_pool_init_with_flags(&parent, flags[i]));
+        struct triggerfish_strong *pooled;
+        assert_true(pufferfish_string_pool_get_chars(&parent, "parent", 6,
+                                                     NULL, &pooled));
+        const struct sea_turtle_string *instance;
+        assert_true(triggerfish_strong_instance(pooled, (void **) &instance));
+        struct pufferfish_scoped_string_pool object;
+        assert_true(pufferfish_scoped_string_pool_init(&object, &parent));
+        const struct sea_turtle_string *out;
+        assert_true(pufferfish_scoped_string_pool_get_chars(
+                &object, "parent", 6, NULL, &out));
+        assert_ptr_equal(out->data, instance->data);
+        uintmax_t hash;
+        pufferfish_hash("request", 7, &hash);
+        const struct sea_turtle_string *first;
+        assert_true(pufferfish_scoped_string_pool_get_chars(
+                &object, "request", 7, &hash, &first));
+        assert_int_equal(first->size, 7);
+        assert_int_equal(first->count, 7);
+        assert_string_equal(first->data, "request");
+        const struct sea_turtle_string *second;
+        assert_true(pufferfish_scoped_string_pool_get_chars(
+                &object, "request", 7, NULL, &second));
+        assert_ptr_equal(first, second);
+        /* strings longer than a chunk get one of their own */
+        static char large[3 * 4096];
+        memset(large, 'a', sizeof(large));
+        assert_true(pufferfish_scoped_string_pool_get_chars(
+                &object, large, sizeof(large), NULL, &out));
+        assert_int_equal(out->size, sizeof(large));
+        assert_memory_equal(out->data, large, sizeof(large));
+        assert_string_equal(first->data, "request");
+        assert_true(triggerfish_strong_release(pooled));
+        assert_true(pufferfish_scoped_string_pool_invalidate(&object));
+        assert_true(pufferfish_string_pool_invalidate(&parent));
+    }
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_promote_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_promote(NULL, (void *) 1,
+                                                       (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_promote_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_promote((void *) 1, NULL,
+                                                       (void *) 1));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_promote_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_scoped_string_pool_promote((void *) 1,
+                                                       (void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_SCOPED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_promote(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool parent;
+    assert_true(pufferfish_string_pool_init(&parent));
+    struct pufferfish_scoped_string_pool object;
+    assert_true(pufferfish_scoped_string_pool_init(&object, &parent));
+    const struct sea_turtle_string *scoped;
+    assert_true(pufferfish_scoped_string_pool_get_chars(
+            &object, "promoted", 8, NULL, &scoped));
+    struct triggerfish_strong *promoted;
+    assert_true(pufferfish_scoped_string_pool_promote(&object, scoped,
+                                                      &promoted));
+    assert_true(pufferfish_scoped_string_pool_invalidate(&object));
+    /* the promoted string outlives the scope */
+    const struct sea_turtle_string *instance;
+    assert_true(triggerfish_strong_instance(promoted, (void **) &instance));
+    assert_int_equal(instance->size, 8);
+    assert_memory_equal(instance->data, "promoted", 8);
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(&parent, "promoted", 8, NULL,
+                                                 &out));
+    assert_ptr_equal(out, promoted);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(triggerfish_strong_release(promoted));
+    assert_true(pufferfish_string_pool_invalidate(&parent));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_invalidate_error_on_object_is_null),
+            cmocka_unit_test(check_init_error_on_object_is_null),
+            cmocka_unit_test(check_init_error_on_parent_is_null),
+            cmocka_unit_test(check_init),
+            cmocka_unit_test(check_get_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_string_is_null),
+            cmocka_unit_test(check_get_error_on_out_is_null),
+            cmocka_unit_test(check_get_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_get),
+            cmocka_unit_test(check_get_chars_error_on_object_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_is_null),
+            cmocka_unit_test(check_get_chars_error_on_out_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_are_malformed),
+            cmocka_unit_test(check_get_chars),
+            cmocka_unit_test(check_promote_error_on_object_is_null),
+            cmocka_unit_test(check_promote_error_on_string_is_null),
+            cmocka_unit_test(check_promote_error_on_out_is_null),
+            cmocka_unit_test(check_promote),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
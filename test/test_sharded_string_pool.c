@@ -0,0 +1,416 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+#include <test/cmocka.h>
+
+static void check_invalidate_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_invalidate(NULL));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_init(NULL, 1, 0));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_count_is_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_false(pufferfish_sharded_string_pool_init(&object, 0, 0));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_COUNT_IS_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_flags_are_invalid(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_false(pufferfish_sharded_string_pool_init(&object, 4, UINTMAX_MAX));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_FLAGS_ARE_INVALID,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    posix_memalign_is_overridden = true;
+    assert_false(pufferfish_sharded_string_pool_init(&object, 4, 0));
+    posix_memalign_is_overridden = false;
+    assert_int_equal(
+            PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+            pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    assert_int_equal(object.count, 4);
+    for (uintmax_t i = 0; i < object.count; i++) {
+        assert_int_equal(0, (uintptr_t) &object.shards[i]
+                            % PUFFERFISH_SHARDED_STRING_POOL_CACHE_LINE);
+    }
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get(
+            NULL, (void *) 1, (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get(
+            (void *) 1, NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get(
+            (void *) 1, (void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_sharded_string_pool_get(&object, &string, &out));
+    struct sea_turtle_string *str;
+    assert_true(triggerfish_strong_instance(out, (void **) &str));
+    assert_ptr_not_equal(&string, str);
+    assert_int_equal(sea_turtle_string_compare(&string, str), 0);
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_sharded_string_pool_get(&object, &string, &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_count(out, &count));
+    assert_int_equal(count, 2);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(&object, 4, 0));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_false(pufferfish_sharded_string_pool_get(&object, &string, &out));
+    assert_int_equal(
+            PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+            pufferfish_error);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get_chars(
+            NULL, (void *) 1, 1, NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get_chars(
+            (void *) 1, NULL, 1, NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get_chars(
+            (void *) 1, (void *) 1, 1, NULL, NULL));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_are_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = "\xff\xfe";
+    struct triggerfish_strong *out;
+    assert_false(pufferfish_sharded_string_pool_get_chars(
+            &object, chars, sizeof(chars) - 1, NULL, &out));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_CHARS_ARE_MALFORMED,
+                     pufferfish_error);
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars) - 1,
+                                       &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_sharded_string_pool_get_chars(
+            &object, chars, sizeof(chars) - 1, NULL, &out));
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_sharded_string_pool_get(&object, &string, &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get_many(NULL, (void *) 1, 1,
+                                                         (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_strings_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get_many((void *) 1, NULL, 1,
+                                                         (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_get_many((void *) 1,
+                                                         (void *) 1, 1, NULL));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct sea_turtle_string string[32];
+    const struct sea_turtle_string *strings[32];
+    for (uintmax_t i = 0; i < 32; i++) {
+        char chars[16];
+        /* every string appears twice in the batch */
+        const int length = snprintf(chars, sizeof(chars), "many-%ju", i / 2);
+        size_t count;
+        assert_true(sea_turtle_string_init(&string[i], chars, length, &count));
+        strings[i] = &string[i];
+    }
+    struct triggerfish_strong *out[32];
+    assert_true(pufferfish_sharded_string_pool_get_many(&object, strings, 32,
+                                                        out));
+    for (uintmax_t i = 0; i < 32; i++) {
+        struct sea_turtle_string *str;
+        assert_true(triggerfish_strong_instance(out[i], (void **) &str));
+        assert_int_equal(sea_turtle_string_compare(strings[i], str), 0);
+        struct triggerfish_strong *other;
+        assert_true(pufferfish_sharded_string_pool_get(&object, strings[i],
+                                                       &other));
+        assert_ptr_equal(out[i], other);
+        assert_true(triggerfish_strong_release(other));
+    }
+    for (uintmax_t i = 0; i < 32; i += 2) {
+        assert_ptr_equal(out[i], out[i + 1]);
+    }
+    for (uintmax_t i = 0; i < 32; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+        assert_true(sea_turtle_string_invalidate(&string[i]));
+    }
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(&object, 4, 0));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    const struct sea_turtle_string *strings[] = {&string};
+    struct triggerfish_strong *out[1];
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_false(pufferfish_sharded_string_pool_get_many(&object, strings, 1,
+                                                         out));
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_int_equal(
+            PUFFERFISH_SHARDED_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+            pufferfish_error);
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_shrink_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_shrink(NULL));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static uintmax_t shards_count(
+        const struct pufferfish_sharded_string_pool *const object) {
+    uintmax_t count = 0;
+    for (uintmax_t i = 0; i < object->count; i++) {
+        count += object->shards[i].pool.count;
+    }
+    return count;
+}
+
+static void check_shrink(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"shrink";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_sharded_string_pool_get(&object, &string, &out));
+    assert_int_equal(shards_count(&object), 1);
+    assert_true(pufferfish_sharded_string_pool_shrink(&object));
+    assert_true(triggerfish_strong_release(out));
+    assert_int_equal(shards_count(&object), 1);
+    assert_true(pufferfish_sharded_string_pool_shrink(&object));
+    assert_int_equal(shards_count(&object), 0);
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_stats_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_stats(NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_stats_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_sharded_string_pool_stats((void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_SHARDED_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_stats(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_sharded_string_pool object;
+    assert_true(pufferfish_sharded_string_pool_init(
+            &object, 4, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct triggerfish_strong *out[16];
+    for (uintmax_t i = 0; i < 16; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "stats-%ju", i);
+        assert_true(pufferfish_sharded_string_pool_get_chars(
+                &object, chars, length, NULL, &out[i]));
+    }
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_sharded_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries, 16);
+    assert_int_equal(stats.live, 16);
+#ifndef PUFFERFISH_NO_STATS
+    assert_int_equal(stats.misses, 16);
+#endif
+    for (uintmax_t i = 0; i < 16; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+    }
+    assert_true(pufferfish_sharded_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_invalidate_error_on_object_is_null),
+            cmocka_unit_test(check_init_error_on_object_is_null),
+            cmocka_unit_test(check_init_error_on_count_is_zero),
+            cmocka_unit_test(check_init_error_on_flags_are_invalid),
+            cmocka_unit_test(check_init_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_init),
+            cmocka_unit_test(check_get_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_string_is_null),
+            cmocka_unit_test(check_get_error_on_out_is_null),
+            cmocka_unit_test(check_get),
+            cmocka_unit_test(check_get_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_get_chars_error_on_object_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_is_null),
+            cmocka_unit_test(check_get_chars_error_on_out_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_are_malformed),
+            cmocka_unit_test(check_get_chars),
+            cmocka_unit_test(check_get_many_error_on_object_is_null),
+            cmocka_unit_test(check_get_many_error_on_strings_is_null),
+            cmocka_unit_test(check_get_many_error_on_out_is_null),
+            cmocka_unit_test(check_get_many),
+            cmocka_unit_test(check_get_many_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_shrink_error_on_object_is_null),
+            cmocka_unit_test(check_shrink),
+            cmocka_unit_test(check_stats_error_on_object_is_null),
+            cmocka_unit_test(check_stats_error_on_out_is_null),
+            cmocka_unit_test(check_stats),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,545 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <sea-turtle.h>
+#include <triggerfish.h>
+#include <pufferfish.h>
+
+#include <test/cmocka.h>
+
+#define STRINGS_COUNT                                               1000
+
+static struct sea_turtle_string strings[STRINGS_COUNT];
+static const struct sea_turtle_string *pointers[STRINGS_COUNT];
+
+static void strings_init(void) {
+    for (uintmax_t i = 0; i < STRINGS_COUNT; i++) {
+        char chars[32];
+        const int length = snprintf(chars, sizeof(chars), "keyword-%ju", i);
+        size_t count;
+        assert_true(sea_turtle_string_init(&strings[i], chars, length,
+                                           &count));
+        pointers[i] = &strings[i];
+    }
+}
+
+static void strings_invalidate(void) {
+    for (uintmax_t i = 0; i < STRINGS_COUNT; i++) {
+        assert_true(sea_turtle_string_invalidate(&strings[i]));
+    }
+}
+
+static void check_invalidate_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_invalidate(NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_init(NULL, (void *) 1, 1,
+                                                    NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_strings_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_static_string_pool object;
+    assert_false(pufferfish_static_string_pool_init(&object, NULL, 1, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    const struct sea_turtle_string *const nulls[] = {NULL};
+    assert_false(pufferfish_static_string_pool_init(&object, nulls, 1, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_count_is_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_static_string_pool object;
+    assert_false(pufferfish_static_string_pool_init(&object, (void *) 1, 0,
+                                                    NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_COUNT_IS_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_strings_are_not_distinct(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    pointers[STRINGS_COUNT - 1] = pointers[0];
+    struct pufferfish_static_string_pool object;
+    assert_false(pufferfish_static_string_pool_init(&object, pointers,
+                                                    STRINGS_COUNT, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRINGS_ARE_NOT_DISTINCT,
+                     pufferfish_error);
+    strings_invalidate();
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_static_string_pool object;
+    malloc_is_overridden = calloc_is_overridden = true;
+    assert_false(pufferfish_static_string_pool_init(&object, pointers,
+                                                    STRINGS_COUNT, NULL));
+    malloc_is_overridden = calloc_is_overridden = false;
+    assert_int_equal(
+            PUFFERFISH_STATIC_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+            pufferfish_error);
+    strings_invalidate();
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init(&object, pointers,
+                                                   STRINGS_COUNT, NULL));
+    assert_int_equal(object.table.hash_id, PUFFERFISH_HASH_ID);
+    assert_int_equal(object.table.count, STRINGS_COUNT);
+    assert_null(object.fallback);
+    /* every string is on its own slot */
+    bool seen[STRINGS_COUNT] = {0};
+    for (uintmax_t i = 0; i < STRINGS_COUNT; i++) {
+        uintmax_t slot;
+        assert_true(pufferfish_static_string_pool_find(
+                &object, strings[i].data, strings[i].size, NULL, &slot));
+        assert_true(slot < STRINGS_COUNT);
+        assert_false(seen[slot]);
+        seen[slot] = true;
+        assert_memory_equal(object.table.strings[slot].data, strings[i].data,
+                            strings[i].size);
+    }
+    strings_invalidate();
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_table_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_init_with_table(
+            NULL, (void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_table_error_on_table_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_static_string_pool object;
+    assert_false(pufferfish_static_string_pool_init_with_table(
+            &object, NULL, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static const uint32_t keywords_seeds[] = {UINT32_C(0)};
+
+static void check_init_with_table_error_on_table_is_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_static_string_pool object;
+    uintmax_t hash;
+    pufferfish_hash("if", 2, &hash);
+    const struct pufferfish_static_string_pool_string keywords_strings[] = {
+            {"if", 2, 2, hash},
+            {"else", 4, 4, hash}
+    };
+    struct pufferfish_static_string_pool_table table = {
+            .hash_id = PUFFERFISH_HASH_ID + 1,
+            .count = 1,
+            .buckets = 1,
+            .seeds = keywords_seeds,
+            .strings = keywords_strings
+    };
+    assert_false(pufferfish_static_string_pool_init_with_table(
+            &object, &table, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_MALFORMED,
+                     pufferfish_error);
+    /* two strings cannot share a slot */
+    table.hash_id = PUFFERFISH_HASH_ID;
+    table.count = 2;
+    assert_false(pufferfish_static_string_pool_init_with_table(
+            &object, &table, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_TABLE_IS_MALFORMED,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_table(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t hash;
+    pufferfish_hash("if", 2, &hash);
+    const struct pufferfish_static_string_pool_string keywords_strings[] = {
+            {"if", 2, 2, hash}
+    };
+    const struct pufferfish_static_string_pool_table table = {
+            .hash_id = PUFFERFISH_HASH_ID,
+            .count = 1,
+            .buckets = 1,
+            .seeds = keywords_seeds,
+            .strings = keywords_strings
+    };
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init_with_table(
+            &object, &table, NULL));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_static_string_pool_get_chars(&object, "if", 2, NULL,
+                                                        &out));
+    const struct sea_turtle_string *string;
+    assert_true(triggerfish_strong_instance(out, (void **) &string));
+    /* contents are those of the table, not a copy */
+    assert_ptr_equal(string->data, keywords_strings[0].data);
+    assert_int_equal(string->size, 2);
+    assert_int_equal(string->count, 2);
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    /* retrieved strings outlive the static string pool */
+    assert_true(triggerfish_strong_instance(out, (void **) &string));
+    assert_int_equal(string->size, 2);
+    assert_true(triggerfish_strong_release(out));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_symbol_error_on_string_is_foreign(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t hash;
+    pufferfish_hash("if", 2, &hash);
+    const struct pufferfish_static_string_pool_string keywords_strings[] = {
+            {"if", 2, 2, hash}
+    };
+    const struct pufferfish_static_string_pool_table table = {
+            .hash_id = PUFFERFISH_HASH_ID,
+            .count = 1,
+            .buckets = 1,
+            .seeds = keywords_seeds,
+            .strings = keywords_strings
+    };
+    struct pufferfish_string_pool fallback;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &fallback, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                       | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS));
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init_with_table(
+            &object, &table, &fallback));
+    struct triggerfish_strong *held;
+    assert_true(pufferfish_static_string_pool_get_chars(&object, "if", 2, NULL,
+                                                        &held));
+    struct triggerfish_strong *fallen;
+    assert_true(pufferfish_static_string_pool_get_chars(&object, "else", 4,
+                                                        NULL, &fallen));
+    /* strings held by the static string pool have no symbol */
+    uint32_t symbol;
+    assert_false(pufferfish_string_pool_symbol(&fallback, held, &symbol));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_FOREIGN,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_symbol(&fallback, fallen, &symbol));
+    assert_true(triggerfish_strong_release(fallen));
+    assert_true(triggerfish_strong_release(held));
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&fallback));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_header(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t hash;
+    pufferfish_hash("if", 2, &hash);
+    const struct pufferfish_static_string_pool_string keywords_strings[] = {
+            {"if", 2, 2, hash}
+    };
+    const struct pufferfish_static_string_pool_table table = {
+            .hash_id = PUFFERFISH_HASH_ID,
+            .count = 1,
+            .buckets = 1,
+            .seeds = keywords_seeds,
+            .strings = keywords_strings
+    };
+    struct pufferfish_string_pool fallback;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &fallback, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init_with_table(
+            &object, &table, &fallback));
+    struct triggerfish_strong *held;
+    assert_true(pufferfish_static_string_pool_get_chars(&object, "if", 2, NULL,
+                                                        &held));
+    struct triggerfish_strong *fallen;
+    assert_true(pufferfish_static_string_pool_get_chars(&object, "else", 4,
+                                                        NULL, &fallen));
+    /* strings held by the static string pool have a header as well */
+    struct pufferfish_string_pool_header header;
+    assert_true(pufferfish_string_pool_header(held, &header));
+    const struct sea_turtle_string *string;
+    assert_true(triggerfish_strong_instance(held, (void **) &string));
+    assert_ptr_equal(header.string, string);
+    assert_int_equal(header.hash, hash);
+    assert_int_equal(header.size, 2);
+    assert_true(pufferfish_string_pool_header(fallen, &header));
+    assert_true(triggerfish_strong_instance(fallen, (void **) &string));
+    assert_ptr_equal(header.string, string);
+    pufferfish_hash("else", 4, &hash);
+    assert_int_equal(header.hash, hash);
+    assert_int_equal(header.size, 4);
+    assert_true(triggerfish_strong_release(fallen));
+    assert_true(triggerfish_strong_release(held));
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&fallback));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_get(NULL, (void *) 1,
+                                                   (void *) 1));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_get((void *) 1, NULL,
+                                                   (void *) 1));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_get((void *) 1, (void *) 1,
+                                                   NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_error_on_string_not_found(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init(&object, pointers,
+                                                   STRINGS_COUNT - 1, NULL));
+    struct triggerfish_strong *out;
+    assert_false(pufferfish_static_string_pool_get(
+            &object, &strings[STRINGS_COUNT - 1], &out));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND,
+                     pufferfish_error);
+    strings_invalidate();
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_string_pool fallback;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &fallback, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init(&object, pointers,
+                                                   STRINGS_COUNT - 1,
+                                                   &fallback));
+    for (uintmax_t i = 0; i < STRINGS_COUNT - 1; i++) {
+        struct triggerfish_strong *out;
+        assert_true(pufferfish_static_string_pool_get(&object, &strings[i],
+                                                      &out));
+        const struct sea_turtle_string *string;
+        assert_true(triggerfish_strong_instance(out, (void **) &string));
+        assert_int_equal(string->size, strings[i].size);
+        assert_int_equal(string->count, strings[i].count);
+        assert_memory_equal(string->data, strings[i].data, strings[i].size);
+        struct triggerfish_strong *other;
+        assert_true(pufferfish_static_string_pool_get(&object, &strings[i],
+                                                      &other));
+        assert_ptr_equal(out, other);
+        assert_true(triggerfish_strong_release(other));
+        assert_true(triggerfish_strong_release(out));
+    }
+    /* strings not held come from the fallback string pool */
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_static_string_pool_get(
+            &object, &strings[STRINGS_COUNT - 1], &out));
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get(
+            &fallback, &strings[STRINGS_COUNT - 1], &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    strings_invalidate();
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&fallback));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_get_chars(NULL, "", 0, NULL,
+                                                         (void *) 1));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_get_chars((void *) 1, NULL, 0,
+                                                         NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_get_chars((void *) 1, "", 0,
+                                                         NULL, NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_are_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_string_pool fallback;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &fallback, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init(&object, pointers,
+                                                   STRINGS_COUNT, &fallback));
+    struct triggerfish_strong *out;
+    const char chars[] = {(char) 0xff, (char) 0xfe};
+    assert_false(pufferfish_static_string_pool_get_chars(
+            &object, chars, sizeof(chars), NULL, &out));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_CHARS_ARE_MALFORMED,
+                     pufferfish_error);
+    strings_invalidate();
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&fallback));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_string_pool fallback;
+    assert_true(pufferfish_string_pool_init(&fallback));
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init(&object, pointers,
+                                                   STRINGS_COUNT, &fallback));
+    uintmax_t hash;
+    pufferfish_hash("keyword-7", 9, &hash);
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_static_string_pool_get_chars(
+            &object, "keyword-7", 9, &hash, &out));
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_static_string_pool_get(&object, &strings[7],
+                                                  &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_static_string_pool_get_chars(
+            &object, "unknown", 7, NULL, &out));
+    const struct sea_turtle_string *string;
+    assert_true(triggerfish_strong_instance(out, (void **) &string));
+    assert_memory_equal(string->data, "unknown", 7);
+    assert_true(triggerfish_strong_release(out));
+    strings_invalidate();
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&fallback));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_find_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_find(NULL, "", 0, NULL,
+                                                    (void *) 1));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_find_error_on_chars_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_find((void *) 1, NULL, 0, NULL,
+                                                    (void *) 1));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_find_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_static_string_pool_find((void *) 1, "", 0, NULL,
+                                                    NULL));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_find_error_on_string_not_found(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    strings_init();
+    struct pufferfish_string_pool fallback;
+    assert_true(pufferfish_string_pool_init(&fallback));
+    struct pufferfish_static_string_pool object;
+    assert_true(pufferfish_static_string_pool_init(&object, pointers,
+                                                   STRINGS_COUNT, &fallback));
+    uintmax_t slot;
+    assert_false(pufferfish_static_string_pool_find(&object, "unknown", 7,
+                                                    NULL, &slot));
+    assert_int_equal(PUFFERFISH_STATIC_STRING_POOL_ERROR_STRING_NOT_FOUND,
+                     pufferfish_error);
+    strings_invalidate();
+    assert_true(pufferfish_static_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_invalidate(&fallback));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_invalidate_error_on_object_is_null),
+            cmocka_unit_test(check_init_error_on_object_is_null),
+            cmocka_unit_test(check_init_error_on_strings_is_null),
+            cmocka_unit_test(check_init_error_on_count_is_zero),
+            cmocka_unit_test(check_init_error_on_strings_are_not_distinct),
+            cmocka_unit_test(check_init_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_init),
+            cmocka_unit_test(check_init_with_table_error_on_object_is_null),
+            cmocka_unit_test(check_init_with_table_error_on_table_is_null),
+            cmocka_unit_test(
+                    check_init_with_table_error_on_table_is_malformed),
+            cmocka_unit_test(check_init_with_table),
+            cmocka_unit_test(check_symbol_error_on_string_is_foreign),
+            cmocka_unit_test(check_header),
+            cmocka_unit_test(check_get_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_string_is_null),
+            cmocka_unit_test(check_get_error_on_out_is_null),
+            cmocka_unit_test(check_get_error_on_string_not_found),
+            cmocka_unit_test(check_get),
+            cmocka_unit_test(check_get_chars_error_on_object_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_is_null),
+            cmocka_unit_test(check_get_chars_error_on_out_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_are_malformed),
+            cmocka_unit_test(check_get_chars),
+            cmocka_unit_test(check_find_error_on_object_is_null),
+            cmocka_unit_test(check_find_error_on_chars_is_null),
+            cmocka_unit_test(check_find_error_on_out_is_null),
+            cmocka_unit_test(check_find_error_on_string_not_found),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
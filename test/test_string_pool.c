@@ -1,14 +1,21 @@
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 #include <setjmp.h>
 #include <cmocka.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <sea-turtle.h>
 #include <triggerfish.h>
 #include <pufferfish.h>
 
 #include <test/cmocka.h>
 
+#include "arena.h"
+#include "snapshot.h"
+
 static void check_invalidate_error_on_object_is_null(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
     assert_false(pufferfish_string_pool_invalidate(NULL));
@@ -45,6 +52,83 @@ static void check_init(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
 }
 
+static void check_init_with_flags_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_init_with_flags(
+            NULL, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags_error_on_flags_are_invalid(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_false(pufferfish_string_pool_init_with_flags(&object, UINTMAX_MAX));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    assert_int_equal(object.flags, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags_error_on_memory_allocation_failed(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_false(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags_error_on_lock_free_read_without_hash_table(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_false(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags_error_on_symbols_without_hash_table(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_false(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_SYMBOLS));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags_error_on_thread_cache_without_lock_free_read(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_false(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
 static void check_get_error_on_object_is_null(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
     assert_false(pufferfish_string_pool_get(NULL, (void *) 1, (void *) 1));
@@ -72,12 +156,15 @@ static void check_get_error_on_out_is_null(void **state) {
 static void check_get_error_on_concurrent_limit_reached(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
     struct pufferfish_string_pool object = {};
+    /* contend the read lock so that the blocking acquisition is reached */
+    assert_int_equal(0, pthread_rwlock_wrlock(&object.lock));
     pthread_rwlock_rdlock_is_overridden = true;
     will_return(cmocka_test_pthread_rwlock_rdlock, EAGAIN);
     assert_false(pufferfish_string_pool_get(&object, (void *) 1, (void *) 1));
     pthread_rwlock_rdlock_is_overridden = false;
     assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_CONCURRENCY_LIMIT_REACHED,
                      pufferfish_error);
+    assert_int_equal(0, pthread_rwlock_unlock(&object.lock));
     seahorse_error = SEAHORSE_ERROR_NONE;
 }
 
@@ -124,51 +211,2278 @@ static void check_get_error_on_memory_allocation_failed(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
 }
 
-static void check_shrink_error_on_object_is_null(void **state) {
+static void check_get_with_hash_table(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
-    assert_false(pufferfish_string_pool_shrink(NULL));
-    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_true(triggerfish_strong_count(out, &count));
+    assert_int_equal(count, 1);
+    struct sea_turtle_string *str;
+    assert_true(triggerfish_strong_instance(out, (void **) &str));
+    assert_ptr_not_equal(&string, str);
+    assert_int_equal(sea_turtle_string_compare(&string, str), 0);
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get(&object, &string, &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_count(out, &count));
+    assert_int_equal(count, 2);
+    assert_true(triggerfish_strong_release(other));
+    const char chars_other[] = u8"other";
+    struct sea_turtle_string string_other;
+    assert_true(sea_turtle_string_init(&string_other, chars_other,
+                                       sizeof(chars_other), &count));
+    assert_true(pufferfish_string_pool_get(&object, &string_other, &other));
+    assert_ptr_not_equal(out, other);
+    assert_int_equal(object.count, 2);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(sea_turtle_string_invalidate(&string_other));
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_with_hash_table_error_on_memory_allocation_failed(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_false(pufferfish_string_pool_get(&object, &string, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
                      pufferfish_error);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_string_pool_invalidate(&object));
     seahorse_error = SEAHORSE_ERROR_NONE;
 }
 
-static void check_shrink(void **state) {
+static void check_get_with_hash_table_after_release(void **state) {
     seahorse_error = SEAHORSE_ERROR_NONE;
     struct pufferfish_string_pool object;
-    assert_true(pufferfish_string_pool_init(&object));
-    const char chars[] = u8"shrink";
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"release";
     size_t count;
     struct sea_turtle_string string;
     assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
     struct triggerfish_strong *out;
     assert_true(pufferfish_string_pool_get(&object, &string, &out));
-    assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map, &count));
-    assert_int_equal(count, 1);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_int_equal(object.count, 1);
+    struct sea_turtle_string *str;
+    assert_true(triggerfish_strong_instance(out, (void **) &str));
+    assert_int_equal(sea_turtle_string_compare(&string, str), 0);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_with_hash_table_single_allocation(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct triggerfish_strong *out[100];
+    const uintmax_t limit = sizeof(out) / sizeof(out[0]);
+    for (uintmax_t i = 0; i < limit; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "entry-%04ju", i);
+        size_t count;
+        struct sea_turtle_string string;
+        assert_true(sea_turtle_string_init(&string, chars, length, &count));
+        assert_true(pufferfish_string_pool_get(&object, &string, &out[i]));
+        assert_true(sea_turtle_string_invalidate(&string));
+    }
+    /* one block per entry holding both the entry and its contents */
+    assert_int_equal(object.arena->blocks, limit);
+    const uintmax_t block = object.arena->allocated / limit;
+    assert_int_equal(object.arena->allocated, block * limit);
+    assert_true(block <= 64 + 16);
+    for (uintmax_t i = 0; i < limit; i++) {
+        struct sea_turtle_string *str;
+        assert_true(triggerfish_strong_instance(out[i], (void **) &str));
+        assert_true(str->data > (char *) str);
+        assert_true(str->data + str->size < (char *) str + block);
+    }
+    const uintmax_t reserved = object.arena->reserved;
+    for (uintmax_t i = 0; i < limit; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+    }
     assert_true(pufferfish_string_pool_shrink(&object));
+    assert_int_equal(object.arena->blocks, 0);
+    assert_int_equal(object.arena->allocated, 0);
+    /* freed blocks are reused */
+    for (uintmax_t i = 0; i < limit; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "again-%04ju", i);
+        size_t count;
+        struct sea_turtle_string string;
+        assert_true(sea_turtle_string_init(&string, chars, length, &count));
+        assert_true(pufferfish_string_pool_get(&object, &string, &out[i]));
+        assert_true(sea_turtle_string_invalidate(&string));
+    }
+    assert_int_equal(object.arena->reserved, reserved);
+    for (uintmax_t i = 0; i < limit; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_with_lock_free_read(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ));
+    const char chars[] = u8"get";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    struct triggerfish_strong *other;
+    /* a hit must not need the lock */
+    assert_int_equal(0, pthread_rwlock_wrlock(&object.lock));
+    assert_true(pufferfish_string_pool_get(&object, &string, &other));
+    assert_int_equal(0, pthread_rwlock_unlock(&object.lock));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_count(out, &count));
+    assert_int_equal(count, 2);
+    assert_true(triggerfish_strong_release(other));
     assert_true(triggerfish_strong_release(out));
-    assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map, &count));
-    assert_int_equal(count, 1);
     assert_true(pufferfish_string_pool_shrink(&object));
-    assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map, &count));
-    assert_int_equal(count, 0);
+    assert_int_equal(object.count, 0);
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_int_equal(object.count, 1);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_get_chars(NULL, (void *) 1, 1, NULL,
+                                                  (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_get_chars((void *) 1, NULL, 1, NULL,
+                                                  (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_get_chars((void *) 1, (void *) 1, 1,
+                                                  NULL, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_error_on_chars_are_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = "\xff\xfe";
+    struct triggerfish_strong *out;
+    assert_false(pufferfish_string_pool_get_chars(&object, chars,
+                                                  sizeof(chars) - 1, NULL,
+                                                  &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void get_chars_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    const char chars[] = u8"chars";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars) - 1,
+                                       &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    uintmax_t hash;
+    pufferfish_hash(chars, sizeof(chars) - 1, &hash);
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, &hash,
+                                                 &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    /* a miss adds the string */
+    assert_true(pufferfish_string_pool_get_chars(&object, chars, 4, NULL,
+                                                 &out));
+    struct sea_turtle_string *str;
+    assert_true(triggerfish_strong_instance(out, (void **) &str));
+    assert_int_equal(str->size, 4);
+    assert_memory_equal(str->data, chars, 4);
+    assert_true(triggerfish_strong_release(out));
     assert_true(sea_turtle_string_invalidate(&string));
     assert_true(pufferfish_string_pool_invalidate(&object));
 }
 
+static void check_get_chars(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    get_chars_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    get_chars_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    get_chars_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                         | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_chars_with_hash_table_hit_does_not_allocate(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"hit";
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &out));
+    struct triggerfish_strong *other;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &other));
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_get_many(NULL, (void *) 1, 1,
+                                                 (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_strings_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_get_many((void *) 1, NULL, 1,
+                                                 (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    const struct sea_turtle_string *strings[] = {(void *) 1, NULL};
+    assert_false(pufferfish_string_pool_get_many((void *) 1, strings, 2,
+                                                 (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_get_many((void *) 1, (void *) 1, 1,
+                                                 NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void get_many_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    const char *const chars[] = {u8"alpha", u8"beta", u8"alpha", u8"gamma"};
+    struct sea_turtle_string string[4];
+    const struct sea_turtle_string *strings[4];
+    for (uintmax_t i = 0; i < 4; i++) {
+        size_t count;
+        assert_true(sea_turtle_string_init(&string[i], chars[i],
+                                           strlen(chars[i]), &count));
+        strings[i] = &string[i];
+    }
+    struct triggerfish_strong *hit;
+    assert_true(pufferfish_string_pool_get(&object, strings[1], &hit));
+    struct triggerfish_strong *out[4];
+    assert_true(pufferfish_string_pool_get_many(&object, strings, 4, out));
+    assert_ptr_equal(out[1], hit);
+    assert_ptr_equal(out[0], out[2]);
+    assert_ptr_not_equal(out[0], out[3]);
+    for (uintmax_t i = 0; i < 4; i++) {
+        struct sea_turtle_string *str;
+        assert_true(triggerfish_strong_instance(out[i], (void **) &str));
+        assert_int_equal(sea_turtle_string_compare(strings[i], str), 0);
+    }
+    size_t count;
+    assert_true(triggerfish_strong_count(out[0], &count));
+    assert_int_equal(count, 2);
+    assert_true(triggerfish_strong_release(hit));
+    for (uintmax_t i = 0; i < 4; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+        assert_true(sea_turtle_string_invalidate(&string[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_get_many(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    get_many_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_with_hash_table(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    get_many_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    get_many_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                        | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_many_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char *const chars[] = {u8"hit", u8"miss"};
+    struct sea_turtle_string string[2];
+    const struct sea_turtle_string *strings[2];
+    for (uintmax_t i = 0; i < 2; i++) {
+        size_t count;
+        assert_true(sea_turtle_string_init(&string[i], chars[i],
+                                           strlen(chars[i]), &count));
+        strings[i] = &string[i];
+    }
+    struct triggerfish_strong *hit;
+    assert_true(pufferfish_string_pool_get(&object, strings[0], &hit));
+    struct triggerfish_strong *out[2];
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_false(pufferfish_string_pool_get_many(&object, strings, 2, out));
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+                     pufferfish_error);
+    /* the hit retrieved before the failure has been released again */
+    size_t count;
+    assert_true(triggerfish_strong_count(hit, &count));
+    assert_int_equal(count, 1);
+    assert_true(triggerfish_strong_release(hit));
+    for (uintmax_t i = 0; i < 2; i++) {
+        assert_true(sea_turtle_string_invalidate(&string[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_load(NULL, (void *) 1, 1, 1,
+                                             (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_error_on_strings_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_load((void *) 1, NULL, 1, 1,
+                                             (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    const struct sea_turtle_string *strings[] = {(void *) 1, NULL};
+    assert_false(pufferfish_string_pool_load((void *) 1, strings, 2, 1,
+                                             (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_load((void *) 1, (void *) 1, 1, 1,
+                                             NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_error_on_threads_are_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_load((void *) 1, (void *) 1, 1, 0,
+                                             (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void load_with_flags(const uintmax_t flags, const uintmax_t count) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    struct sea_turtle_string *const string = malloc(count * sizeof(*string));
+    const struct sea_turtle_string **const strings = malloc(
+            count * sizeof(*strings));
+    struct triggerfish_strong **const out = malloc(count * sizeof(*out));
+    assert_non_null(string);
+    assert_non_null(strings);
+    assert_non_null(out);
+    /* every string appears twice, the second half repeating the first */
+    for (uintmax_t i = 0; i < count; i++) {
+        char chars[24];
+        const int length = snprintf(chars, sizeof(chars), "load-%ju",
+                                    i % (count / 2));
+        size_t size;
+        assert_true(sea_turtle_string_init(&string[i], chars, length, &size));
+        strings[i] = &string[i];
+    }
+    struct triggerfish_strong *hit;
+    assert_true(pufferfish_string_pool_get(&object, strings[1], &hit));
+    assert_true(pufferfish_string_pool_load(&object, strings, count, 4, out));
+    assert_ptr_equal(out[1], hit);
+    for (uintmax_t i = 0; i < count; i++) {
+        assert_ptr_equal(out[i], out[i % (count / 2)]);
+        struct sea_turtle_string *str;
+        assert_true(triggerfish_strong_instance(out[i], (void **) &str));
+        assert_int_equal(sea_turtle_string_compare(strings[i], str), 0);
+    }
+    for (uintmax_t i = 0; i < count / 2; i++) {
+        struct triggerfish_strong *other;
+        assert_true(pufferfish_string_pool_get(&object, strings[i], &other));
+        assert_ptr_equal(out[i], other);
+        assert_true(triggerfish_strong_release(other));
+    }
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries, count / 2);
+    assert_true(triggerfish_strong_release(hit));
+    for (uintmax_t i = 0; i < count; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+        assert_true(sea_turtle_string_invalidate(&string[i]));
+    }
+    free(string);
+    free(strings);
+    free(out);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_load(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    load_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE, 8);
+    load_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE, 8);
+    load_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                    | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                    | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS, 8);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_with_threads(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    /* large enough to be split among all four threads */
+    load_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE, 1 << 15);
+    load_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                    | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ, 1 << 15);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char *const chars[] = {u8"hit", u8"miss"};
+    struct sea_turtle_string string[2];
+    const struct sea_turtle_string *strings[2];
+    for (uintmax_t i = 0; i < 2; i++) {
+        size_t count;
+        assert_true(sea_turtle_string_init(&string[i], chars[i],
+                                           strlen(chars[i]), &count));
+        strings[i] = &string[i];
+    }
+    struct triggerfish_strong *hit;
+    assert_true(pufferfish_string_pool_get(&object, strings[0], &hit));
+    struct triggerfish_strong *out[2];
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_false(pufferfish_string_pool_load(&object, strings, 2, 1, out));
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+                     pufferfish_error);
+    size_t count;
+    assert_true(triggerfish_strong_count(hit, &count));
+    assert_int_equal(count, 1);
+    assert_true(triggerfish_strong_release(hit));
+    for (uintmax_t i = 0; i < 2; i++) {
+        assert_true(sea_turtle_string_invalidate(&string[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_file_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t count;
+    assert_false(pufferfish_string_pool_load_file(NULL, (void *) 1, 1,
+                                                  (void *) 1, &count));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_file_error_on_path_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t count;
+    assert_false(pufferfish_string_pool_load_file((void *) 1, NULL, 1,
+                                                  (void *) 1, &count));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_file_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t count;
+    assert_false(pufferfish_string_pool_load_file((void *) 1, (void *) 1, 1,
+                                                  NULL, &count));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    assert_false(pufferfish_string_pool_load_file((void *) 1, (void *) 1, 1,
+                                                  (void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_file_error_on_threads_are_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t count;
+    assert_false(pufferfish_string_pool_load_file((void *) 1, (void *) 1, 0,
+                                                  (void *) 1, &count));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_THREADS_ARE_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_file_error_on_io_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init(&object));
+    struct triggerfish_strong **out;
+    uintmax_t count;
+    assert_false(pufferfish_string_pool_load_file(
+            &object, "/nonexistent/pufferfish.lines", 1, &out, &count));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_IO_FAILED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_load_file_error_on_chars_are_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    char path[] = "/tmp/pufferfish-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    const char chars[] = "valid\n\xff\xfe\nalso valid\n";
+    assert_int_equal(write(fd, chars, sizeof(chars) - 1), sizeof(chars) - 1);
+    assert_int_equal(close(fd), 0);
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct triggerfish_strong **out;
+    uintmax_t count;
+    assert_false(pufferfish_string_pool_load_file(&object, path, 1, &out,
+                                                  &count));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED,
+                     pufferfish_error);
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries, 0);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_int_equal(unlink(path), 0);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void load_file_with_flags(const uintmax_t flags) {
+    char path[] = "/tmp/pufferfish-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    /* the empty line is a string, the final newline is not */
+    const char chars[] = "beta\nalpha\n\nbeta\ngamma\nalpha\n";
+    assert_int_equal(write(fd, chars, sizeof(chars) - 1), sizeof(chars) - 1);
+    assert_int_equal(close(fd), 0);
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    struct triggerfish_strong *hit;
+    assert_true(pufferfish_string_pool_get_chars(&object, "gamma", 5, NULL,
+                                                 &hit));
+    struct triggerfish_strong **out;
+    uintmax_t count;
+    assert_true(pufferfish_string_pool_load_file(&object, path, 4, &out,
+                                                 &count));
+    const char *const expected[] = {"beta", "alpha", "", "gamma"};
+    assert_int_equal(count, 4);
+    assert_ptr_equal(out[3], hit);
+    for (uintmax_t i = 0; i < count; i++) {
+        struct sea_turtle_string *str;
+        assert_true(triggerfish_strong_instance(out[i], (void **) &str));
+        assert_int_equal(str->size, strlen(expected[i]));
+        assert_memory_equal(str->data, expected[i], str->size);
+        assert_true(triggerfish_strong_release(out[i]));
+    }
+    free(out);
+    assert_true(triggerfish_strong_release(hit));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_int_equal(unlink(path), 0);
+}
+
+static void check_load_file(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    load_file_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    load_file_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_symbol_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_symbol(NULL, (void *) 1, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_symbol_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_symbol((void *) 1, NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_symbol_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_symbol((void *) 1, (void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_symbol_error_on_symbols_are_disabled(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    uint32_t symbol;
+    assert_false(pufferfish_string_pool_symbol(&object, (void *) 1, &symbol));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED,
+                     pufferfish_error);
+    struct triggerfish_strong *out;
+    assert_false(pufferfish_string_pool_resolve(&object, 0, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SYMBOLS_ARE_DISABLED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_symbol_error_on_string_is_foreign(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS));
+    struct pufferfish_string_pool other;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &other, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                    | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS));
+    const char chars[] = u8"foreign";
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(&other, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &out));
+    uint32_t symbol;
+    assert_false(pufferfish_string_pool_symbol(&object, out, &symbol));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_FOREIGN,
+                     pufferfish_error);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_invalidate(&other));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_resolve_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_resolve(NULL, 0, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_resolve_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_resolve((void *) 1, 0, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void symbols_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_SYMBOLS | flags));
+    struct triggerfish_strong *out;
+    assert_false(pufferfish_string_pool_resolve(&object, 0, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID,
+                     pufferfish_error);
+    struct triggerfish_strong *strong[100];
+    uint32_t symbols[100];
+    for (uintmax_t i = 0; i < 100; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "symbol-%ju", i);
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &strong[i]));
+        assert_true(pufferfish_string_pool_symbol(&object, strong[i],
+                                                  &symbols[i]));
+        /* symbols are dense */
+        assert_int_equal(symbols[i], i);
+    }
+    for (uintmax_t i = 0; i < 100; i++) {
+        assert_true(pufferfish_string_pool_resolve(&object, symbols[i], &out));
+        assert_ptr_equal(out, strong[i]);
+        assert_true(triggerfish_strong_release(out));
+    }
+    assert_false(pufferfish_string_pool_resolve(&object, 100, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID,
+                     pufferfish_error);
+    /* a released string that has not been removed keeps its symbol */
+    char chars[16];
+    int length = snprintf(chars, sizeof(chars), "symbol-%d", 7);
+    assert_true(triggerfish_strong_release(strong[7]));
+    assert_false(pufferfish_string_pool_resolve(&object, symbols[7], &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_get_chars(&object, chars, length, NULL,
+                                                 &strong[7]));
+    uint32_t symbol;
+    assert_true(pufferfish_string_pool_symbol(&object, strong[7], &symbol));
+    assert_int_equal(symbol, symbols[7]);
+    /* removed strings have their symbols handed out again */
+    assert_true(triggerfish_strong_release(strong[3]));
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_false(pufferfish_string_pool_resolve(&object, symbols[3], &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SYMBOL_IS_INVALID,
+                     pufferfish_error);
+    length = snprintf(chars, sizeof(chars), "symbol-%d", 100);
+    assert_true(pufferfish_string_pool_get_chars(&object, chars, length, NULL,
+                                                 &strong[3]));
+    assert_true(pufferfish_string_pool_symbol(&object, strong[3], &symbol));
+    assert_int_equal(symbol, symbols[3]);
+    for (uintmax_t i = 0; i < 100; i++) {
+        assert_true(triggerfish_strong_release(strong[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_symbol(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    symbols_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    symbols_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                       | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_shrink_step_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_shrink_step(NULL, 1, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_shrink_step_error_on_limit_is_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_shrink_step((void *) 1, 0,
+                                                    (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_shrink_step_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_shrink_step((void *) 1, 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void shrink_step_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    struct triggerfish_strong *out[40];
+    for (uintmax_t i = 0; i < 40; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "step-%02ju", i);
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &out[i]));
+    }
+    for (uintmax_t i = 0; i < 40; i += 2) {
+        assert_true(triggerfish_strong_release(out[i]));
+    }
+    bool done = false;
+    uintmax_t steps = 0;
+    while (!done) {
+        assert_true(pufferfish_string_pool_shrink_step(&object, 3, &done));
+        steps += 1;
+    }
+    assert_true(steps > 1);
+    uintmax_t count = object.count;
+    if (!(flags & PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE)) {
+        assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map,
+                                                           &count));
+    }
+    assert_int_equal(count, 20);
+    for (uintmax_t i = 1; i < 40; i += 2) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "step-%02ju", i);
+        struct triggerfish_strong *other;
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &other));
+        assert_ptr_equal(out[i], other);
+        assert_true(triggerfish_strong_release(other));
+        assert_true(triggerfish_strong_release(out[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_shrink_step(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    shrink_step_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    shrink_step_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    shrink_step_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                           | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_header_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool_header out;
+    assert_false(pufferfish_string_pool_header(NULL, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_header_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_header((void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void header_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    const char chars[] = u8"header";
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &out));
+    struct pufferfish_string_pool_header header;
+    assert_true(pufferfish_string_pool_header(out, &header));
+    uintmax_t hash;
+    pufferfish_hash(chars, sizeof(chars) - 1, &hash);
+    assert_int_equal(header.hash, hash);
+    assert_int_equal(header.size, sizeof(chars) - 1);
+    assert_int_equal(header.string->size, sizeof(chars) - 1);
+    assert_memory_equal(header.string->data, chars, sizeof(chars) - 1);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_header(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    header_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    header_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    header_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                      | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_same_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    bool out;
+    assert_false(pufferfish_string_pool_same(NULL, (void *) 1, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    assert_false(pufferfish_string_pool_same((void *) 1, NULL, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_same_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_same((void *) 1, (void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_same(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object, other;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &other, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"same";
+    const char different[] = u8"different";
+    struct triggerfish_strong *a, *b, *c, *d;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL, &a));
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL, &b));
+    assert_true(pufferfish_string_pool_get_chars(&object, different,
+                                                 sizeof(different) - 1, NULL,
+                                                 &c));
+    assert_true(pufferfish_string_pool_get_chars(&other, chars,
+                                                 sizeof(chars) - 1, NULL, &d));
+    bool out;
+    assert_true(pufferfish_string_pool_same(a, b, &out));
+    assert_true(out);
+    assert_true(pufferfish_string_pool_same(a, c, &out));
+    assert_false(out);
+    /* equal contents in another string pool are another string */
+    assert_true(pufferfish_string_pool_same(a, d, &out));
+    assert_false(out);
+    assert_true(triggerfish_strong_release(d));
+    assert_true(triggerfish_strong_release(c));
+    assert_true(triggerfish_strong_release(b));
+    assert_true(triggerfish_strong_release(a));
+    assert_true(pufferfish_string_pool_invalidate(&other));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_flags_error_on_auto_shrink_without_hash_table(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_false(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_FLAGS_ARE_INVALID,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_with_auto_shrink(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_AUTO_SHRINK));
+    for (uintmax_t i = 0; i < 1000; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "auto-%ju", i);
+        struct triggerfish_strong *out;
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &out));
+        assert_true(triggerfish_strong_release(out));
+    }
+    /* unused entries are removed without calling shrink */
+    assert_true(object.count < 1000 / 4);
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_int_equal(object.count, 0);
+    assert_int_equal(object.arena->deaths, 0);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_shrink_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_shrink(NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_shrink(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init(&object));
+    const char chars[] = u8"shrink";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map, &count));
+    assert_int_equal(count, 1);
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map, &count));
+    assert_int_equal(count, 1);
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_true(seahorse_red_black_tree_map_s_wr_count(&object.map, &count));
+    assert_int_equal(count, 0);
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_shrink_with_hash_table(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"shrink";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_int_equal(object.count, 1);
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_true(triggerfish_strong_release(out));
+    assert_int_equal(object.count, 1);
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_int_equal(object.count, 0);
+    assert_true(sea_turtle_string_invalidate(&string));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_invalidate_with_hash_table_while_referenced(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"invalidate";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    struct sea_turtle_string *str;
+    assert_true(triggerfish_strong_instance(out, (void **) &str));
+    assert_int_equal(sea_turtle_string_compare(&string, str), 0);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(sea_turtle_string_invalidate(&string));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_thread_cache_counters_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t value;
+    assert_false(pufferfish_string_pool_thread_cache_counters(NULL, &value));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    assert_false(pufferfish_string_pool_thread_cache_counters(&value, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_thread_lock_waits_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    uintmax_t value;
+    assert_false(pufferfish_string_pool_thread_lock_waits(NULL, &value));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    assert_false(pufferfish_string_pool_thread_lock_waits(&value, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_get_with_thread_cache(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    const uintmax_t flags = PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                            | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                            | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    const char chars[] = u8"cache";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    uintmax_t hits, misses;
+    assert_true(pufferfish_string_pool_thread_cache_counters(&hits, &misses));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    /* the second lookup finds the string in the hash table and caches it */
+    for (uintmax_t i = 0; i < 2; i++) {
+        struct triggerfish_strong *other;
+        assert_true(pufferfish_string_pool_get(&object, &string, &other));
+        assert_ptr_equal(out, other);
+        assert_true(triggerfish_strong_release(other));
+    }
+    uintmax_t h, m;
+    assert_true(pufferfish_string_pool_thread_cache_counters(&h, &m));
+    assert_int_equal(h, hits + 1);
+    assert_int_equal(m, misses + 2);
+    /* removing the entry makes the cached one stale */
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_int_equal(object.count, 0);
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    assert_true(pufferfish_string_pool_thread_cache_counters(&h, &m));
+    assert_int_equal(h, hits + 1);
+    assert_int_equal(m, misses + 3);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    /* a string pool reusing the same memory does not see the cached entry */
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get(&object, &string, &other));
+    assert_ptr_not_equal(out, other);
+    assert_true(pufferfish_string_pool_thread_cache_counters(&h, &m));
+    assert_int_equal(h, hits + 1);
+    assert_int_equal(m, misses + 4);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_true(sea_turtle_string_invalidate(&string));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_drain_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    bool out;
+    assert_false(pufferfish_string_pool_drain(NULL, 1, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_drain_error_on_limit_is_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    bool out;
+    assert_false(pufferfish_string_pool_drain((void *) 1, 0, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_LIMIT_IS_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_drain_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_drain((void *) 1, 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_drain_error_on_reclaim_is_disabled(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init(&object));
+    bool out;
+    assert_false(pufferfish_string_pool_drain(&object, 1, &out));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static uintmax_t drain_entries(struct pufferfish_string_pool *object) {
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(object, &stats));
+    return stats.entries;
+}
+
+static void drain_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, flags | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    for (uintmax_t i = 0; i < 3; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "drain-%ju", i);
+        struct triggerfish_strong *out;
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &out));
+        assert_true(triggerfish_strong_release(out));
+    }
+    /* released entries stay until the queue is drained */
+    assert_int_equal(drain_entries(&object), 3);
+    bool done;
+    assert_true(pufferfish_string_pool_drain(&object, 1, &done));
+    assert_false(done);
+    assert_int_equal(drain_entries(&object), 2);
+    assert_true(pufferfish_string_pool_drain(&object, UINTMAX_MAX, &done));
+    assert_true(done);
+    assert_int_equal(drain_entries(&object), 0);
+    /* a string added again before its dead entry is drained stays pooled */
+    const char chars[] = u8"again";
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &out));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &out));
+    assert_true(pufferfish_string_pool_drain(&object, UINTMAX_MAX, &done));
+    assert_true(done);
+    assert_int_equal(drain_entries(&object), 1);
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars,
+                                                 sizeof(chars) - 1, NULL,
+                                                 &other));
+    assert_ptr_equal(out, other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out));
+    /* shrinking drains the queue as well */
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_int_equal(drain_entries(&object), 0);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_drain(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    drain_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    drain_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    drain_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_invalidate_with_deferred_reclaim(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    const uintmax_t flags[] = {
+            PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE,
+            PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+    };
+    for (uintmax_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        struct pufferfish_string_pool object;
+        assert_true(pufferfish_string_pool_init_with_flags(
+                &object,
+                flags[i] | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+        const char dead[] = u8"dead";
+        struct triggerfish_strong *out;
+        assert_true(pufferfish_string_pool_get_chars(&object, dead,
+                                                     sizeof(dead) - 1, NULL,
+                                                     &out));
+        assert_true(triggerfish_strong_release(out));
+        const char live[] = u8"live";
+        assert_true(pufferfish_string_pool_get_chars(&object, live,
+                                                     sizeof(live) - 1, NULL,
+                                                     &out));
+        assert_true(pufferfish_string_pool_invalidate(&object));
+        /* the live string outlives the string pool */
+        const struct sea_turtle_string *string;
+        assert_true(triggerfish_strong_instance(out, (void **) &string));
+        assert_int_equal(string->size, sizeof(live) - 1);
+        assert_memory_equal(string->data, live, sizeof(live) - 1);
+        assert_true(triggerfish_strong_release(out));
+    }
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_invalidate_with_release_between_drain_and_detach(
+        void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE
+                     | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    const char *const chars[] = {u8"drained", u8"queued", u8"live"};
+    struct triggerfish_strong *out[3];
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_true(pufferfish_string_pool_get_chars(&object, chars[i],
+                                                     strlen(chars[i]), NULL,
+                                                     &out[i]));
+    }
+    assert_true(triggerfish_strong_release(out[0]));
+    bool drained;
+    assert_true(pufferfish_string_pool_drain(&object, UINTMAX_MAX, &drained));
+    assert_true(drained);
+    /* released after the last drain, its weak reference has expired */
+    assert_true(triggerfish_strong_release(out[1]));
+    /* a live entry for the same string takes over its node */
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get_chars(&object, chars[1],
+                                                 strlen(chars[1]), NULL,
+                                                 &other));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    /* the live strings outlive the string pool */
+    const struct triggerfish_strong *const live[] = {other, out[2]};
+    for (uintmax_t i = 0; i < 2; i++) {
+        const struct sea_turtle_string *string;
+        assert_true(triggerfish_strong_instance(live[i], (void **) &string));
+        assert_int_equal(string->size, strlen(chars[i + 1]));
+        assert_memory_equal(string->data, chars[i + 1], string->size);
+    }
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out[2]));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer_start_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_reclaimer_start(NULL, 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer_start_error_on_period_is_zero(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_reclaimer_start((void *) 1, 0));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_PERIOD_IS_ZERO,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer_start_error_on_reclaim_is_disabled(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init(&object));
+    assert_false(pufferfish_string_pool_reclaimer_start(&object, 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_RECLAIM_IS_DISABLED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer_start_error_on_reclaimer_is_running(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    assert_true(pufferfish_string_pool_reclaimer_start(&object, 1000000));
+    assert_false(pufferfish_string_pool_reclaimer_start(&object, 1000000));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_RUNNING,
+                     pufferfish_error);
+    /* invalidating stops the reclaimer */
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer_stop_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_reclaimer_stop(NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer_stop_error_on_reclaimer_is_stopped(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    assert_false(pufferfish_string_pool_reclaimer_stop(&object));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_RECLAIMER_IS_STOPPED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_reclaimer(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    assert_true(pufferfish_string_pool_reclaimer_start(&object, 1000000));
+    for (uintmax_t i = 0; i < 100; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "reclaim-%ju", i);
+        struct triggerfish_strong *out;
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &out));
+        assert_true(triggerfish_strong_release(out));
+    }
+    /* the reclaimer drains every millisecond */
+    for (uintmax_t i = 0; i < 5000 && drain_entries(&object); i++) {
+        assert_int_equal(usleep(1000), 0);
+    }
+    assert_int_equal(drain_entries(&object), 0);
+    assert_true(pufferfish_string_pool_reclaimer_stop(&object));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_set_budget_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_set_budget(NULL, 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_set_budget_error_on_hash_table_is_disabled(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init(&object));
+    assert_false(pufferfish_string_pool_set_budget(&object, 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_HASH_TABLE_IS_DISABLED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static uintmax_t budget_entries(struct pufferfish_string_pool *object) {
+    if (object->flags & PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM) {
+        bool done;
+        assert_true(pufferfish_string_pool_drain(object, UINTMAX_MAX,
+                                                 &done));
+    }
+    return drain_entries(object);
+}
+
+static struct triggerfish_strong *budget_get(
+        struct pufferfish_string_pool *object,
+        const char *prefix,
+        const uintmax_t i) {
+    char chars[32];
+    const int length = snprintf(chars, sizeof(chars), "%s-%ju", prefix, i);
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(object, chars, length, NULL,
+                                                 &out));
+    return out;
+}
+
+static void budget_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    /* strings in use when the budget is set are kept as well */
+    struct triggerfish_strong *const live = budget_get(&object, "live", 0);
+    assert_true(pufferfish_string_pool_set_budget(&object, 4));
+    assert_true(triggerfish_strong_release(live));
+    struct triggerfish_strong *out = budget_get(&object, "live", 0);
+    assert_ptr_equal(out, live);
+    assert_true(triggerfish_strong_release(out));
+    /* released strings are kept and found again */
+    struct triggerfish_strong *hot = NULL;
+    for (uintmax_t i = 0; i < 3; i++) {
+        out = budget_get(&object, "budget", i);
+        assert_true(triggerfish_strong_release(out));
+        if (!i) {
+            hot = out;
+        }
+    }
+    assert_int_equal(budget_entries(&object), 4);
+    /* misses over budget evict unused strings that are not retrieved */
+    for (uintmax_t i = 3; i < 40; i++) {
+        out = budget_get(&object, "budget", 0);
+        assert_ptr_equal(out, hot);
+        assert_true(triggerfish_strong_release(out));
+        out = budget_get(&object, "budget", i);
+        assert_true(triggerfish_strong_release(out));
+        assert_int_equal(budget_entries(&object), 4);
+    }
+    /* strings in use are never evicted */
+    struct triggerfish_strong *held[6];
+    for (uintmax_t i = 0; i < 6; i++) {
+        held[i] = budget_get(&object, "held", i);
+    }
+    assert_true(budget_entries(&object) >= 6);
+    for (uintmax_t i = 0; i < 6; i++) {
+        out = budget_get(&object, "held", i);
+        assert_ptr_equal(out, held[i]);
+        assert_true(triggerfish_strong_release(out));
+        assert_true(triggerfish_strong_release(held[i]));
+    }
+    out = budget_get(&object, "budget", 40);
+    assert_true(triggerfish_strong_release(out));
+    assert_int_equal(budget_entries(&object), 4);
+    /* shrinking leaves kept strings alone */
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_int_equal(budget_entries(&object), 4);
+    assert_true(pufferfish_string_pool_set_budget(&object, 0));
+    assert_int_equal(budget_entries(&object), 0);
+    /* kept strings are released on invalidation */
+    assert_true(pufferfish_string_pool_set_budget(&object, 8));
+    for (uintmax_t i = 0; i < 8; i++) {
+        out = budget_get(&object, "budget", i);
+        assert_true(triggerfish_strong_release(out));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_set_budget(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    budget_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    budget_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                      | PUFFERFISH_STRING_POOL_FLAG_SYMBOLS);
+    budget_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                      | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                      | PUFFERFISH_STRING_POOL_FLAG_THREAD_CACHE);
+    budget_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                      | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_set_budget_with_queued_deaths(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM));
+    assert_true(pufferfish_string_pool_set_budget(&object, 4));
+    struct triggerfish_strong *const hot = budget_get(&object, "hot", 0);
+    assert_true(triggerfish_strong_release(hot));
+    /* evicted strings stay queued as nothing drains, they must neither
+     * count as kept nor as evicted twice */
+    for (uintmax_t i = 0; i < 64; i++) {
+        struct triggerfish_strong *out = budget_get(&object, "hot", 0);
+        assert_ptr_equal(out, hot);
+        assert_true(triggerfish_strong_release(out));
+        out = budget_get(&object, "queued", i);
+        assert_true(triggerfish_strong_release(out));
+    }
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries - stats.dead, 4);
+#ifndef PUFFERFISH_NO_STATS
+    assert_int_equal(stats.evictions, 61);
+#endif
+    assert_int_equal(budget_entries(&object), 4);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_stats_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_stats(NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_stats_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_stats((void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void stats_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries, 0);
+    assert_int_equal(stats.hits, 0);
+    assert_int_equal(stats.misses, 0);
+    struct triggerfish_strong *out[3];
+    for (uintmax_t i = 0; i < 3; i++) {
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "stats-%ju", i);
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &out[i]));
+    }
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get_chars(&object, "stats-0", 7, NULL,
+                                                 &other));
+    assert_ptr_equal(out[0], other);
+    assert_true(triggerfish_strong_release(other));
+    assert_true(triggerfish_strong_release(out[1]));
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries, 3);
+    assert_int_equal(stats.live, 2);
+    assert_int_equal(stats.dead, 1);
+    assert_true(stats.bytes > 0);
+#ifndef PUFFERFISH_NO_STATS
+    assert_int_equal(stats.hits, 1);
+    assert_int_equal(stats.misses, 3);
+    /* lock free reads never hold the read lock they could give up */
+    assert_int_equal(stats.upgrades,
+                     flags & PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ
+                     ? 0 : 3);
+#endif
+    assert_true(pufferfish_string_pool_shrink(&object));
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    assert_int_equal(stats.entries, 2);
+    assert_int_equal(stats.dead, 0);
+    assert_true(triggerfish_strong_release(out[0]));
+    assert_true(triggerfish_strong_release(out[2]));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+/* retrieves a pooled string while the test holds the write lock */
+struct contended_read {
+    struct pufferfish_string_pool *object;
+    const struct sea_turtle_string *string;
+    struct triggerfish_strong *out;
+    uintmax_t waits;
+    uintmax_t wait_ns;
+};
+
+static void *contended_read_work(void *a) {
+    struct contended_read *const read = a;
+    uintmax_t waits, wait_ns;
+    assert_true(pufferfish_string_pool_thread_lock_waits(&waits, &wait_ns));
+    assert_true(pufferfish_string_pool_get(read->object, read->string,
+                                           &read->out));
+    assert_true(pufferfish_string_pool_thread_lock_waits(&read->waits,
+                                                         &read->wait_ns));
+    read->waits -= waits;
+    read->wait_ns -= wait_ns;
+    return NULL;
+}
+
+static void check_stats_on_contended_read_lock(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    const char chars[] = u8"contended";
+    size_t count;
+    struct sea_turtle_string string;
+    assert_true(sea_turtle_string_init(&string, chars, sizeof(chars), &count));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get(&object, &string, &out));
+    /* the hit only takes the read lock, the worker allocates nothing */
+    struct contended_read read = {
+            .object = &object,
+            .string = &string
+    };
+    pthread_t thread;
+    assert_int_equal(0, pthread_rwlock_wrlock(&object.lock));
+    assert_int_equal(0, pthread_create(&thread, NULL, contended_read_work,
+                                       &read));
+    assert_int_equal(usleep(100000), 0);
+    assert_int_equal(0, pthread_rwlock_unlock(&object.lock));
+    assert_int_equal(0, pthread_join(thread, NULL));
+    assert_ptr_equal(out, read.out);
+    struct pufferfish_string_pool_stats stats;
+    assert_true(pufferfish_string_pool_stats(&object, &stats));
+    uintmax_t waits = 0;
+    for (uintmax_t i = 0; i < PUFFERFISH_STRING_POOL_LOCK_WAIT_BUCKETS; i++) {
+        waits += stats.lock_wait_histogram[i];
+    }
+    assert_int_equal(waits, stats.lock_waits);
+#ifndef PUFFERFISH_NO_STATS
+    assert_int_equal(read.waits, 1);
+    assert_true(read.wait_ns >= 50000000);
+    assert_int_equal(stats.lock_waits, 1);
+    assert_int_equal(stats.lock_wait_ns, read.wait_ns);
+    /* the single wait lies in the bucket of its power of two */
+    uintmax_t bucket = 0;
+    while (!stats.lock_wait_histogram[bucket]) {
+        bucket += 1;
+    }
+    assert_true(read.wait_ns >> bucket == 1);
+#else
+    assert_int_equal(read.waits, 0);
+    assert_int_equal(read.wait_ns, 0);
+#endif
+    assert_true(triggerfish_strong_release(read.out));
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_true(sea_turtle_string_invalidate(&string));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_stats(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    stats_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    stats_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    stats_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                     | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_snapshot_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_init_with_snapshot(NULL, 0,
+                                                           (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_init_with_snapshot_error_on_snapshot_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_init_with_snapshot((void *) 1, 0,
+                                                           NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_save_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_save(NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_save_error_on_path_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_save((void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_snapshot_open_error_on_path_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_snapshot_open(NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_PATH_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_snapshot_open_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_snapshot_open((void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_snapshot_open_error_on_io_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool_snapshot *snapshot;
+    assert_false(pufferfish_string_pool_snapshot_open(
+            "/nonexistent/pufferfish.snapshot", &snapshot));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_IO_FAILED,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_snapshot_open_error_on_snapshot_is_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    char path[] = "/tmp/pufferfish-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    const char chars[] = "definitely not a snapshot of a string pool";
+    assert_int_equal(write(fd, chars, sizeof(chars)), sizeof(chars));
+    assert_int_equal(close(fd), 0);
+    struct pufferfish_string_pool_snapshot *snapshot;
+    assert_false(pufferfish_string_pool_snapshot_open(path, &snapshot));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_SNAPSHOT_IS_MALFORMED,
+                     pufferfish_error);
+    assert_int_equal(unlink(path), 0);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_snapshot_close_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_snapshot_close(NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void snapshot_with_flags(const uintmax_t flags) {
+    char path[] = "/tmp/pufferfish-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(close(fd), 0);
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    struct triggerfish_strong *out[32];
+    for (uintmax_t i = 0; i < 32; i++) {
+        char chars[24];
+        const int length = snprintf(chars, sizeof(chars), "snapshot-%ju", i);
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &out[i]));
+    }
+    /* released strings are left out of the snapshot */
+    assert_true(triggerfish_strong_release(out[31]));
+    assert_true(pufferfish_string_pool_save(&object, path));
+    for (uintmax_t i = 0; i < 31; i++) {
+        assert_true(triggerfish_strong_release(out[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    struct pufferfish_string_pool_snapshot *snapshot;
+    assert_true(pufferfish_string_pool_snapshot_open(path, &snapshot));
+    assert_true(pufferfish_string_pool_init_with_snapshot(&object, flags,
+                                                          snapshot));
+    /* the string pool keeps the snapshot mapped */
+    assert_true(pufferfish_string_pool_snapshot_close(snapshot));
+    struct triggerfish_strong *strong;
+    assert_true(pufferfish_string_pool_get_chars(&object, "snapshot-7", 10,
+                                                 NULL, &strong));
+    const struct sea_turtle_string *string;
+    assert_true(triggerfish_strong_instance(strong, (void **) &string));
+    assert_int_equal(string->size, 10);
+    assert_memory_equal(string->data, "snapshot-7", 10);
+    /* contents refer into the mapped snapshot */
+    assert_true((const unsigned char *) string->data > snapshot->data);
+    assert_true((const unsigned char *) string->data
+                < snapshot->data + snapshot->size);
+    struct triggerfish_strong *other;
+    assert_true(pufferfish_string_pool_get_chars(&object, "snapshot-7", 10,
+                                                 NULL, &other));
+    assert_ptr_equal(strong, other);
+    assert_true(triggerfish_strong_release(other));
+    struct triggerfish_strong *added;
+    assert_true(pufferfish_string_pool_get_chars(&object, "snapshot-31", 11,
+                                                 NULL, &added));
+    assert_true(triggerfish_strong_instance(added, (void **) &string));
+    assert_memory_equal(string->data, "snapshot-31", 11);
+    assert_true((const unsigned char *) string->data < snapshot->data
+                || (const unsigned char *) string->data
+                   >= snapshot->data + snapshot->size);
+    /* layered snapshot holds both the base strings and the added ones */
+    assert_true(pufferfish_string_pool_save(&object, path));
+    assert_true(triggerfish_strong_release(added));
+    /* held strings keep the snapshot mapped after the string pool is gone */
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_true(triggerfish_strong_instance(strong, (void **) &string));
+    assert_memory_equal(string->data, "snapshot-7", 10);
+    assert_true(triggerfish_strong_release(strong));
+    assert_true(pufferfish_string_pool_snapshot_open(path, &snapshot));
+    assert_int_equal(snapshot->header->count, 32);
+    assert_true(pufferfish_string_pool_init_with_snapshot(&object, flags,
+                                                          snapshot));
+    assert_true(pufferfish_string_pool_get_chars(&object, "snapshot-31", 11,
+                                                 NULL, &strong));
+    assert_true(triggerfish_strong_instance(strong, (void **) &string));
+    assert_true((const unsigned char *) string->data > snapshot->data);
+    assert_true(triggerfish_strong_release(strong));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_true(pufferfish_string_pool_snapshot_close(snapshot));
+    assert_int_equal(unlink(path), 0);
+}
+
+static void check_snapshot(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    snapshot_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    snapshot_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    snapshot_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                        | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_save_mode(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    char path[] = "/tmp/pufferfish-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(close(fd), 0);
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init(&object));
+    struct triggerfish_strong *out;
+    assert_true(pufferfish_string_pool_get_chars(&object, "mode", 4, NULL,
+                                                 &out));
+    /* other processes sharing the snapshot must be able to open it */
+    const mode_t masks[] = {022, 027};
+    const mode_t old = umask(masks[0]);
+    for (uintmax_t i = 0; i < sizeof(masks) / sizeof(masks[0]); i++) {
+        umask(masks[i]);
+        assert_true(pufferfish_string_pool_save(&object, path));
+        struct stat status;
+        assert_int_equal(stat(path, &status), 0);
+        assert_int_equal(status.st_mode & 0777, 0666 & ~masks[i]);
+    }
+    umask(old);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    assert_int_equal(unlink(path), 0);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_init_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_cursor_init(NULL, (void *) 1, "", 0));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_init_error_on_string_pool_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_cursor_init((void *) 1, NULL, "", 0));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_POOL_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_init_error_on_string_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_cursor_init((void *) 1, (void *) 1,
+                                                    NULL, 0));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_STRING_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_init_error_on_chars_are_malformed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool_cursor object;
+    assert_false(pufferfish_string_pool_cursor_init(&object, (void *) 1,
+                                                    "\xff", 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_CHARS_ARE_MALFORMED,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_invalidate_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_cursor_invalidate(NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_next_error_on_object_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_cursor_next(NULL, (void *) 1));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OBJECT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_next_error_on_out_is_null(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    assert_false(pufferfish_string_pool_cursor_next((void *) 1, NULL));
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_OUT_IS_NULL,
+                     pufferfish_error);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void cursor_expect(struct pufferfish_string_pool_cursor *const object,
+                          const char *const chars) {
+    struct triggerfish_strong *out;
+    if (!chars) {
+        assert_false(pufferfish_string_pool_cursor_next(object, &out));
+        assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_END_OF_SEQUENCE,
+                         pufferfish_error);
+        return;
+    }
+    assert_true(pufferfish_string_pool_cursor_next(object, &out));
+    const struct sea_turtle_string *string;
+    assert_true(triggerfish_strong_instance(out, (void **) &string));
+    assert_int_equal(string->size, strlen(chars));
+    assert_memory_equal(string->data, chars, string->size);
+    assert_true(triggerfish_strong_release(out));
+}
+
+static void cursor_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    const char *const chars[] = {
+            "http.client.requests",
+            "http.server",
+            "http.server.errors",
+            "http.server.requests",
+            "http.serverless",
+            "rpc.server.requests",
+            "http.server.bytes",
+    };
+    const uintmax_t count = sizeof(chars) / sizeof(chars[0]);
+    struct triggerfish_strong *strong[sizeof(chars) / sizeof(chars[0])];
+    for (uintmax_t i = 0; i < count; i++) {
+        assert_true(pufferfish_string_pool_get_chars(
+                &object, chars[i], strlen(chars[i]), NULL, &strong[i]));
+    }
+    /* released strings are skipped */
+    assert_true(triggerfish_strong_release(strong[6]));
+    struct pufferfish_string_pool_cursor cursor;
+    assert_true(pufferfish_string_pool_cursor_init(&cursor, &object,
+                                                   "http.server.", 12));
+    cursor_expect(&cursor, "http.server.errors");
+    /* strings added after the last one visited are visited as well */
+    struct triggerfish_strong *added;
+    assert_true(pufferfish_string_pool_get_chars(
+            &object, "http.server.latency", 19, NULL, &added));
+    cursor_expect(&cursor, "http.server.latency");
+    cursor_expect(&cursor, "http.server.requests");
+    cursor_expect(&cursor, NULL);
+    cursor_expect(&cursor, NULL);
+    assert_true(pufferfish_string_pool_cursor_invalidate(&cursor));
+    /* an empty prefix visits every string in order */
+    assert_true(pufferfish_string_pool_cursor_init(&cursor, &object, "", 0));
+    cursor_expect(&cursor, "http.client.requests");
+    cursor_expect(&cursor, "http.server");
+    cursor_expect(&cursor, "http.server.errors");
+    cursor_expect(&cursor, "http.server.latency");
+    cursor_expect(&cursor, "http.server.requests");
+    cursor_expect(&cursor, "http.serverless");
+    cursor_expect(&cursor, "rpc.server.requests");
+    cursor_expect(&cursor, NULL);
+    assert_true(pufferfish_string_pool_cursor_invalidate(&cursor));
+    assert_true(pufferfish_string_pool_cursor_init(&cursor, &object,
+                                                   "grpc.", 5));
+    cursor_expect(&cursor, NULL);
+    assert_true(pufferfish_string_pool_cursor_invalidate(&cursor));
+    assert_true(triggerfish_strong_release(added));
+    for (uintmax_t i = 0; i < count - 1; i++) {
+        assert_true(triggerfish_strong_release(strong[i]));
+    }
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_cursor(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    cursor_with_flags(PUFFERFISH_STRING_POOL_FLAG_RED_BLACK_TREE);
+    cursor_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    cursor_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                      | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void cursor_interleaved_with_flags(const uintmax_t flags) {
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(&object, flags));
+    enum {
+        COUNT = 4096
+    };
+    struct triggerfish_strong **const strong = calloc(COUNT, sizeof(*strong));
+    bool *const present = calloc(COUNT, sizeof(*present));
+    assert_non_null(strong);
+    assert_non_null(present);
+    struct pufferfish_string_pool_cursor cursor;
+    assert_true(pufferfish_string_pool_cursor_init(&cursor, &object, "key-",
+                                                   4));
+    const struct pufferfish_string_pool_index *index = NULL;
+    uintmax_t last = 0;
+    bool visited = false;
+    for (uintmax_t i = 0; i < COUNT; i++) {
+        /* visits every number once, in an order unrelated to theirs */
+        const uintmax_t n = i * 7919 % COUNT;
+        char chars[16];
+        const int length = snprintf(chars, sizeof(chars), "key-%05ju", n);
+        assert_true(pufferfish_string_pool_get_chars(&object, chars, length,
+                                                     NULL, &strong[n]));
+        present[n] = true;
+        if (!(n % 3)) {
+            /* released strings are skipped and removed by shrinking */
+            assert_true(triggerfish_strong_release(strong[n]));
+            strong[n] = NULL;
+            present[n] = false;
+        }
+        if (!(i % 64)) {
+            assert_true(pufferfish_string_pool_shrink(&object));
+        }
+        uintmax_t expected = visited ? last + 1 : 0;
+        while (expected < COUNT && !present[expected]) {
+            expected++;
+        }
+        if (expected < COUNT) {
+            const int size = snprintf(chars, sizeof(chars), "key-%05ju",
+                                      expected);
+            assert_int_equal(size, 9);
+            cursor_expect(&cursor, chars);
+            last = expected;
+            visited = true;
+        } else {
+            cursor_expect(&cursor, NULL);
+        }
+        /* the index is kept up to date instead of being built again */
+        if (!index) {
+            index = object.index;
+        }
+        assert_non_null(object.index);
+        assert_ptr_equal(object.index, index);
+    }
+    assert_true(pufferfish_string_pool_cursor_invalidate(&cursor));
+    for (uintmax_t i = 0; i < COUNT; i++) {
+        if (strong[i]) {
+            assert_true(triggerfish_strong_release(strong[i]));
+        }
+    }
+    free(strong);
+    free(present);
+    assert_true(pufferfish_string_pool_invalidate(&object));
+}
+
+static void check_cursor_interleaved_with_inserts(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    cursor_interleaved_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE);
+    cursor_interleaved_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                                  | PUFFERFISH_STRING_POOL_FLAG_LOCK_FREE_READ);
+    cursor_interleaved_with_flags(PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE
+                                  | PUFFERFISH_STRING_POOL_FLAG_DEFERRED_RECLAIM);
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
+static void check_cursor_next_error_on_memory_allocation_failed(void **state) {
+    seahorse_error = SEAHORSE_ERROR_NONE;
+    struct pufferfish_string_pool object;
+    assert_true(pufferfish_string_pool_init_with_flags(
+            &object, PUFFERFISH_STRING_POOL_FLAG_HASH_TABLE));
+    struct triggerfish_strong *strong;
+    assert_true(pufferfish_string_pool_get_chars(&object, "a", 1, NULL,
+                                                 &strong));
+    struct pufferfish_string_pool_cursor cursor;
+    assert_true(pufferfish_string_pool_cursor_init(&cursor, &object, "", 0));
+    struct triggerfish_strong *out;
+    malloc_is_overridden = true;
+    assert_false(pufferfish_string_pool_cursor_next(&cursor, &out));
+    malloc_is_overridden = false;
+    assert_int_equal(PUFFERFISH_STRING_POOL_ERROR_MEMORY_ALLOCATION_FAILED,
+                     pufferfish_error);
+    assert_true(pufferfish_string_pool_cursor_next(&cursor, &out));
+    assert_ptr_equal(out, strong);
+    assert_true(triggerfish_strong_release(out));
+    assert_true(pufferfish_string_pool_cursor_invalidate(&cursor));
+    assert_true(triggerfish_strong_release(strong));
+    assert_true(pufferfish_string_pool_invalidate(&object));
+    seahorse_error = SEAHORSE_ERROR_NONE;
+}
+
 int main(int argc, char *argv[]) {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test(check_invalidate_error_on_object_is_null),
             cmocka_unit_test(check_init_error_on_object_is_null),
             cmocka_unit_test(check_init_error_on_memory_allocation_failed),
             cmocka_unit_test(check_init),
+            cmocka_unit_test(check_init_with_flags_error_on_object_is_null),
+            cmocka_unit_test(check_init_with_flags_error_on_flags_are_invalid),
+            cmocka_unit_test(check_init_with_flags),
+            cmocka_unit_test(
+                    check_init_with_flags_error_on_memory_allocation_failed),
+            cmocka_unit_test(
+                    check_init_with_flags_error_on_lock_free_read_without_hash_table),
+            cmocka_unit_test(
+                    check_init_with_flags_error_on_symbols_without_hash_table),
+            cmocka_unit_test(
+                    check_init_with_flags_error_on_thread_cache_without_lock_free_read),
             cmocka_unit_test(check_get_error_on_object_is_null),
             cmocka_unit_test(check_get_error_on_string_is_null),
             cmocka_unit_test(check_get_error_on_out_is_null),
             cmocka_unit_test(check_get_error_on_concurrent_limit_reached),
             cmocka_unit_test(check_get),
             cmocka_unit_test(check_get_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_get_with_hash_table),
+            cmocka_unit_test(
+                    check_get_with_hash_table_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_get_with_hash_table_after_release),
+            cmocka_unit_test(check_get_with_hash_table_single_allocation),
+            cmocka_unit_test(check_get_with_lock_free_read),
+            cmocka_unit_test(check_get_chars_error_on_object_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_is_null),
+            cmocka_unit_test(check_get_chars_error_on_out_is_null),
+            cmocka_unit_test(check_get_chars_error_on_chars_are_malformed),
+            cmocka_unit_test(check_get_chars),
+            cmocka_unit_test(
+                    check_get_chars_with_hash_table_hit_does_not_allocate),
+            cmocka_unit_test(check_get_many_error_on_object_is_null),
+            cmocka_unit_test(check_get_many_error_on_strings_is_null),
+            cmocka_unit_test(check_get_many_error_on_out_is_null),
+            cmocka_unit_test(check_get_many),
+            cmocka_unit_test(check_get_many_with_hash_table),
+            cmocka_unit_test(check_get_many_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_load_error_on_object_is_null),
+            cmocka_unit_test(check_load_error_on_strings_is_null),
+            cmocka_unit_test(check_load_error_on_out_is_null),
+            cmocka_unit_test(check_load_error_on_threads_are_zero),
+            cmocka_unit_test(check_load),
+            cmocka_unit_test(check_load_with_threads),
+            cmocka_unit_test(check_load_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_load_file_error_on_object_is_null),
+            cmocka_unit_test(check_load_file_error_on_path_is_null),
+            cmocka_unit_test(check_load_file_error_on_out_is_null),
+            cmocka_unit_test(check_load_file_error_on_threads_are_zero),
+            cmocka_unit_test(check_load_file_error_on_io_failed),
+            cmocka_unit_test(check_load_file_error_on_chars_are_malformed),
+            cmocka_unit_test(check_load_file),
+            cmocka_unit_test(check_symbol_error_on_object_is_null),
+            cmocka_unit_test(check_symbol_error_on_string_is_null),
+            cmocka_unit_test(check_symbol_error_on_out_is_null),
+            cmocka_unit_test(check_symbol_error_on_symbols_are_disabled),
+            cmocka_unit_test(check_symbol_error_on_string_is_foreign),
+            cmocka_unit_test(check_resolve_error_on_object_is_null),
+            cmocka_unit_test(check_resolve_error_on_out_is_null),
+            cmocka_unit_test(check_symbol),
+            cmocka_unit_test(check_header_error_on_string_is_null),
+            cmocka_unit_test(check_header_error_on_out_is_null),
+            cmocka_unit_test(check_header),
+            cmocka_unit_test(check_same_error_on_string_is_null),
+            cmocka_unit_test(check_same_error_on_out_is_null),
+            cmocka_unit_test(check_same),
+            cmocka_unit_test(
+                    check_init_with_flags_error_on_auto_shrink_without_hash_table),
+            cmocka_unit_test(check_get_with_auto_shrink),
+            cmocka_unit_test(check_shrink_step_error_on_object_is_null),
+            cmocka_unit_test(check_shrink_step_error_on_limit_is_zero),
+            cmocka_unit_test(check_shrink_step_error_on_out_is_null),
+            cmocka_unit_test(check_shrink_step),
             cmocka_unit_test(check_shrink_error_on_object_is_null),
             cmocka_unit_test(check_shrink),
+            cmocka_unit_test(check_shrink_with_hash_table),
+            cmocka_unit_test(check_invalidate_with_hash_table_while_referenced),
+            cmocka_unit_test(check_thread_cache_counters_error_on_out_is_null),
+            cmocka_unit_test(check_thread_lock_waits_error_on_out_is_null),
+            cmocka_unit_test(check_get_with_thread_cache),
+            cmocka_unit_test(check_drain_error_on_object_is_null),
+            cmocka_unit_test(check_drain_error_on_limit_is_zero),
+            cmocka_unit_test(check_drain_error_on_out_is_null),
+            cmocka_unit_test(check_drain_error_on_reclaim_is_disabled),
+            cmocka_unit_test(check_drain),
+            cmocka_unit_test(check_invalidate_with_deferred_reclaim),
+            cmocka_unit_test(check_invalidate_with_release_between_drain_and_detach),
+            cmocka_unit_test(check_reclaimer_start_error_on_object_is_null),
+            cmocka_unit_test(check_reclaimer_start_error_on_period_is_zero),
+            cmocka_unit_test(check_reclaimer_start_error_on_reclaim_is_disabled),
+            cmocka_unit_test(check_reclaimer_start_error_on_reclaimer_is_running),
+            cmocka_unit_test(check_reclaimer_stop_error_on_object_is_null),
+            cmocka_unit_test(check_reclaimer_stop_error_on_reclaimer_is_stopped),
+            cmocka_unit_test(check_reclaimer),
+            cmocka_unit_test(check_set_budget_error_on_object_is_null),
+            cmocka_unit_test(check_set_budget_error_on_hash_table_is_disabled),
+            cmocka_unit_test(check_set_budget),
+            cmocka_unit_test(check_set_budget_with_queued_deaths),
+            cmocka_unit_test(check_stats_error_on_object_is_null),
+            cmocka_unit_test(check_stats_error_on_out_is_null),
+            cmocka_unit_test(check_stats),
+            cmocka_unit_test(check_stats_on_contended_read_lock),
+            cmocka_unit_test(check_init_with_snapshot_error_on_object_is_null),
+            cmocka_unit_test(
+                    check_init_with_snapshot_error_on_snapshot_is_null),
+            cmocka_unit_test(check_save_error_on_object_is_null),
+            cmocka_unit_test(check_save_error_on_path_is_null),
+            cmocka_unit_test(check_snapshot_open_error_on_path_is_null),
+            cmocka_unit_test(check_snapshot_open_error_on_out_is_null),
+            cmocka_unit_test(check_snapshot_open_error_on_io_failed),
+            cmocka_unit_test(
+                    check_snapshot_open_error_on_snapshot_is_malformed),
+            cmocka_unit_test(check_snapshot_close_error_on_object_is_null),
+            cmocka_unit_test(check_snapshot),
+            cmocka_unit_test(check_save_mode),
+            cmocka_unit_test(check_cursor_init_error_on_object_is_null),
+            cmocka_unit_test(check_cursor_init_error_on_string_pool_is_null),
+            cmocka_unit_test(check_cursor_init_error_on_string_is_null),
+            cmocka_unit_test(check_cursor_init_error_on_chars_are_malformed),
+            cmocka_unit_test(check_cursor_invalidate_error_on_object_is_null),
+            cmocka_unit_test(check_cursor_next_error_on_object_is_null),
+            cmocka_unit_test(check_cursor_next_error_on_out_is_null),
+            cmocka_unit_test(check_cursor),
+            cmocka_unit_test(check_cursor_interleaved_with_inserts),
+            cmocka_unit_test(
+                    check_cursor_next_error_on_memory_allocation_failed),
     };
     //cmocka_set_message_output(CM_OUTPUT_XML);
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <ctype.h>
+#include <seagrass.h>
+#include <sea-turtle.h>
+#include <pufferfish.h>
+
+/*
+ * Emits the static string pool table of a vocabulary as C source, one string
+ * per line of input. Empty lines are skipped.
+ */
+
+static bool identifier_valid(const char *const name) {
+    if (!isalpha((unsigned char) *name) && '_' != *name) {
+        return false;
+    }
+    for (const char *c = name + 1; *c; c++) {
+        if (!isalnum((unsigned char) *c) && '_' != *c) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void emit_chars(FILE *const out,
+                       const char *const data,
+                       const size_t size) {
+    fputc('"', out);
+    for (size_t i = 0; i < size; i++) {
+        const unsigned char c = (unsigned char) data[i];
+        if ('"' == c || '\\' == c) {
+            fprintf(out, "\\%c", c);
+        } else if (c >= 0x20 && c < 0x7f && '?' != c) {
+            fputc(c, out);
+        } else {
+            /* three digits so that a following digit is not absorbed */
+            fprintf(out, "\\%03o", c);
+        }
+    }
+    fputc('"', out);
+}
+
+static void emit(FILE *const out,
+                 const char *const name,
+                 const struct pufferfish_static_string_pool_table *const table) {
+    fprintf(out, "/* Generated by aquarium-pufferfish-static-string-pool-"
+                 "generator, do not edit. */\n"
+                 "/* extern const struct pufferfish_static_string_pool_table "
+                 "%s; */\n"
+                 "#include <pufferfish.h>\n\n", name);
+    fprintf(out, "static const uint32_t %s_seeds[] = {\n", name);
+    for (uintmax_t i = 0; i < table->buckets; i++) {
+        fprintf(out, "        UINT32_C(%" PRIu32 ")%s\n", table->seeds[i],
+                i + 1 < table->buckets ? "," : "");
+    }
+    fprintf(out, "};\n\n"
+                 "static const struct pufferfish_static_string_pool_string "
+                 "%s_strings[] = {\n", name);
+    for (uintmax_t i = 0; i < table->count; i++) {
+        const struct pufferfish_static_string_pool_string *const string
+                = &table->strings[i];
+        fputs("        {", out);
+        emit_chars(out, string->data, string->size);
+        fprintf(out, ", %zu, %zu, UINTMAX_C(0x%" PRIxMAX ")}%s\n",
+                string->size, string->count, string->hash,
+                i + 1 < table->count ? "," : "");
+    }
+    fprintf(out, "};\n\n"
+                 "const struct pufferfish_static_string_pool_table %s = {\n"
+                 "        .hash_id = %" PRIuMAX ",\n"
+                 "        .count = %" PRIuMAX ",\n"
+                 "        .buckets = %" PRIuMAX ",\n"
+                 "        .seeds = %s_seeds,\n"
+                 "        .strings = %s_strings\n"
+                 "};\n",
+            name, table->hash_id, table->count, table->buckets, name, name);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 3 || !identifier_valid(argv[1])) {
+        fprintf(stderr, "usage: %s <identifier> [file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE *const in = argc > 2 ? fopen(argv[2], "r") : stdin;
+    if (!in) {
+        perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+    struct sea_turtle_string *strings = NULL;
+    uintmax_t count = 0;
+    uintmax_t capacity = 0;
+    /* lines read including empty ones, for reporting */
+    uintmax_t lines = 0;
+    char *line = NULL;
+    size_t length = 0;
+    ssize_t size;
+    while ((size = getline(&line, &length, in)) >= 0) {
+        lines++;
+        if (size && '\n' == line[size - 1]) {
+            line[--size] = '\0';
+        }
+        if (!size) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            strings = realloc(strings, capacity * sizeof(*strings));
+            seagrass_required(strings);
+        }
+        size_t out;
+        if (!sea_turtle_string_init(&strings[count], line, (size_t) size,
+                                    &out)) {
+            fprintf(stderr, "%s: line %" PRIuMAX " is not valid UTF-8\n",
+                    argv[0], lines);
+            return EXIT_FAILURE;
+        }
+        count++;
+    }
+    free(line);
+    if (in != stdin) {
+        fclose(in);
+    }
+    const struct sea_turtle_string **const pointers = malloc(
+            (count ? count : 1) * sizeof(*pointers));
+    seagrass_required(pointers);
+    for (uintmax_t i = 0; i < count; i++) {
+        pointers[i] = &strings[i];
+    }
+    struct pufferfish_static_string_pool pool;
+    if (!pufferfish_static_string_pool_init(&pool, pointers, count, NULL)) {
+        switch (pufferfish_error) {
+            case PUFFERFISH_STATIC_STRING_POOL_ERROR_COUNT_IS_ZERO: {
+                fprintf(stderr, "%s: no strings\n", argv[0]);
+                break;
+            }
+            case PUFFERFISH_STATIC_STRING_POOL_ERROR_STRINGS_ARE_NOT_DISTINCT: {
+                fprintf(stderr, "%s: duplicate strings\n", argv[0]);
+                break;
+            }
+            default: {
+                fprintf(stderr, "%s: out of memory\n", argv[0]);
+                break;
+            }
+        }
+        return EXIT_FAILURE;
+    }
+    emit(stdout, argv[1], &pool.table);
+    seagrass_required_true(pufferfish_static_string_pool_invalidate(&pool));
+    for (uintmax_t i = 0; i < count; i++) {
+        seagrass_required_true(sea_turtle_string_invalidate(&strings[i]));
+    }
+    free(strings);
+    free(pointers);
+    return fflush(stdout) ? EXIT_FAILURE : EXIT_SUCCESS;
+}